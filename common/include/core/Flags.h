@@ -28,7 +28,7 @@
 // Class definition for flags.
 //
 // Author: Paulo Pagliosa
-// Last revision: 05/08/2019
+// Last revision: 19/10/2026
 
 #ifndef __Flags_h
 #define __Flags_h
@@ -73,7 +73,7 @@ public:
   HOST DEVICE
   Flags<Bits> operator |(Bits mask) const
   {
-    return Flags<Bits>{bits | (uint32_t)mask};
+    return Flags<Bits>{Bits(bits | (uint32_t)mask)};
   }
 
   HOST DEVICE
@@ -28,7 +28,7 @@
 // Global typedefs and utilities.
 //
 // Author: Paulo Pagliosa
-// Last revision: 01/08/2018
+// Last revision: 19/10/2026
 
 #ifndef __Globals_h
 #define __Globals_h
@@ -43,5 +43,9 @@
 #define HOST __host__
 #define DEVICE __device__
 #define ALIGN(i) __align__(i)
+#if defined(__SSE2__) || defined(_M_X64) || \
+  (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define CG_SSE2
+#endif
 
 #endif // __Globals_h
@@ -0,0 +1,310 @@
+//[]---------------------------------------------------------------[]
+//|                                                                 |
+//| Copyright (C) 2019 Orthrus Group.                               |
+//|                                                                 |
+//| This software is provided 'as-is', without any express or       |
+//| implied warranty. In no event will the authors be held liable   |
+//| for any damages arising from the use of this software.          |
+//|                                                                 |
+//| Permission is granted to anyone to use this software for any    |
+//| purpose, including commercial applications, and to alter it and |
+//| redistribute it freely, subject to the following restrictions:  |
+//|                                                                 |
+//| 1. The origin of this software must not be misrepresented; you  |
+//| must not claim that you wrote the original software. If you use |
+//| this software in a product, an acknowledgment in the product    |
+//| documentation would be appreciated but is not required.         |
+//|                                                                 |
+//| 2. Altered source versions must be plainly marked as such, and  |
+//| must not be misrepresented as being the original software.      |
+//|                                                                 |
+//| 3. This notice may not be removed or altered from any source    |
+//| distribution.                                                   |
+//|                                                                 |
+//[]---------------------------------------------------------------[]
+//
+// OVERVIEW: ObjectPool.h
+// ========
+// Class definition for typed object pool.
+//
+// Author: Paulo Pagliosa
+// Last revision: 19/10/2026
+
+#ifndef __ObjectPool_h
+#define __ObjectPool_h
+
+#include <cstddef>
+#include <cstdint>
+#include <new>
+#include <stdexcept>
+#include <vector>
+
+namespace cg
+{ // begin namespace cg
+
+//
+// Forward definition
+//
+template <typename T, int chunkSize> class ObjectPool;
+
+
+/////////////////////////////////////////////////////////////////////
+//
+// PoolHandle: generational handle to a pooled object
+// ==========
+//
+// A handle is a (slot index, generation) pair. The generation of a
+// slot changes whenever the slot is allocated or released, so a handle
+// to a destroyed object is detected as stale instead of silently
+// referencing whatever object reuses the slot.
+//
+template <typename T>
+class PoolHandle
+{
+public:
+  /// Constructs a null handle.
+  PoolHandle() = default;
+
+  auto index() const
+  {
+    return _index;
+  }
+
+  auto generation() const
+  {
+    return _generation;
+  }
+
+  bool isNull() const
+  {
+    return _generation == 0;
+  }
+
+  bool operator ==(const PoolHandle<T>& other) const
+  {
+    return _index == other._index && _generation == other._generation;
+  }
+
+  bool operator !=(const PoolHandle<T>& other) const
+  {
+    return !operator ==(other);
+  }
+
+private:
+  uint32_t _index{};
+  uint32_t _generation{};
+
+  PoolHandle(uint32_t index, uint32_t generation):
+    _index{index},
+    _generation{generation}
+  {
+    // do nothing
+  }
+
+  template <typename, int> friend class ObjectPool;
+
+}; // PoolHandle
+
+
+/////////////////////////////////////////////////////////////////////
+//
+// ObjectPool: typed object pool class
+// ==========
+//
+// Chunked arena of fixed-size slots for objects of type T. Slots are
+// never moved, so pointers to pooled objects stay valid; freed slots
+// are recycled through a free list, which makes allocation and release
+// O(1). Pools are not thread-safe.
+//
+template <typename T, int chunkSize = 1024>
+class ObjectPool
+{
+public:
+  using Handle = PoolHandle<T>;
+
+  ObjectPool() = default;
+
+  ObjectPool(const ObjectPool&) = delete;
+  ObjectPool& operator =(const ObjectPool&) = delete;
+
+  /// Destructor.
+  ~ObjectPool()
+  {
+    // Objects still alive at exit keep their memory
+    if (_size == 0)
+      for (auto chunk : _chunks)
+        delete []chunk;
+  }
+
+  /// Returns the number of live objects in this pool.
+  auto size() const
+  {
+    return _size;
+  }
+
+  /// Returns the number of slots in this pool.
+  auto capacity() const
+  {
+    return int(_chunks.size()) * chunkSize;
+  }
+
+  /// Returns raw storage for one object of type T.
+  void* allocate()
+  {
+    if (_free == nullptr)
+      grow();
+
+    auto slot = _free;
+
+    _free = slot->next;
+    slot->next = nullptr;
+    ++slot->generation;
+    ++_size;
+    return slot->storage;
+  }
+
+  /// Releases the storage of an object allocated by this pool.
+  void deallocate(void* ptr)
+  {
+    if (ptr == nullptr)
+      return;
+
+    auto slot = static_cast<Slot*>(ptr);
+
+    ++slot->generation;
+    slot->next = _free;
+    _free = slot;
+    --_size;
+  }
+
+  /// Returns true if \c ptr is the address of a slot of this pool.
+  bool contains(const void* ptr) const
+  {
+    auto p = static_cast<const unsigned char*>(ptr);
+
+    for (auto chunk : _chunks)
+    {
+      auto begin = reinterpret_cast<const unsigned char*>(chunk);
+
+      if (p >= begin && p < begin + chunkSize * sizeof(Slot))
+        return (p - begin) % sizeof(Slot) == 0;
+    }
+    return false;
+  }
+
+  /// \brief Returns a handle to a live object allocated by this pool.
+  /// The handle of an object not allocated by the pool is undefined.
+  Handle handle(const T* object) const
+  {
+    if (object == nullptr)
+      return Handle{};
+#ifdef _DEBUG
+    if (!contains(object))
+      throw std::logic_error("ObjectPool: object not allocated by pool");
+#endif // _DEBUG
+
+    auto slot = reinterpret_cast<const Slot*>(object);
+    return Handle{slot->index, slot->generation};
+  }
+
+  /// Returns the object referenced by \c h, or nullptr if h is stale.
+  T* get(Handle h) const
+  {
+    if (h.isNull() || h._index >= uint32_t(capacity()))
+      return nullptr;
+
+    auto slot = _chunks[h._index / chunkSize] + h._index % chunkSize;
+
+    if (slot->generation != h._generation)
+      return nullptr;
+    return reinterpret_cast<T*>(slot->storage);
+  }
+
+  /// Calls \c f for every live object, in storage order.
+  template <typename F>
+  void iterate(F f) const
+  {
+    for (auto chunk : _chunks)
+      for (auto slot = chunk, end = chunk + chunkSize; slot != end; ++slot)
+        if (slot->isLive())
+          f(reinterpret_cast<T*>(slot->storage));
+  }
+
+private:
+  struct Slot
+  {
+    alignas(T) unsigned char storage[sizeof(T)];
+    Slot* next;
+    uint32_t index;
+    uint32_t generation; // odd while the slot is live
+
+    bool isLive() const
+    {
+      return generation & 1;
+    }
+
+  }; // Slot
+
+  std::vector<Slot*> _chunks;
+  Slot* _free{};
+  int _size{};
+
+  void grow()
+  {
+    auto chunk = new Slot[chunkSize];
+    auto base = uint32_t(_chunks.size()) * chunkSize;
+
+    // Thread the new slots into the free list in storage order
+    for (int i = chunkSize; i-- > 0;)
+    {
+      chunk[i].next = _free;
+      chunk[i].index = base + i;
+      chunk[i].generation = 0;
+      _free = chunk + i;
+    }
+    _chunks.push_back(chunk);
+  }
+
+}; // ObjectPool
+
+//
+// Class-specific allocation through an object pool. Derived classes
+// not declaring their own pool fall back to the global heap. Only
+// objects allocated by new T have handles: handle() of an object on
+// the stack, or of a derived class allocated from the global heap, is
+// undefined (and throws in debug builds). DEFINE_POOL_ALLOCATED goes
+// in the source file of the class.
+//
+#define DECLARE_POOL_ALLOCATED(T) \
+  using Handle = PoolHandle<T>; \
+  static ObjectPool<T>& pool(); \
+  static void* operator new(std::size_t size) \
+  { \
+    return size == sizeof(T) ? pool().allocate() : ::operator new(size); \
+  } \
+  static void operator delete(void* ptr, std::size_t size) \
+  { \
+    if (size == sizeof(T)) \
+      pool().deallocate(ptr); \
+    else \
+      ::operator delete(ptr); \
+  } \
+  Handle handle() const \
+  { \
+    return pool().handle(this); \
+  } \
+  static T* get(Handle h) \
+  { \
+    return pool().get(h); \
+  }
+
+#define DEFINE_POOL_ALLOCATED(T) \
+  ObjectPool<T>& T::pool() \
+  { \
+    static ObjectPool<T> instance; \
+    return instance; \
+  }
+
+} // end namespace cg
+
+#endif // __ObjectPool_h
@@ -28,13 +28,26 @@
 // Class definition for shared object.
 //
 // Author: Paulo Pagliosa
-// Last revision: 23/08/2018
+// Last revision: 19/10/2026
 
 #ifndef __SharedObject_h
 #define __SharedObject_h
 
 #include <type_traits>
 
+//
+// Define CG_ATOMIC_REFERENCE_COUNT as 1 to make the reference counting
+// of shared objects thread-safe. The same value must be used to build
+// the library and the applications linked against it.
+//
+#ifndef CG_ATOMIC_REFERENCE_COUNT
+#define CG_ATOMIC_REFERENCE_COUNT 0
+#endif
+
+#if CG_ATOMIC_REFERENCE_COUNT
+#include <atomic>
+#endif
+
 namespace cg
 { // begin namespace cg
 
@@ -46,7 +59,7 @@ class SharedObject;
 template <typename T>
 inline constexpr bool isSharedObject()
 {
-  return std::is_assignable<SharedObject, T>::value;
+  return std::is_base_of<SharedObject, std::remove_cv_t<T>>::value;
 }
 
 #define ASSERT_SHARED(T, msg) static_assert(isSharedObject<T>(), msg)
@@ -63,9 +76,13 @@ public:
   virtual ~SharedObject() = default;
 
   /// Returns the number of references of this object.
-  auto referenceCount() const
+  int referenceCount() const
   {
+#if CG_ATOMIC_REFERENCE_COUNT
+    return _referenceCount.load(std::memory_order_relaxed);
+#else
     return _referenceCount;
+#endif
   }
 
   template <typename T>
@@ -73,7 +90,7 @@ public:
   {
     ASSERT_SHARED(T, "Pointer to shared object expected");
     if (ptr != nullptr)
-      ++ptr->_referenceCount;
+      ptr->addReference();
     return ptr;
   }
 
@@ -81,17 +98,75 @@ public:
   static void release(T* ptr)
   {
     ASSERT_SHARED(T, "Pointer to shared object expected");
-    if (ptr != nullptr && --ptr->_referenceCount <= 0)
-      delete ptr;
+    if (ptr != nullptr && ptr->removeReference() <= 0)
+    {
+      SharedObject* object = ptr;
+
+      if (object->isBoundToOwnerThread())
+        destroy(object);
+      else
+        delete ptr;
+    }
   }
 
+  /// Sets the calling thread as the owner thread of the objects
+  /// bound to it (usually, the thread owning the GL context).
+  static void setOwnerThread();
+
+  /// Deletes the objects whose last reference was released outside
+  /// the owner thread. Must be called from the owner thread.
+  static void collectDeferred();
+
 protected:
   /// Constructs an unreferenced object.
   SharedObject() = default;
 
+  /// Constructs an unreferenced copy of an object.
+  SharedObject(const SharedObject&)
+  {
+    // do nothing
+  }
+
+  SharedObject& operator =(const SharedObject&)
+  {
+    return *this;
+  }
+
+  /// Returns true if this object must be deleted by the owner thread.
+  virtual bool isBoundToOwnerThread() const
+  {
+    return false;
+  }
+
 private:
+#if CG_ATOMIC_REFERENCE_COUNT
+  std::atomic<int> _referenceCount{};
+
+  void addReference()
+  {
+    _referenceCount.fetch_add(1, std::memory_order_relaxed);
+  }
+
+  int removeReference()
+  {
+    return _referenceCount.fetch_sub(1, std::memory_order_acq_rel) - 1;
+  }
+#else
   int _referenceCount{};
-  
+
+  void addReference()
+  {
+    ++_referenceCount;
+  }
+
+  int removeReference()
+  {
+    return --_referenceCount;
+  }
+#endif
+
+  static void destroy(SharedObject*);
+
 }; // SharedObject
 
 
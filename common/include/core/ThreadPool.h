@@ -0,0 +1,101 @@
+//[]---------------------------------------------------------------[]
+//|                                                                 |
+//| Copyright (C) 2019 Orthrus Group.                               |
+//|                                                                 |
+//| This software is provided 'as-is', without any express or       |
+//| implied warranty. In no event will the authors be held liable   |
+//| for any damages arising from the use of this software.          |
+//|                                                                 |
+//| Permission is granted to anyone to use this software for any    |
+//| purpose, including commercial applications, and to alter it and |
+//| redistribute it freely, subject to the following restrictions:  |
+//|                                                                 |
+//| 1. The origin of this software must not be misrepresented; you  |
+//| must not claim that you wrote the original software. If you use |
+//| this software in a product, an acknowledgment in the product    |
+//| documentation would be appreciated but is not required.         |
+//|                                                                 |
+//| 2. Altered source versions must be plainly marked as such, and  |
+//| must not be misrepresented as being the original software.      |
+//|                                                                 |
+//| 3. This notice may not be removed or altered from any source    |
+//| distribution.                                                   |
+//|                                                                 |
+//[]---------------------------------------------------------------[]
+// OVERVIEW: ThreadPool.h
+// ========
+// Class definition for thread pool.
+//
+// Author: Paulo Pagliosa
+// Last revision: 19/10/2026
+
+#ifndef __ThreadPool_h
+#define __ThreadPool_h
+
+#include <condition_variable>
+#include <functional>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <queue>
+#include <thread>
+#include <type_traits>
+#include <vector>
+
+namespace cg
+{ // begin namespace cg
+
+
+/////////////////////////////////////////////////////////////////////
+//
+// ThreadPool: thread pool class
+// ==========
+//
+// Runs the tasks submitted to it, in submission order, on a fixed
+// set of worker threads. submit() returns immediately a future to
+// the result of the task; exceptions thrown by a task are stored in
+// its future. The destructor waits for the tasks already submitted.
+//
+class ThreadPool
+{
+public:
+  /// \brief Constructs a thread pool with \c threads workers (by
+  /// default, the number of hardware threads).
+  ThreadPool(int threads = 0);
+
+  /// Destructor.
+  ~ThreadPool();
+
+  auto size() const
+  {
+    return int(_workers.size());
+  }
+
+  /// Submits a task to the pool.
+  template <typename F>
+  auto submit(F&& f)
+  {
+    using R = std::invoke_result_t<std::decay_t<F>>;
+
+    auto task = std::make_shared<std::packaged_task<R()>>(std::forward<F>(f));
+    auto result = task->get_future();
+
+    enqueue([task]() { (*task)(); });
+    return result;
+  }
+
+private:
+  std::vector<std::thread> _workers;
+  std::queue<std::function<void()>> _tasks;
+  std::mutex _lock;
+  std::condition_variable _ready;
+  bool _stopping{};
+
+  void enqueue(std::function<void()>&& task);
+  void run();
+
+}; // ThreadPool
+
+} // end namespace cg
+
+#endif // __ThreadPool_h
@@ -0,0 +1,66 @@
+//[]---------------------------------------------------------------[]
+//|                                                                 |
+//| Copyright (C) 2018, 2019 Orthrus Group.                         |
+//|                                                                 |
+//| This software is provided 'as-is', without any express or       |
+//| implied warranty. In no event will the authors be held liable   |
+//| for any damages arising from the use of this software.          |
+//|                                                                 |
+//| Permission is granted to anyone to use this software for any    |
+//| purpose, including commercial applications, and to alter it and |
+//| redistribute it freely, subject to the following restrictions:  |
+//|                                                                 |
+//| 1. The origin of this software must not be misrepresented; you  |
+//| must not claim that you wrote the original software. If you use |
+//| this software in a product, an acknowledgment in the product    |
+//| documentation would be appreciated but is not required.         |
+//|                                                                 |
+//| 2. Altered source versions must be plainly marked as such, and  |
+//| must not be misrepresented as being the original software.      |
+//|                                                                 |
+//| 3. This notice may not be removed or altered from any source    |
+//| distribution.                                                   |
+//|                                                                 |
+//[]---------------------------------------------------------------[]
+//
+// OVERVIEW: MeshOptimizer.h
+// ========
+// Class definition for mesh optimizer.
+//
+// Author: Paulo Pagliosa
+// Last revision: 19/10/2026
+
+#ifndef __MeshOptimizer_h
+#define __MeshOptimizer_h
+
+#include "geometry/TriangleMesh.h"
+
+namespace cg
+{ // begin namespace cg
+
+
+/////////////////////////////////////////////////////////////////////
+//
+// MeshOptimizer: mesh optimizer class
+// =============
+//
+// Reorders the triangles of a mesh for the post-transform vertex
+// cache of the GPU (Forsyth's linear-speed algorithm), then reorders
+// its vertices by first use, so that consecutive triangles also fetch
+// nearby vertices (which benefits BVH traversal as well).
+//
+class MeshOptimizer
+{
+public:
+  /// \brief Returns the ACMR (average number of vertices transformed
+  /// per triangle) of the mesh drawn through a FIFO vertex cache.
+  static float acmr(const TriangleMesh& mesh, int cacheSize = 16);
+
+  /// Optimizes the triangle and vertex orders of the mesh.
+  static void optimize(TriangleMesh& mesh);
+
+}; // MeshOptimizer
+
+} // end namespace cg
+
+#endif // __MeshOptimizer_h
@@ -0,0 +1,64 @@
+//[]---------------------------------------------------------------[]
+//|                                                                 |
+//| Copyright (C) 2018, 2019 Orthrus Group.                         |
+//|                                                                 |
+//| This software is provided 'as-is', without any express or       |
+//| implied warranty. In no event will the authors be held liable   |
+//| for any damages arising from the use of this software.          |
+//|                                                                 |
+//| Permission is granted to anyone to use this software for any    |
+//| purpose, including commercial applications, and to alter it and |
+//| redistribute it freely, subject to the following restrictions:  |
+//|                                                                 |
+//| 1. The origin of this software must not be misrepresented; you  |
+//| must not claim that you wrote the original software. If you use |
+//| this software in a product, an acknowledgment in the product    |
+//| documentation would be appreciated but is not required.         |
+//|                                                                 |
+//| 2. Altered source versions must be plainly marked as such, and  |
+//| must not be misrepresented as being the original software.      |
+//|                                                                 |
+//| 3. This notice may not be removed or altered from any source    |
+//| distribution.                                                   |
+//|                                                                 |
+//[]---------------------------------------------------------------[]
+// OVERVIEW: MeshSimplifier.h
+// ========
+// Class definition for mesh simplifier.
+//
+// Author: Paulo Pagliosa
+// Last revision: 19/10/2026
+
+#ifndef __MeshSimplifier_h
+#define __MeshSimplifier_h
+
+#include "geometry/TriangleMesh.h"
+
+namespace cg
+{ // begin namespace cg
+
+
+/////////////////////////////////////////////////////////////////////
+//
+// MeshSimplifier: mesh simplifier class
+// ==============
+//
+// Simplifies a mesh by collapsing, in order of increasing cost, the
+// edges whose quadric error metric (Garland and Heckbert) is minimum.
+// Boundary edges are preserved by penalty quadrics, and collapses
+// that would fold a triangle over or pinch the surface are rejected.
+//
+class MeshSimplifier
+{
+public:
+  /// \brief Returns a new mesh simplified from \c mesh to (at most,
+  /// if possible) \c targetTriangles triangles. The vertex normals of
+  /// the new mesh are recomputed.
+  static TriangleMesh* simplify(const TriangleMesh& mesh,
+    int targetTriangles);
+
+}; // MeshSimplifier
+
+} // end namespace cg
+
+#endif // __MeshSimplifier_h
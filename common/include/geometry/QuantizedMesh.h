@@ -0,0 +1,152 @@
+//[]---------------------------------------------------------------[]
+//|                                                                 |
+//| Copyright (C) 2018, 2019 Orthrus Group.                         |
+//|                                                                 |
+//| This software is provided 'as-is', without any express or       |
+//| implied warranty. In no event will the authors be held liable   |
+//| for any damages arising from the use of this software.          |
+//|                                                                 |
+//| Permission is granted to anyone to use this software for any    |
+//| purpose, including commercial applications, and to alter it and |
+//| redistribute it freely, subject to the following restrictions:  |
+//|                                                                 |
+//| 1. The origin of this software must not be misrepresented; you  |
+//| must not claim that you wrote the original software. If you use |
+//| this software in a product, an acknowledgment in the product    |
+//| documentation would be appreciated but is not required.         |
+//|                                                                 |
+//| 2. Altered source versions must be plainly marked as such, and  |
+//| must not be misrepresented as being the original software.      |
+//|                                                                 |
+//| 3. This notice may not be removed or altered from any source    |
+//| distribution.                                                   |
+//|                                                                 |
+//[]---------------------------------------------------------------[]
+//
+// OVERVIEW: QuantizedMesh.h
+// ========
+// Class definition for quantized mesh.
+//
+// Author: Paulo Pagliosa
+// Last revision: 19/10/2026
+
+#ifndef __QuantizedMesh_h
+#define __QuantizedMesh_h
+
+#include "geometry/TriangleMesh.h"
+#include <cstdint>
+#include <vector>
+
+namespace cg
+{ // begin namespace cg
+
+
+/////////////////////////////////////////////////////////////////////
+//
+// QuantizedMesh: quantized mesh class
+// =============
+//
+// Compact copy of the vertex attributes of a triangle mesh. Positions
+// are quantized to 16-bit unsigned integers relative to the mesh
+// bounds, normals are octahedral encoded into two 16 or 8-bit unsigned
+// integers and uvs are quantized to 16 bits relative to their bounds.
+// Positions and normals are interleaved in the layout uploaded by
+// GLMesh: 12 (16-bit normals) or 8 (8-bit normals) bytes per vertex,
+// against 24 of a float position and normal. Quantized meshes are
+// built to be uploaded and decoded by vertex shaders only: the CPU
+// keeps the float mesh, whose positions the BVHs and ray tracer need,
+// so the memory saved is GPU memory and upload bandwidth.
+//
+class QuantizedMesh: public SharedObject
+{
+public:
+  enum class NormalFormat
+  {
+    Octahedral16,
+    Octahedral8
+  };
+
+  QuantizedMesh(const TriangleMesh& mesh,
+    NormalFormat normalFormat = NormalFormat::Octahedral16);
+
+  int numberOfVertices() const
+  {
+    return _numberOfVertices;
+  }
+
+  NormalFormat normalFormat() const
+  {
+    return _normalFormat;
+  }
+
+  /// Returns the size in bytes of an interleaved vertex.
+  int stride() const
+  {
+    return _normalFormat == NormalFormat::Octahedral16 ? 12 : 8;
+  }
+
+  /// Returns the byte offset of the normal in an interleaved vertex.
+  int normalOffset() const
+  {
+    return _normalFormat == NormalFormat::Octahedral16 ? 8 : 6;
+  }
+
+  const void* vertexData() const
+  {
+    return _vertices.data();
+  }
+
+  /// Returns the quantized uvs (null if the mesh has no uvs).
+  const uint16_t* uvData() const
+  {
+    return _uv.empty() ? nullptr : _uv.data();
+  }
+
+  /// \brief Returns the offset and scale of positions: a quantized
+  /// position q decodes to offset + scale * q / 65535.
+  const vec3f& positionOffset() const
+  {
+    return _positionOffset;
+  }
+
+  const vec3f& positionScale() const
+  {
+    return _positionScale;
+  }
+
+  /// \brief Returns the offset and scale of uvs: a quantized uv q
+  /// decodes to offset + scale * q / 65535.
+  const vec2f& uvOffset() const
+  {
+    return _uvOffset;
+  }
+
+  const vec2f& uvScale() const
+  {
+    return _uvScale;
+  }
+
+  /// Returns the size in bytes of the quantized attributes.
+  size_t size() const
+  {
+    return _vertices.size() + _uv.size() * sizeof(uint16_t);
+  }
+
+  /// Maps a unit vector to the [-1, 1] square.
+  static vec2f encodeOctahedral(const vec3f& n);
+
+private:
+  int _numberOfVertices;
+  NormalFormat _normalFormat;
+  std::vector<uint8_t> _vertices;
+  std::vector<uint16_t> _uv;
+  vec3f _positionOffset;
+  vec3f _positionScale;
+  vec2f _uvOffset{0, 0};
+  vec2f _uvScale{1, 1};
+
+}; // QuantizedMesh
+
+} // end namespace cg
+
+#endif // __QuantizedMesh_h
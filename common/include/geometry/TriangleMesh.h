@@ -28,7 +28,7 @@
 // Class definition for simple triangle mesh.
 //
 // Author: Paulo Pagliosa
-// Last revision: 02/06/2019
+// Last revision: 19/10/2026
 
 #ifndef __TriangleMesh_h
 #define __TriangleMesh_h
@@ -155,7 +155,7 @@ public:
     int numberOfTriangles;
     vec3f* vertices;
     vec3f* vertexNormals;
-    vec2f* uv{}; // TODO
+    vec2f* uv{};
     Triangle* triangles;
 
   }; // Data
@@ -166,14 +166,33 @@ public:
   /// Constructs a triangle mesh from data.
   TriangleMesh(Data&& data);
 
+  /// \brief Constructs a triangle mesh viewing the arrays of \c data,
+  /// which are owned by \c storage (e.g., a mapped file). The arrays
+  /// are written in place by computeNormals() and TRS().
+  TriangleMesh(const Data& data, SharedObject* storage, const Bounds3f& bounds);
+
   /// Destructor.
   ~TriangleMesh();
 
-  Bounds3f bounds() const;
+  const Bounds3f& bounds() const
+  {
+    return _bounds;
+  }
+
+  /// Returns true if this mesh does not own its arrays.
+  bool isView() const
+  {
+    return _storage != nullptr;
+  }
 
   void computeNormals();
   void TRS(const mat4f& trs);
 
+  /// \brief Reorders the triangles and/or vertices of this mesh.
+  /// Triangle i becomes the old triangle triangleOrder[i], and vertex
+  /// i becomes vertex vertexMap[i]. Either array can be null.
+  void reorder(const int* triangleOrder, const int* vertexMap);
+
   const Data& data() const
   {
     return _data;
@@ -189,10 +208,18 @@ public:
     return _data.uv != nullptr;
   }
 
+  /// Returns the size in bytes of the arrays of this mesh.
+  size_t memorySize() const;
+
   void print(const char* s, FILE* f = stdout) const;
 
 private:
   Data _data;
+  Bounds3f _bounds;
+  Reference<SharedObject> _storage;
+
+  void updateBounds();
+  void makeOwner();
 
 }; // TriangleMesh
 
@@ -0,0 +1,236 @@
+//[]---------------------------------------------------------------[]
+//|                                                                 |
+//| Copyright (C) 2018, 2019 Orthrus Group.                         |
+//|                                                                 |
+//| This software is provided 'as-is', without any express or       |
+//| implied warranty. In no event will the authors be held liable   |
+//| for any damages arising from the use of this software.          |
+//|                                                                 |
+//| Permission is granted to anyone to use this software for any    |
+//| purpose, including commercial applications, and to alter it and |
+//| redistribute it freely, subject to the following restrictions:  |
+//|                                                                 |
+//| 1. The origin of this software must not be misrepresented; you  |
+//| must not claim that you wrote the original software. If you use |
+//| this software in a product, an acknowledgment in the product    |
+//| documentation would be appreciated but is not required.         |
+//|                                                                 |
+//| 2. Altered source versions must be plainly marked as such, and  |
+//| must not be misrepresented as being the original software.      |
+//|                                                                 |
+//| 3. This notice may not be removed or altered from any source    |
+//| distribution.                                                   |
+//|                                                                 |
+//[]---------------------------------------------------------------[]
+// OVERVIEW: AccumulationBuffer.h
+// ========
+// Class definition for HDR accumulation buffer.
+//
+// Author: Paulo Pagliosa
+// Last revision: 19/10/2026
+
+#ifndef __AccumulationBuffer_h
+#define __AccumulationBuffer_h
+
+#include "graphics/ColorConversion.h"
+#include <algorithm>
+
+namespace cg
+{ // begin namespace cg
+
+
+/////////////////////////////////////////////////////////////////////
+//
+// AccumulationBuffer: HDR accumulation buffer class
+// ==================
+//
+// Float RGBA buffer accumulating any number of samples per pixel.
+// The value of a pixel is the running average of its samples, which
+// are unbounded; resolve() converts averages to pixels applying
+// exposure, tone mapping and encoding. The variance of the luminance
+// of the samples of a pixel is also estimated, e.g., for adaptive
+// sampling.
+//
+// Pixels can be stored in row-major order or in 8x8 blocks, each one
+// contiguous in memory. Blocks only improve the locality of renderers
+// that accumulate the samples of tiles aligned to blocks, e.g., the
+// ray tracer; readers of whole rows, as resolve(), gain nothing from
+// them. Blocks are converted to rows by resolve().
+//
+class AccumulationBuffer
+{
+public:
+  static constexpr int blockSize = 8;
+
+  /// Accumulated samples of a pixel, e.g., to checkpoint a buffer.
+  struct PixelState
+  {
+    Color sum;
+    float squares;
+    uint32_t samples;
+
+  }; // PixelState
+
+  enum class Layout
+  {
+    RowMajor,
+    Tiled, // blocks in row-major order, pixels in row-major order
+    Morton // blocks in row-major order, pixels in Morton order
+
+  }; // Layout
+
+  // Default constructor.
+  AccumulationBuffer() = default;
+
+  // Constructor.
+  AccumulationBuffer(int width, int height, Layout layout = Layout::RowMajor);
+
+  AccumulationBuffer(const AccumulationBuffer&) = delete;
+  AccumulationBuffer& operator =(const AccumulationBuffer&) = delete;
+
+  // Move constructor and operator.
+  AccumulationBuffer(AccumulationBuffer&& other) noexcept;
+  AccumulationBuffer& operator =(AccumulationBuffer&& other) noexcept;
+
+  // Destructor.
+  ~AccumulationBuffer()
+  {
+    delete []_data;
+    delete []_samples;
+    delete []_squares;
+  }
+
+  /// Returns the (Rec. 709) luminance of \c c.
+  static float luminance(const Color& c)
+  {
+    return 0.2126f * c.r + 0.7152f * c.g + 0.0722f * c.b;
+  }
+
+  auto width() const
+  {
+    return _W;
+  }
+
+  auto height() const
+  {
+    return _H;
+  }
+
+  auto layout() const
+  {
+    return _layout;
+  }
+
+  /// Discards the samples of all pixels.
+  void clear();
+
+  /// Adds a sample to pixel (x, y).
+  void add(int x, int y, const Color& c)
+  {
+    auto i = index(x, y);
+
+    auto l = luminance(c);
+
+    _data[i] += c;
+    _squares[i] += l * l;
+    ++_samples[i];
+  }
+
+  /// Returns the number of samples of pixel (x, y).
+  auto samples(int x, int y) const
+  {
+    return _samples[index(x, y)];
+  }
+
+  /// Returns the average of the samples of pixel (x, y).
+  Color mean(int x, int y) const
+  {
+    auto i = index(x, y);
+    auto n = _samples[i];
+
+    return n > 0 ? _data[i] * math::inverse(float(n)) : Color::black;
+  }
+
+  /// Returns the accumulated samples of pixel (x, y).
+  PixelState state(int x, int y) const
+  {
+    auto i = index(x, y);
+
+    return {_data[i], _squares[i], _samples[i]};
+  }
+
+  /// Replaces the accumulated samples of pixel (x, y) by \c s.
+  void setState(int x, int y, const PixelState& s)
+  {
+    auto i = index(x, y);
+
+    _data[i] = s.sum;
+    _squares[i] = s.squares;
+    _samples[i] = s.samples;
+  }
+
+  /// \brief Returns the (unbiased) sample variance of the luminance
+  /// of the samples of pixel (x, y).
+  float variance(int x, int y) const
+  {
+    auto i = index(x, y);
+    auto n = _samples[i];
+
+    if (n < 2)
+      return 0;
+
+    auto m = luminance(_data[i]) / n;
+
+    return std::max(0.0f, (_squares[i] - n * m * m) / (n - 1));
+  }
+
+  /// \brief Resolves the pixels of \c buffer from the pixels of this
+  /// buffer starting at (x, y).
+  void resolve(ImageBuffer& buffer,
+    int x,
+    int y,
+    const ToneMapping& toneMapping) const;
+
+  void resolve(ImageBuffer& buffer, const ToneMapping& toneMapping) const
+  {
+    resolve(buffer, 0, 0, toneMapping);
+  }
+
+private:
+  static constexpr int blockBits = 3;
+  static constexpr int blockMask = blockSize - 1;
+
+  int _W{};
+  int _H{};
+  Layout _layout{};
+  // Number of blocks per row and offsets of the pixels in a block
+  int _blocksPerRow{};
+  const uint8_t* _offsets{};
+  Color* _data{};
+  uint32_t* _samples{};
+  float* _squares{};
+
+  size_t size() const;
+
+  int index(int x, int y) const
+  {
+#ifdef _DEBUG
+    if (x < 0 || x >= _W || y < 0 || y >= _H)
+      image_index_out_of_range();
+#endif // _DEBUG
+    if (_layout == Layout::RowMajor)
+      return y * _W + x;
+
+    auto b = (y >> blockBits) * _blocksPerRow + (x >> blockBits);
+
+    return (b << 2 * blockBits) +
+      _offsets[(y & blockMask) << blockBits | (x & blockMask)];
+  }
+
+  void gatherRow(int x, int y, int n, Color* data, uint32_t* samples) const;
+
+}; // AccumulationBuffer
+
+} // end namespace cg
+
+#endif // __AccumulationBuffer_h
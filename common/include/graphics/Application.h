@@ -28,7 +28,7 @@
 // Class definition for graphics application.
 //
 // Author: Paulo Pagliosa
-// Last revision: 06/08/2018
+// Last revision: 19/10/2026
 
 #ifndef __Application_h
 #define __Application_h
@@ -77,10 +77,10 @@ public:
     p.loadShaders(assetFilePath(vs), assetFilePath(fs));
   }
 
-  /// Loads a mesh from an OBJ file.
+  /// Loads a mesh from an OBJ, PLY or STL file.
   static TriangleMesh* loadMesh(const char* filename)
   {
-    return MeshReader::readOBJ(assetFilePath(filename).c_str());
+    return MeshReader::read(assetFilePath(filename).c_str());
   }
 
 private:
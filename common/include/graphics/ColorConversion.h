@@ -0,0 +1,115 @@
+//[]---------------------------------------------------------------[]
+//|                                                                 |
+//| Copyright (C) 2018, 2019 Orthrus Group.                         |
+//|                                                                 |
+//| This software is provided 'as-is', without any express or       |
+//| implied warranty. In no event will the authors be held liable   |
+//| for any damages arising from the use of this software.          |
+//|                                                                 |
+//| Permission is granted to anyone to use this software for any    |
+//| purpose, including commercial applications, and to alter it and |
+//| redistribute it freely, subject to the following restrictions:  |
+//|                                                                 |
+//| 1. The origin of this software must not be misrepresented; you  |
+//| must not claim that you wrote the original software. If you use |
+//| this software in a product, an acknowledgment in the product    |
+//| documentation would be appreciated but is not required.         |
+//|                                                                 |
+//| 2. Altered source versions must be plainly marked as such, and  |
+//| must not be misrepresented as being the original software.      |
+//|                                                                 |
+//| 3. This notice may not be removed or altered from any source    |
+//| distribution.                                                   |
+//|                                                                 |
+//[]---------------------------------------------------------------[]
+//
+// OVERVIEW: ColorConversion.h
+// ========
+// Class definition for color buffer conversion.
+//
+// Author: Paulo Pagliosa
+// Last revision: 19/10/2026
+
+#ifndef __ColorConversion_h
+#define __ColorConversion_h
+
+#include "graphics/Image.h"
+
+namespace cg
+{ // begin namespace cg
+
+
+/////////////////////////////////////////////////////////////////////
+//
+// ToneMapping: tone mapping settings
+// ===========
+struct ToneMapping
+{
+  enum Operator
+  {
+    Clamp,
+    Reinhard,
+    ACES
+  };
+
+  /// Exposure in stops: colors are scaled by 2^exposure.
+  float exposure{0};
+  Operator op{Clamp};
+  /// Encode the tone mapped colors as sRGB (otherwise, linearly).
+  bool sRGB{false};
+
+}; // ToneMapping
+
+
+/////////////////////////////////////////////////////////////////////
+//
+// ColorConversion: color buffer conversion class
+// ===============
+//
+// Conversions between float colors and 8-bit pixels of whole buffers,
+// vectorized with SSE2 when available. Floats are clamped to [0, 1]
+// and rounded to bytes, or encoded as sRGB by table lookup. NaNs are
+// taken as 0 and infinities as 1.
+//
+class ColorConversion
+{
+public:
+  /// Converts \c n colors to pixels.
+  static void toPixels(const Color* colors,
+    int n,
+    Pixel* pixels,
+    bool sRGB = false);
+
+  /// Converts \c n RGB triples of floats to pixels.
+  static void toPixels(const float* rgb,
+    int n,
+    Pixel* pixels,
+    bool sRGB = false);
+
+  /// Converts \c n colors to RGBA8 pixels with alpha 255.
+  static void toRGBA8(const Color* colors,
+    int n,
+    uint8_t* rgba,
+    bool sRGB = false);
+
+  /// Expands \c n pixels to RGBA8 pixels with alpha 255.
+  static void toRGBA8(const Pixel* pixels, int n, uint8_t* rgba);
+
+  /// \brief Converts \c n pixels to colors in [0, 1], decoding them
+  /// from sRGB if \c sRGB is true.
+  static void toColors(const Pixel* pixels,
+    int n,
+    Color* colors,
+    bool sRGB = false);
+
+  /// Adds \c n pixels of \c b to the ones of \c a, saturating at 255.
+  static void add(Pixel* a, const Pixel* b, int n);
+
+  /// Tone maps \c n floats, which are mapped to [0, 1].
+  static void toneMap(float* v, int n, ToneMapping::Operator op);
+
+}; // ColorConversion
+
+} // end namespace cg
+
+#endif // __ColorConversion_h
@@ -0,0 +1,124 @@
+//[]---------------------------------------------------------------[]
+//|                                                                 |
+//| Copyright (C) 2018, 2019 Orthrus Group.                         |
+//|                                                                 |
+//| This software is provided 'as-is', without any express or       |
+//| implied warranty. In no event will the authors be held liable   |
+//| for any damages arising from the use of this software.          |
+//|                                                                 |
+//| Permission is granted to anyone to use this software for any    |
+//| purpose, including commercial applications, and to alter it and |
+//| redistribute it freely, subject to the following restrictions:  |
+//|                                                                 |
+//| 1. The origin of this software must not be misrepresented; you  |
+//| must not claim that you wrote the original software. If you use |
+//| this software in a product, an acknowledgment in the product    |
+//| documentation would be appreciated but is not required.         |
+//|                                                                 |
+//| 2. Altered source versions must be plainly marked as such, and  |
+//| must not be misrepresented as being the original software.      |
+//|                                                                 |
+//| 3. This notice may not be removed or altered from any source    |
+//| distribution.                                                   |
+//|                                                                 |
+//[]---------------------------------------------------------------[]
+//
+// OVERVIEW: Denoiser.h
+// ========
+// Class definition for edge-avoiding a-trous denoiser.
+//
+// Author: Paulo Pagliosa
+// Last revision: 19/10/2026
+
+#ifndef __Denoiser_h
+#define __Denoiser_h
+
+#include "graphics/Color.h"
+#include "math/Vector3.h"
+#include <vector>
+
+namespace cg
+{ // begin namespace cg
+
+
+/////////////////////////////////////////////////////////////////////
+//
+// Denoiser: edge-avoiding a-trous denoiser class
+// ========
+//
+// Filters a noisy image with the edge-avoiding a-trous wavelet
+// transform (Dammertz, H. et al. Edge-avoiding a-trous wavelet
+// transform for fast global illumination filtering, 2010). Each
+// iteration convolves the image with a 5x5 B3 spline kernel whose
+// taps are 2^i pixels apart, weighted by the differences of color,
+// normal and depth between the pixels. The colors are divided by the
+// albedo before filtering and multiplied after, so that texture
+// detail is not blurred. The feature buffers are optional.
+//
+// Rows are filtered in bands on a thread pool; the taps of a row are
+// computed over planes of floats, four pixels at a time with SSE2
+// intrinsics when CG_SSE2 is defined, and one at a time otherwise.
+//
+class Denoiser
+{
+public:
+  struct Settings
+  {
+    int iterations{5};
+    float sigmaColor{0.6f};
+    float sigmaNormal{0.3f};
+    // Relative to the depth of the pixel filtered
+    float sigmaDepth{0.05f};
+
+  }; // Settings
+
+  struct Features
+  {
+    const vec3f* normal{}; // unit normals, 0 where no surface
+    const float* depth{}; // distances, large where no surface
+    const Color* albedo{};
+
+  }; // Features
+
+  Settings settings;
+
+  /// \brief Denoises the \c width x \c height image \c color,
+  /// row-major, into \c out (which can be \c color).
+  void denoise(int width,
+    int height,
+    const Color* color,
+    const Features& features,
+    Color* out);
+
+private:
+  enum
+  {
+    R,
+    G,
+    B,
+    NX,
+    NY,
+    NZ,
+    Z,
+    numberOfPlanes
+
+  };
+
+  int _W{};
+  int _H{};
+  // Planes of the image being filtered and of the filtered one
+  std::vector<float> _planes[numberOfPlanes];
+  std::vector<float> _filtered[3];
+
+  float* plane(int i, int y)
+  {
+    return _planes[i].data() + size_t(y) * _W;
+  }
+
+  void filterRows(int y0, int y1, int step);
+
+}; // Denoiser
+
+} // end namespace cg
+
+#endif // __Denoiser_h
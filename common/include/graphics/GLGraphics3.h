@@ -28,7 +28,7 @@
 // Class definition for OpenGL 3D graphics.
 //
 // Author: Paulo Pagliosa
-// Last revision: 25/10/2019
+// Last revision: 19/10/2026
 
 #ifndef __GLGraphics3_h
 #define __GLGraphics3_h
@@ -152,6 +152,7 @@ private:
   GLint _lightPositionLoc;
   GLint _colorLoc;
   GLint _flatModeLoc;
+  GLMesh::DecodeUniforms _decodeLocs;
   Color _meshColor;
   Color _gridColor;
 
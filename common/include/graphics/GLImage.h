@@ -28,13 +28,14 @@
 // Class definition for OpenGL image.
 //
 // Author: Paulo Pagliosa
-// Last revision: 21/11/2018
+// Last revision: 19/10/2026
 
 #ifndef __GLImage_h
 #define __GLImage_h
 
 #include "graphics/GLProgram.h"
 #include "graphics/Image.h"
+#include <vector>
 
 namespace cg
 { // begin namespace cg
@@ -44,6 +45,15 @@ namespace cg
 //
 // GLImage: OpenGL image class
 // =======
+//
+// Pixels set into a GL image are written into a mapped pixel buffer
+// object (PBO) and uploaded to the texture of the image by flush(),
+// before the image is drawn. The PBOs are taken from a ring and
+// orphaned when mapped, thus the driver does not stall waiting for
+// previous uploads. Since an orphaned PBO holds only the pixels set
+// since the last flush, the regions set are recorded and uploaded one
+// by one; adjacent regions, such as consecutive scan lines, are merged.
+//
 class GLImage: public Image
 {
 public:
@@ -56,6 +66,9 @@ public:
   // Draws this image.
   void draw(int x, int y) const override;
 
+  // Uploads the pixels set since the last flush.
+  void flush() const;
+
   void bind() const;
 
   operator uint32_t() const
@@ -66,10 +79,37 @@ public:
   // Draws a texture.
   static void draw(uint32_t texture, int x, int y, int width, int height);
 
+protected:
+  bool isBoundToOwnerThread() const override
+  {
+    return true;
+  }
+
 private:
   class Drawer;
 
+  static constexpr int numberOfBuffers = 3;
+
+  struct Stream
+  {
+    uint32_t buffers[numberOfBuffers]{};
+    int current{};
+    struct Region
+    {
+      int x, y, w, h;
+
+    }; // Region
+
+    uint8_t* data{}; // RGBA8
+    // Regions set since the last flush
+    std::vector<Region> regions;
+
+  }; // Stream
+
   uint32_t _handle;
+  mutable Stream _stream;
+
+  uint8_t* mapBuffer();
 
   void setSubImage(int, int, int, int, const Pixel*) override;
   void getSubImage(int, int, int, int, Pixel*) const override;
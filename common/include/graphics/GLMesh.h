@@ -28,12 +28,12 @@
 // Class definition for GL mesh array object.
 //
 // Author: Paulo Pagliosa
-// Last revision: 15/09/2018
+// Last revision: 19/10/2026
 
 #ifndef __GLMesh_h
 #define __GLMesh_h
 
-#include "geometry/TriangleMesh.h"
+#include "geometry/QuantizedMesh.h"
 #include "graphics/GLProgram.h"
 
 namespace cg
@@ -44,10 +44,44 @@ namespace cg
 //
 // GLMesh GL mesh array object class
 // ======
+//
+// Vertex attributes are uploaded as floats or quantized (see
+// QuantizedMesh). Vertex shaders decode quantized attributes through
+// the uniforms set by setDecodeUniforms(): a position p is decoded to
+// positionOffset + positionScale * p and, if octahedralNormals is not
+// zero, the xy components of a normal are unsigned octahedral
+// coordinates.
+//
 class GLMesh: public SharedObject
 {
 public:
-  GLMesh(const TriangleMesh& mesh)
+  enum class Format
+  {
+    Float,
+    Octahedral16,
+    Octahedral8
+  };
+
+  /// Format of the meshes created by glMesh().
+  static inline Format defaultFormat{Format::Float};
+
+  struct DecodeUniforms
+  {
+    GLint positionOffset;
+    GLint positionScale;
+    GLint octahedralNormals;
+
+    void locate(const GLSL::Program& program)
+    {
+      positionOffset = program.uniformLocation("positionOffset");
+      positionScale = program.uniformLocation("positionScale");
+      octahedralNormals = program.uniformLocation("octahedralNormals");
+    }
+
+  }; // DecodeUniforms
+
+  GLMesh(const TriangleMesh& mesh, Format format = Format::Float):
+    _format{format}
   {
     glGenVertexArrays(1, &_vao);
     glBindVertexArray(_vao);
@@ -55,7 +89,9 @@ public:
 
     const auto& m = mesh.data();
 
-    if (auto s = size<vec3f>(m.numberOfVertices))
+    if (format != Format::Float)
+      uploadQuantized(mesh);
+    else if (auto s = size<vec3f>(m.numberOfVertices))
     {
       glBindBuffer(GL_ARRAY_BUFFER, _buffers[0]);
       glBufferData(GL_ARRAY_BUFFER, s, m.vertices, GL_STATIC_DRAW);
@@ -65,11 +101,13 @@ public:
       glBufferData(GL_ARRAY_BUFFER, s, m.vertexNormals, GL_STATIC_DRAW);
       glVertexAttribPointer(1, 3, GL_FLOAT, GL_FALSE, 0, 0);
       glEnableVertexAttribArray(1);
+      _bufferSize = 2 * s;
     }
     if (auto s = size<TriangleMesh::Triangle>(m.numberOfTriangles))
     {
       glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, _buffers[2]);
       glBufferData(GL_ELEMENT_ARRAY_BUFFER, s, m.triangles, GL_STATIC_DRAW);
+      _bufferSize += s;
     }
     _vertexCount = m.numberOfTriangles * 3;
   }
@@ -90,10 +128,70 @@ public:
     return _vertexCount;
   }
 
+  auto format() const
+  {
+    return _format;
+  }
+
+  /// Returns the size in bytes of the GL buffers of this mesh.
+  auto bufferSize() const
+  {
+    return _bufferSize;
+  }
+
+  /// Sets the decoding uniforms of the current program for this mesh.
+  void setDecodeUniforms(const DecodeUniforms& u) const
+  {
+    GLSL::Program::setUniformVec3(u.positionOffset, _positionOffset);
+    GLSL::Program::setUniformVec3(u.positionScale, _positionScale);
+    GLSL::Program::setUniform(u.octahedralNormals, GLint(_format != Format::Float));
+  }
+
+protected:
+  bool isBoundToOwnerThread() const override
+  {
+    return true;
+  }
+
 private:
   GLuint _vao;
   GLuint _buffers[3];
   int _vertexCount;
+  Format _format;
+  size_t _bufferSize{};
+  vec3f _positionOffset{0, 0, 0};
+  vec3f _positionScale{1, 1, 1};
+
+  void uploadQuantized(const TriangleMesh& mesh)
+  {
+    QuantizedMesh q{mesh, _format == Format::Octahedral16 ?
+      QuantizedMesh::NormalFormat::Octahedral16 :
+      QuantizedMesh::NormalFormat::Octahedral8};
+
+    _positionOffset = q.positionOffset();
+    _positionScale = q.positionScale();
+    if (auto n = q.numberOfVertices())
+    {
+      auto stride = q.stride();
+      auto normalType = _format == Format::Octahedral16 ?
+        GL_UNSIGNED_SHORT :
+        GL_UNSIGNED_BYTE;
+
+      // Positions and normals interleaved in one buffer
+      glBindBuffer(GL_ARRAY_BUFFER, _buffers[0]);
+      glBufferData(GL_ARRAY_BUFFER, n * stride, q.vertexData(), GL_STATIC_DRAW);
+      _bufferSize = size_t(n) * stride;
+      glVertexAttribPointer(0, 3, GL_UNSIGNED_SHORT, GL_TRUE, stride, 0);
+      glEnableVertexAttribArray(0);
+      glVertexAttribPointer(1,
+        2,
+        normalType,
+        GL_TRUE,
+        stride,
+        (const void*)size_t(q.normalOffset()));
+      glEnableVertexAttribArray(1);
+    }
+  }
 
   template <typename T>
   static size_t size(int n)
@@ -117,9 +215,9 @@ glMesh(TriangleMesh* mesh)
 
   auto ma = asGLMesh(mesh->userData);
 
-  if (nullptr == ma)
+  if (nullptr == ma || ma->format() != GLMesh::defaultFormat)
   {
-    ma = new GLMesh{*mesh};
+    ma = new GLMesh{*mesh, GLMesh::defaultFormat};
     mesh->userData = ma;
   }
   return ma;
@@ -28,7 +28,7 @@
 // Class definition for generic image.
 //
 // Author: Paulo Pagliosa
-// Last revision: 28/05/2019
+// Last revision: 19/10/2026
 
 #ifndef __Image_h
 #define __Image_h
@@ -98,29 +98,44 @@ struct Pixel
   HOST DEVICE
   void set(const Color& c)
   {
-    r = (byte)(255 * c.r);
-    g = (byte)(255 * c.g);
-    b = (byte)(255 * c.b);
+    r = toByte(c.r);
+    g = toByte(c.g);
+    b = toByte(c.b);
   }
 
+  // Sums saturate at 255.
   HOST DEVICE
   Pixel& operator +=(const Pixel& p)
   {
-    r += p.r;
-    g += p.g;
-    b += p.b;
+    r = add(r, p.r);
+    g = add(g, p.g);
+    b = add(b, p.b);
     return *this;
   }
 
   HOST DEVICE
   Pixel& operator +=(const Color& c)
   {
-    r += (byte)(255 * c.r);
-    g += (byte)(255 * c.g);
-    b += (byte)(255 * c.b);
+    r = add(r, toByte(c.r));
+    g = add(g, toByte(c.g));
+    b = add(b, toByte(c.b));
     return *this;
   }
 
+  // Rounds c clamped to [0, 1] (NaN is taken as 0) to a byte.
+  HOST DEVICE
+  static byte toByte(float c)
+  {
+    return (byte)(!(c > 0) ? 0 : c > 1 ? 255 : 255 * c + 0.5f);
+  }
+
+  HOST DEVICE
+  static byte add(byte a, byte b)
+  {
+    auto s = a + b;
+    return (byte)(s > 255 ? 255 : s);
+  }
+
 }; // Pixel
 
 
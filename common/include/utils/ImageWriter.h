@@ -0,0 +1,151 @@
+//[]---------------------------------------------------------------[]
+//|                                                                 |
+//| Copyright (C) 2019 Orthrus Group.                               |
+//|                                                                 |
+//| This software is provided 'as-is', without any express or       |
+//| implied warranty. In no event will the authors be held liable   |
+//| for any damages arising from the use of this software.          |
+//|                                                                 |
+//| Permission is granted to anyone to use this software for any    |
+//| purpose, including commercial applications, and to alter it and |
+//| redistribute it freely, subject to the following restrictions:  |
+//|                                                                 |
+//| 1. The origin of this software must not be misrepresented; you  |
+//| must not claim that you wrote the original software. If you use |
+//| this software in a product, an acknowledgment in the product    |
+//| documentation would be appreciated but is not required.         |
+//|                                                                 |
+//| 2. Altered source versions must be plainly marked as such, and  |
+//| must not be misrepresented as being the original software.      |
+//|                                                                 |
+//| 3. This notice may not be removed or altered from any source    |
+//| distribution.                                                   |
+//|                                                                 |
+//[]---------------------------------------------------------------[]
+// OVERVIEW: ImageWriter.h
+// ========
+// Class definition for streaming image writer.
+//
+// Author: Paulo Pagliosa
+// Last revision: 19/10/2026
+
+#ifndef __ImageWriter_h
+#define __ImageWriter_h
+
+#include "graphics/Image.h"
+#include <cstdio>
+#include <map>
+#include <vector>
+
+namespace cg
+{ // begin namespace cg
+
+
+//////////////////////////////////////////////////////////
+//
+// ImageWriter: streaming image writer class
+// ===========
+//
+// Writes an image to a PPM, PFM (float) or PNG file as its rows are
+// produced, e.g., by a ray tracer, so that encoding overlaps with
+// rendering. Rows are written in order, from top to bottom, either
+// directly or as tiles, which can be written in any order: a band of
+// tiles is buffered only until all of its tiles are written. Rows are
+// given as pixels or as colors (in [0, 1] for 8-bit formats); PFM
+// files store colors as they are. PNG compression runs on a thread
+// of the writer.
+//
+class ImageWriter: public SharedObject
+{
+public:
+  /// \brief Creates a writer of a \c width x \c height image to
+  /// \c filename, whose format is given by its extension. Returns
+  /// null if the format is unknown or the file cannot be created.
+  static ImageWriter* open(const char* filename, int width, int height);
+
+  /// Returns true if the extension of \c filename is supported.
+  static bool canWrite(const char* filename);
+
+  /// \brief Destructor. The file is closed by the destructors of the
+  /// derived classes, if not closed.
+  ~ImageWriter() override;
+
+  auto width() const
+  {
+    return _W;
+  }
+
+  auto height() const
+  {
+    return _H;
+  }
+
+  /// Returns the number of rows written.
+  auto rowsWritten() const
+  {
+    return _nextRow;
+  }
+
+  /// Returns true if the format stores unbounded colors (PFM).
+  virtual bool isHDR() const
+  {
+    return false;
+  }
+
+  /// Writes the next \c count rows of the image.
+  void writeRows(const Pixel* pixels, int count);
+  void writeRows(const Color* colors, int count);
+
+  /// \brief Writes a tile whose top-left corner is (x, y). The tiles
+  /// of a band, i.e., with the same y, must have the same height.
+  void writeTile(int x, int y, const ImageBuffer& tile);
+  void writeTile(int x, int y, int w, int h, const Color* tile);
+
+  /// \brief Finishes the file; rows not written are black. Returns
+  /// false if writing failed.
+  bool close();
+
+protected:
+  FILE* _file;
+  int _W;
+  int _H;
+  bool _failed{};
+
+  ImageWriter(FILE* file, int width, int height);
+
+  // Write row y; each one converts the row and calls the other
+  virtual void writeRow(int y, const Pixel* row);
+  virtual void writeRow(int y, const Color* row);
+
+  // Writes the trailing data of the file
+  virtual void finish()
+  {
+    // do nothing
+  }
+
+private:
+  // Tiles are buffered in the row format of the writer: colors if
+  // HDR, pixels otherwise
+  struct Band
+  {
+    int height;
+    int count; // pixels written
+    std::vector<Pixel> pixels;
+    std::vector<Color> colors;
+
+  }; // Band
+
+  std::map<int, Band> _bands;
+  std::vector<Pixel> _pixelRow;
+  std::vector<Color> _colorRow;
+  int _nextRow{};
+
+  template <typename T>
+  void putTile(int x, int y, int w, int h, const T* tile, int stride);
+  void writeBand(int y, Band& band);
+
+}; // ImageWriter
+
+} // end namespace cg
+
+#endif // __ImageWriter_h
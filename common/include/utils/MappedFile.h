@@ -0,0 +1,109 @@
+//[]---------------------------------------------------------------[]
+//|                                                                 |
+//| Copyright (C) 2019 Orthrus Group.                               |
+//|                                                                 |
+//| This software is provided 'as-is', without any express or       |
+//| implied warranty. In no event will the authors be held liable   |
+//| for any damages arising from the use of this software.          |
+//|                                                                 |
+//| Permission is granted to anyone to use this software for any    |
+//| purpose, including commercial applications, and to alter it and |
+//| redistribute it freely, subject to the following restrictions:  |
+//|                                                                 |
+//| 1. The origin of this software must not be misrepresented; you  |
+//| must not claim that you wrote the original software. If you use |
+//| this software in a product, an acknowledgment in the product    |
+//| documentation would be appreciated but is not required.         |
+//|                                                                 |
+//| 2. Altered source versions must be plainly marked as such, and  |
+//| must not be misrepresented as being the original software.      |
+//|                                                                 |
+//| 3. This notice may not be removed or altered from any source    |
+//| distribution.                                                   |
+//|                                                                 |
+//[]---------------------------------------------------------------[]
+//
+// OVERVIEW: MappedFile.h
+// ========
+// Class definition for memory-mapped file.
+//
+// Author: Paulo Pagliosa
+// Last revision: 19/10/2026
+
+#ifndef __MappedFile_h
+#define __MappedFile_h
+
+#include "core/SharedObject.h"
+#include <cstddef>
+
+namespace cg
+{ // begin namespace cg
+
+
+//////////////////////////////////////////////////////////
+//
+// MappedFile: memory-mapped file class
+// ==========
+//
+// The file is mapped read-only, or copy-on-write: in the latter case,
+// pages written by the process become private copies and the file is
+// never modified.
+//
+class MappedFile: public SharedObject
+{
+public:
+  /// Maps the whole content of a file into memory.
+  MappedFile(const char* filename, bool copyOnWrite = false);
+
+  /// Destructor.
+  ~MappedFile();
+
+  MappedFile(const MappedFile&) = delete;
+  MappedFile& operator =(const MappedFile&) = delete;
+
+  /// Returns true if the file was successfully mapped.
+  bool isOpen() const
+  {
+    return _data != nullptr;
+  }
+
+  const char* data() const
+  {
+    return _data;
+  }
+
+  /// Returns the mapped data. Must be written only if the file was
+  /// mapped copy-on-write.
+  char* data()
+  {
+    return _data;
+  }
+
+  auto size() const
+  {
+    return _size;
+  }
+
+  const char* begin() const
+  {
+    return _data;
+  }
+
+  const char* end() const
+  {
+    return _data + _size;
+  }
+
+private:
+  char* _data{};
+  size_t _size{};
+#ifdef _WIN32
+  void* _file;
+  void* _mapping{};
+#endif
+
+}; // MappedFile
+
+} // end namespace cg
+
+#endif // __MappedFile_h
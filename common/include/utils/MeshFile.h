@@ -0,0 +1,124 @@
+//[]---------------------------------------------------------------[]
+//|                                                                 |
+//| Copyright (C) 2019 Orthrus Group.                               |
+//|                                                                 |
+//| This software is provided 'as-is', without any express or       |
+//| implied warranty. In no event will the authors be held liable   |
+//| for any damages arising from the use of this software.          |
+//|                                                                 |
+//| Permission is granted to anyone to use this software for any    |
+//| purpose, including commercial applications, and to alter it and |
+//| redistribute it freely, subject to the following restrictions:  |
+//|                                                                 |
+//| 1. The origin of this software must not be misrepresented; you  |
+//| must not claim that you wrote the original software. If you use |
+//| this software in a product, an acknowledgment in the product    |
+//| documentation would be appreciated but is not required.         |
+//|                                                                 |
+//| 2. Altered source versions must be plainly marked as such, and  |
+//| must not be misrepresented as being the original software.      |
+//|                                                                 |
+//| 3. This notice may not be removed or altered from any source    |
+//| distribution.                                                   |
+//|                                                                 |
+//[]---------------------------------------------------------------[]
+//
+// OVERVIEW: MeshFile.h
+// ========
+// Class definition for binary mesh file.
+//
+// Author: Paulo Pagliosa
+// Last revision: 19/10/2026
+
+#ifndef __MeshFile_h
+#define __MeshFile_h
+
+#include "geometry/TriangleMesh.h"
+#include <cstdint>
+#include <cstdio>
+
+namespace cg
+{ // begin namespace cg
+
+
+//////////////////////////////////////////////////////////
+//
+// MeshFile: binary mesh file class
+// ========
+//
+// A mesh file stores a fixed header followed by the vertex, normal,
+// uv and triangle arrays in the in-memory layout of TriangleMesh, each
+// one starting at a 64-byte aligned offset, and an optional opaque
+// section (e.g., a serialized BVH). Reading a mesh file maps it
+// copy-on-write and returns a mesh viewing the mapped arrays, so no
+// vertex data is parsed or copied.
+//
+class MeshFile
+{
+public:
+  static constexpr uint32_t version = 1;
+  static constexpr uint32_t byteOrderMark = 0x01020304;
+  static constexpr uint64_t alignment = 64;
+
+  enum Flags : uint32_t
+  {
+    HasNormals = 1,
+    HasUV = 2,
+    HasBVH = 4
+  };
+
+  struct Header
+  {
+    char magic[4]; // "CGMF"
+    uint32_t version;
+    uint32_t byteOrder; // byteOrderMark as written by the producer
+    uint32_t flags;
+    int32_t numberOfVertices;
+    int32_t numberOfTriangles;
+    float bounds[6]; // min, max
+    uint64_t vertexOffset;
+    uint64_t normalOffset;
+    uint64_t uvOffset;
+    uint64_t triangleOffset;
+    uint64_t bvhOffset;
+    uint64_t bvhSize;
+
+  }; // Header
+
+  struct Section
+  {
+    const void* data;
+    size_t size;
+
+  }; // Section
+
+  /// Writes \c mesh and an optional BVH section to a mesh file.
+  static bool write(const char* filename,
+    const TriangleMesh& mesh,
+    const void* bvh = nullptr,
+    size_t bvhSize = 0);
+
+  /// \brief Writes the image of a mesh file at the current position
+  /// of \c file. Offsets in the image are relative to its beginning.
+  static bool write(FILE* file,
+    const TriangleMesh& mesh,
+    const void* bvh = nullptr,
+    size_t bvhSize = 0);
+
+  /// \brief Reads a mesh file. If \c bvh is not null, it receives the
+  /// BVH section of the file ({nullptr, 0} if absent), which is valid
+  /// while the mesh is alive.
+  static TriangleMesh* read(const char* filename, Section* bvh = nullptr);
+
+  /// \brief Returns a mesh viewing the image of a mesh file in memory,
+  /// or null if the image is invalid. The image is owned by \c storage.
+  static TriangleMesh* read(SharedObject* storage,
+    char* image,
+    size_t size,
+    Section* bvh = nullptr);
+
+}; // MeshFile
+
+} // end namespace cg
+
+#endif // __MeshFile_h
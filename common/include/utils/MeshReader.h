@@ -28,7 +28,7 @@
 // Class definition for mesh reader.
 //
 // Author: Paulo Pagliosa
-// Last revision: 15/09/2018
+// Last revision: 19/10/2026
 
 #ifndef __MeshReader_h
 #define __MeshReader_h
@@ -48,6 +48,18 @@ class MeshReader
 public:
   static TriangleMesh* readOBJ(const char* filename);
 
+  /// Reads a binary (little or big-endian) PLY file.
+  static TriangleMesh* readPLY(const char* filename);
+
+  /// Reads a binary STL file, welding vertices of equal positions.
+  static TriangleMesh* readSTL(const char* filename);
+
+  /// Returns true if the extension of \c filename is .obj, .ply or .stl.
+  static bool canRead(const char* filename);
+
+  /// Reads a mesh file of any of the formats above.
+  static TriangleMesh* read(const char* filename);
+
 }; // MeshReader
 
 } // end namespace cg
@@ -0,0 +1,273 @@
+//[]---------------------------------------------------------------[]
+//|                                                                 |
+//| Copyright (C) 2018, 2019 Orthrus Group.                         |
+//|                                                                 |
+//| This software is provided 'as-is', without any express or       |
+//| implied warranty. In no event will the authors be held liable   |
+//| for any damages arising from the use of this software.          |
+//|                                                                 |
+//| Permission is granted to anyone to use this software for any    |
+//| purpose, including commercial applications, and to alter it and |
+//| redistribute it freely, subject to the following restrictions:  |
+//|                                                                 |
+//| 1. The origin of this software must not be misrepresented; you  |
+//| must not claim that you wrote the original software. If you use |
+//| this software in a product, an acknowledgment in the product    |
+//| documentation would be appreciated but is not required.         |
+//|                                                                 |
+//| 2. Altered source versions must be plainly marked as such, and  |
+//| must not be misrepresented as being the original software.      |
+//|                                                                 |
+//| 3. This notice may not be removed or altered from any source    |
+//| distribution.                                                   |
+//|                                                                 |
+//[]---------------------------------------------------------------[]
+// OVERVIEW: AccumulationBuffer.cpp
+// ========
+// Source file for HDR accumulation buffer.
+//
+// Author: Paulo Pagliosa
+// Last revision: 19/10/2026
+
+#include "graphics/AccumulationBuffer.h"
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+namespace cg
+{ // begin namespace cg
+
+namespace internal
+{ // begin namespace internal
+
+//
+// The pixels of a row are resolved in blocks: channels are first
+// averaged and exposed as a flat float array, in a loop without
+// branches or calls that the compiler vectorizes, and then tone mapped
+// and encoded by the color conversion kernels
+//
+constexpr int resolveBlockSize = 64;
+
+void
+resolveRow(const Color* data,
+  const uint32_t* samples,
+  int n,
+  const ToneMapping& toneMapping,
+  Pixel* pixels)
+{
+  float v[resolveBlockSize * 3];
+  auto exposure = std::exp2(toneMapping.exposure);
+
+  for (int b = 0; b < n; b += resolveBlockSize)
+  {
+    auto m = std::min(resolveBlockSize, n - b);
+    auto c = data + b;
+    auto s = samples + b;
+
+    // NaNs are taken as 0
+    for (int i = 0; i < m; ++i)
+    {
+      auto w = exposure / float(std::max(s[i], 1u));
+
+      v[3 * i] = std::max(0.0f, c[i].r * w);
+      v[3 * i + 1] = std::max(0.0f, c[i].g * w);
+      v[3 * i + 2] = std::max(0.0f, c[i].b * w);
+    }
+    ColorConversion::toneMap(v, m * 3, toneMapping.op);
+    ColorConversion::toPixels(v, m, pixels + b, toneMapping.sRGB);
+  }
+}
+
+//
+// Offsets of the pixels in a block, indexed by (y << 3 | x)
+//
+class BlockOffsets
+{
+public:
+  constexpr BlockOffsets(bool morton):
+    _offsets{}
+  {
+    for (int y = 0; y < 8; ++y)
+      for (int x = 0; x < 8; ++x)
+        _offsets[y << 3 | x] = uint8_t(morton ?
+          (x & 1) | (y & 1) << 1 | (x & 2) << 1 |
+          (y & 2) << 2 | (x & 4) << 2 | (y & 4) << 3 :
+          y << 3 | x);
+  }
+
+  auto data() const
+  {
+    return _offsets;
+  }
+
+private:
+  uint8_t _offsets[64];
+
+}; // BlockOffsets
+
+static constexpr BlockOffsets tiledOffsets{false};
+static constexpr BlockOffsets mortonOffsets{true};
+
+} // end namespace internal
+
+
+/////////////////////////////////////////////////////////////////////
+//
+// AccumulationBuffer implementation
+// ==================
+static_assert(AccumulationBuffer::blockSize == 8);
+
+AccumulationBuffer::AccumulationBuffer(int w, int h, Layout layout)
+{
+#ifdef _DEBUG
+  if (w < 1 || h < 1)
+    throw std::logic_error("AccumulationBuffer: bad size");
+#endif // _DEBUG
+  _W = w;
+  _H = h;
+  _layout = layout;
+  _blocksPerRow = (w + blockMask) >> blockBits;
+  if (layout == Layout::Tiled)
+    _offsets = internal::tiledOffsets.data();
+  else if (layout == Layout::Morton)
+    _offsets = internal::mortonOffsets.data();
+
+  // Blocked buffers are padded to whole blocks
+  auto n = size();
+
+  _data = new Color[n];
+  _samples = new uint32_t[n];
+  _squares = new float[n];
+  clear();
+}
+
+AccumulationBuffer::AccumulationBuffer(AccumulationBuffer&& other) noexcept:
+  _W{other._W},
+  _H{other._H},
+  _layout{other._layout},
+  _blocksPerRow{other._blocksPerRow},
+  _offsets{other._offsets},
+  _data{other._data},
+  _samples{other._samples},
+  _squares{other._squares}
+{
+  other._W = other._H = 0;
+  other._data = nullptr;
+  other._samples = nullptr;
+  other._squares = nullptr;
+}
+
+AccumulationBuffer&
+AccumulationBuffer::operator =(AccumulationBuffer&& other) noexcept
+{
+  delete []_data;
+  delete []_samples;
+  delete []_squares;
+  _W = other._W;
+  _H = other._H;
+  _layout = other._layout;
+  _blocksPerRow = other._blocksPerRow;
+  _offsets = other._offsets;
+  _data = other._data;
+  _samples = other._samples;
+  _squares = other._squares;
+  other._W = other._H = 0;
+  other._data = nullptr;
+  other._samples = nullptr;
+  other._squares = nullptr;
+  return *this;
+}
+
+size_t
+AccumulationBuffer::size() const
+{
+  if (_layout == Layout::RowMajor)
+    return (size_t)_W * _H;
+
+  auto rows = (size_t)(_H + blockMask) >> blockBits;
+
+  return rows * _blocksPerRow << 2 * blockBits;
+}
+
+void
+AccumulationBuffer::clear()
+{
+  auto n = size();
+
+  std::fill_n(_data, n, Color{0, 0, 0, 0});
+  memset(_samples, 0, n * sizeof(uint32_t));
+  std::fill_n(_squares, n, 0.0f);
+}
+
+void
+AccumulationBuffer::resolve(ImageBuffer& buffer,
+  int x,
+  int y,
+  const ToneMapping& toneMapping) const
+{
+  auto w = std::min(buffer.width(), _W - x);
+  auto h = std::min(buffer.height(), _H - y);
+
+  if (_layout == Layout::RowMajor)
+  {
+    for (int j = 0; j < h; ++j)
+    {
+      auto i = index(x, y + j);
+
+      internal::resolveRow(_data + i,
+        _samples + i,
+        w,
+        toneMapping,
+        &buffer(0, j));
+    }
+    return;
+  }
+
+  // Rows of blocked buffers are gathered in runs before resolved
+  constexpr auto n = internal::resolveBlockSize;
+  Color data[n];
+  uint32_t samples[n];
+
+  for (int j = 0; j < h; ++j)
+    for (int i = 0; i < w; i += n)
+    {
+      auto m = std::min(n, w - i);
+
+      gatherRow(x + i, y + j, m, data, samples);
+      internal::resolveRow(data, samples, m, toneMapping, &buffer(i, j));
+    }
+}
+
+void
+AccumulationBuffer::gatherRow(int x,
+  int y,
+  int n,
+  Color* data,
+  uint32_t* samples) const
+{
+  if (_layout == Layout::Tiled)
+  {
+    // The pixels of a row in a block are contiguous
+    for (int e = x + n; x < e;)
+    {
+      auto i = index(x, y);
+      auto m = std::min(blockSize - (x & blockMask), e - x);
+
+      std::copy_n(_data + i, m, data);
+      std::copy_n(_samples + i, m, samples);
+      data += m;
+      samples += m;
+      x += m;
+    }
+    return;
+  }
+  for (int k = 0; k < n; ++k)
+  {
+    auto i = index(x + k, y);
+
+    data[k] = _data[i];
+    samples[k] = _samples[i];
+  }
+}
+
+} // end namespace cg
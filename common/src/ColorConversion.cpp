@@ -0,0 +1,368 @@
+//[]---------------------------------------------------------------[]
+//|                                                                 |
+//| Copyright (C) 2018, 2019 Orthrus Group.                         |
+//|                                                                 |
+//| This software is provided 'as-is', without any express or       |
+//| implied warranty. In no event will the authors be held liable   |
+//| for any damages arising from the use of this software.          |
+//|                                                                 |
+//| Permission is granted to anyone to use this software for any    |
+//| purpose, including commercial applications, and to alter it and |
+//| redistribute it freely, subject to the following restrictions:  |
+//|                                                                 |
+//| 1. The origin of this software must not be misrepresented; you  |
+//| must not claim that you wrote the original software. If you use |
+//| this software in a product, an acknowledgment in the product    |
+//| documentation would be appreciated but is not required.         |
+//|                                                                 |
+//| 2. Altered source versions must be plainly marked as such, and  |
+//| must not be misrepresented as being the original software.      |
+//|                                                                 |
+//| 3. This notice may not be removed or altered from any source    |
+//| distribution.                                                   |
+//|                                                                 |
+//[]---------------------------------------------------------------[]
+//
+// OVERVIEW: ColorConversion.cpp
+// ========
+// Source file for color buffer conversion.
+//
+// Author: Paulo Pagliosa
+// Last revision: 19/10/2026
+
+#include "graphics/ColorConversion.h"
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+#ifdef CG_SSE2
+#include <emmintrin.h>
+#endif
+
+namespace cg
+{ // begin namespace cg
+
+namespace internal
+{ // begin namespace internal
+
+static_assert(sizeof(Pixel) == 3, "Pixel must be packed RGB");
+static_assert(sizeof(Color) == 4 * sizeof(float), "Color must be RGBA");
+
+//
+// sRGB encoding of the linear values quantized to 12 bits, and
+// decoding of the bytes
+//
+constexpr int srgbTableSize = 4096;
+
+class SRGBTables
+{
+public:
+  SRGBTables()
+  {
+    for (int i = 0; i < srgbTableSize; ++i)
+    {
+      auto v = i / float(srgbTableSize - 1);
+      auto s = v <= 0.0031308f ?
+        12.92f * v :
+        1.055f * std::pow(v, 1 / 2.4f) - 0.055f;
+
+      encode[i] = Pixel::byte(s * 255 + 0.5f);
+    }
+    for (int i = 0; i < 256; ++i)
+    {
+      auto s = i / 255.0f;
+
+      decode[i] = s <= 0.04045f ?
+        s / 12.92f :
+        std::pow((s + 0.055f) / 1.055f, 2.4f);
+      linear[i] = s;
+    }
+  }
+
+  Pixel::byte encode[srgbTableSize];
+  float decode[256];
+  float linear[256];
+
+}; // SRGBTables
+
+static const SRGBTables srgb;
+
+// NaNs are taken as 0
+inline float
+clamp01(float v)
+{
+  return std::min(1.0f, std::max(0.0f, v));
+}
+
+inline Pixel::byte
+toByte(float v)
+{
+  return Pixel::byte(clamp01(v) * 255 + 0.5f);
+}
+
+inline Pixel::byte
+toSRGB(float v)
+{
+  return srgb.encode[int(clamp01(v) * (srgbTableSize - 1) + 0.5f)];
+}
+
+#ifdef CG_SSE2
+
+// Returns the integers round(clamp01(v) * s)
+inline __m128i
+quantize(__m128 v, __m128 s)
+{
+  const auto zero = _mm_setzero_ps();
+  const auto one = _mm_set1_ps(1);
+  const auto half = _mm_set1_ps(0.5f);
+
+  v = _mm_min_ps(_mm_max_ps(v, zero), one);
+  return _mm_cvttps_epi32(_mm_add_ps(_mm_mul_ps(v, s), half));
+}
+
+// Converts 16 floats to 16 bytes
+inline __m128i
+toBytes(const float* v)
+{
+  const auto s = _mm_set1_ps(255);
+  auto q0 = quantize(_mm_loadu_ps(v), s);
+  auto q1 = quantize(_mm_loadu_ps(v + 4), s);
+  auto q2 = quantize(_mm_loadu_ps(v + 8), s);
+  auto q3 = quantize(_mm_loadu_ps(v + 12), s);
+
+  return _mm_packus_epi16(_mm_packs_epi32(q0, q1), _mm_packs_epi32(q2, q3));
+}
+
+// Encodes 16 floats as sRGB
+inline void
+toSRGBBytes(const float* v, uint8_t* b)
+{
+  const auto s = _mm_set1_ps(srgbTableSize - 1);
+  alignas(16) int32_t q[16];
+
+  for (int k = 0; k < 16; k += 4)
+    _mm_store_si128((__m128i*)(q + k), quantize(_mm_loadu_ps(v + k), s));
+  for (int k = 0; k < 16; ++k)
+    b[k] = srgb.encode[q[k]];
+}
+
+#endif // CG_SSE2
+
+// Converts n floats to n bytes
+void
+toBytes(const float* v, int n, uint8_t* b, bool sRGB)
+{
+  int i = 0;
+
+#ifdef CG_SSE2
+  if (sRGB)
+    for (; i + 16 <= n; i += 16)
+      toSRGBBytes(v + i, b + i);
+  else
+    for (; i + 16 <= n; i += 16)
+      _mm_storeu_si128((__m128i*)(b + i), toBytes(v + i));
+#endif // CG_SSE2
+  if (sRGB)
+    for (; i < n; ++i)
+      b[i] = toSRGB(v[i]);
+  else
+    for (; i < n; ++i)
+      b[i] = toByte(v[i]);
+}
+
+} // end namespace internal
+
+
+/////////////////////////////////////////////////////////////////////
+//
+// ColorConversion implementation
+// ===============
+void
+ColorConversion::toPixels(const Color* colors,
+  int n,
+  Pixel* pixels,
+  bool sRGB)
+{
+  auto b = (uint8_t*)pixels;
+  int i = 0;
+
+#ifdef CG_SSE2
+  // Each RGBA quadruple is stored as 4 bytes at the pixel, whose last
+  // one is overwritten by the next pixel; the last pixel is not
+  alignas(16) uint8_t q[16];
+
+  for (; i + 4 < n; i += 4, b += 12)
+  {
+    if (sRGB)
+      internal::toSRGBBytes(&colors[i].r, q);
+    else
+      _mm_store_si128((__m128i*)q, internal::toBytes(&colors[i].r));
+    memcpy(b, q, 4);
+    memcpy(b + 3, q + 4, 4);
+    memcpy(b + 6, q + 8, 4);
+    memcpy(b + 9, q + 12, 4);
+  }
+#endif // CG_SSE2
+  for (; i < n; ++i, b += 3)
+    if (sRGB)
+    {
+      b[0] = internal::toSRGB(colors[i].r);
+      b[1] = internal::toSRGB(colors[i].g);
+      b[2] = internal::toSRGB(colors[i].b);
+    }
+    else
+    {
+      b[0] = internal::toByte(colors[i].r);
+      b[1] = internal::toByte(colors[i].g);
+      b[2] = internal::toByte(colors[i].b);
+    }
+}
+
+void
+ColorConversion::toPixels(const float* rgb, int n, Pixel* pixels, bool sRGB)
+{
+  // The bytes of the pixels are in the order of the floats
+  internal::toBytes(rgb, 3 * n, (uint8_t*)pixels, sRGB);
+}
+
+void
+ColorConversion::toRGBA8(const Color* colors,
+  int n,
+  uint8_t* rgba,
+  bool sRGB)
+{
+  // Colors and RGBA8 pixels have the same layout
+  internal::toBytes((const float*)colors, 4 * n, rgba, sRGB);
+  for (int i = 0; i < n; ++i)
+    rgba[4 * i + 3] = 255;
+}
+
+void
+ColorConversion::toRGBA8(const Pixel* pixels, int n, uint8_t* rgba)
+{
+  auto p = (const uint8_t*)pixels;
+  int i = 0;
+
+  // Pixels but the last one are read as 4 bytes, whose last one is
+  // replaced by the alpha
+  for (uint32_t v; i + 1 < n; ++i)
+  {
+    memcpy(&v, p + 3 * i, 4);
+    rgba[4 * i] = uint8_t(v);
+    rgba[4 * i + 1] = uint8_t(v >> 8);
+    rgba[4 * i + 2] = uint8_t(v >> 16);
+    rgba[4 * i + 3] = 255;
+  }
+  for (; i < n; ++i)
+  {
+    memcpy(rgba + 4 * i, p + 3 * i, 3);
+    rgba[4 * i + 3] = 255;
+  }
+}
+
+void
+ColorConversion::toColors(const Pixel* pixels,
+  int n,
+  Color* colors,
+  bool sRGB)
+{
+  auto table = sRGB ? internal::srgb.decode : internal::srgb.linear;
+
+  for (int i = 0; i < n; ++i)
+    colors[i].setRGB(table[pixels[i].r],
+      table[pixels[i].g],
+      table[pixels[i].b],
+      0.0f);
+}
+
+void
+ColorConversion::add(Pixel* a, const Pixel* b, int n)
+{
+  auto p = (uint8_t*)a;
+  auto q = (const uint8_t*)b;
+  int i = 0;
+
+  n *= 3;
+#ifdef CG_SSE2
+  for (; i + 16 <= n; i += 16)
+  {
+    auto s = _mm_adds_epu8(_mm_loadu_si128((const __m128i*)(p + i)),
+      _mm_loadu_si128((const __m128i*)(q + i)));
+
+    _mm_storeu_si128((__m128i*)(p + i), s);
+  }
+#endif // CG_SSE2
+  for (; i < n; ++i)
+    p[i] = uint8_t(std::min(255, p[i] + q[i]));
+}
+
+void
+ColorConversion::toneMap(float* v, int n, ToneMapping::Operator op)
+{
+  int i = 0;
+
+  // Infinities are mapped to 1 and NaNs to 0
+#ifdef CG_SSE2
+  const auto zero = _mm_setzero_ps();
+  const auto one = _mm_set1_ps(1);
+
+  switch (op)
+  {
+    case ToneMapping::Clamp:
+      for (; i + 4 <= n; i += 4)
+      {
+        auto x = _mm_max_ps(_mm_loadu_ps(v + i), zero);
+
+        _mm_storeu_ps(v + i, _mm_min_ps(x, one));
+      }
+      break;
+
+    case ToneMapping::Reinhard:
+      for (; i + 4 <= n; i += 4)
+      {
+        auto x = _mm_max_ps(_mm_loadu_ps(v + i), zero);
+
+        x = _mm_div_ps(x, _mm_add_ps(one, x));
+        _mm_storeu_ps(v + i, _mm_min_ps(x, one));
+      }
+      break;
+
+    case ToneMapping::ACES:
+      for (; i + 4 <= n; i += 4)
+      {
+        auto x = _mm_max_ps(_mm_loadu_ps(v + i), zero);
+        auto a = _mm_add_ps(_mm_mul_ps(x, _mm_set1_ps(2.51f)),
+          _mm_set1_ps(0.03f));
+        auto b = _mm_add_ps(_mm_mul_ps(x, _mm_set1_ps(2.43f)),
+          _mm_set1_ps(0.59f));
+
+        a = _mm_mul_ps(x, a);
+        b = _mm_add_ps(_mm_mul_ps(x, b), _mm_set1_ps(0.14f));
+        _mm_storeu_ps(v + i, _mm_min_ps(_mm_div_ps(a, b), one));
+      }
+      break;
+  }
+#endif // CG_SSE2
+  for (; i < n; ++i)
+  {
+    auto x = std::max(0.0f, v[i]);
+
+    switch (op)
+    {
+      case ToneMapping::Clamp:
+        break;
+
+      case ToneMapping::Reinhard:
+        x = x / (1 + x);
+        break;
+
+      case ToneMapping::ACES:
+        // Narkowicz, K. ACES filmic tone mapping curve, 2015
+        x = x * (2.51f * x + 0.03f) / (x * (2.43f * x + 0.59f) + 0.14f);
+        break;
+    }
+    v[i] = std::min(1.0f, x);
+  }
+}
+
+} // end namespace cg
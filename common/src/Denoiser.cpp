@@ -0,0 +1,364 @@
+//[]---------------------------------------------------------------[]
+//|                                                                 |
+//| Copyright (C) 2018, 2019 Orthrus Group.                         |
+//|                                                                 |
+//| This software is provided 'as-is', without any express or       |
+//| implied warranty. In no event will the authors be held liable   |
+//| for any damages arising from the use of this software.          |
+//|                                                                 |
+//| Permission is granted to anyone to use this software for any    |
+//| purpose, including commercial applications, and to alter it and |
+//| redistribute it freely, subject to the following restrictions:  |
+//|                                                                 |
+//| 1. The origin of this software must not be misrepresented; you  |
+//| must not claim that you wrote the original software. If you use |
+//| this software in a product, an acknowledgment in the product    |
+//| documentation would be appreciated but is not required.         |
+//|                                                                 |
+//| 2. Altered source versions must be plainly marked as such, and  |
+//| must not be misrepresented as being the original software.      |
+//|                                                                 |
+//| 3. This notice may not be removed or altered from any source    |
+//| distribution.                                                   |
+//|                                                                 |
+//[]---------------------------------------------------------------[]
+//
+// OVERVIEW: Denoiser.cpp
+// ========
+// Source file for edge-avoiding a-trous denoiser.
+//
+// Author: Paulo Pagliosa
+// Last revision: 19/10/2026
+
+#include "core/ThreadPool.h"
+#include "graphics/Denoiser.h"
+#include <algorithm>
+#include <cstring>
+#ifdef CG_SSE2
+#include <emmintrin.h>
+#endif
+
+namespace cg
+{ // begin namespace cg
+
+namespace internal
+{ // begin namespace internal
+
+// B3 spline kernel
+constexpr float kernel[5]{1 / 16.0f, 1 / 4.0f, 3 / 8.0f, 1 / 4.0f, 1 / 16.0f};
+
+// Rows filtered by a task
+constexpr int bandHeight = 16;
+
+// Albedos are clamped from below when colors are divided by them
+constexpr float minAlbedo = 0.01f;
+
+// NaNs are taken as 0 and infinities as the largest half float
+inline float
+finite(float v)
+{
+  return v > 0 ? std::min(v, 65504.0f) : 0;
+}
+
+//
+// exp(x) for x <= 0 computed as 2^i * 2^f, where i is the integer
+// part of x / ln 2 and f, in (-1, 0], its fractional part. 2^f is
+// approximated by a minimax polynomial with relative error 8.4e-8 and
+// p(0) = 1; the relative error of fastExp is below 4e-6 over [-80, 0],
+// due to the rounding of x / ln 2. NaNs and x < -80 are taken as -80
+//
+constexpr float expMin = -80;
+constexpr float log2e = 1.44269504f;
+constexpr float exp2Poly[]
+{
+  1, 0.693143721f, 0.240180143f, 0.0552973583f, 0.00920579828f,
+  0.000944903697f
+};
+
+inline float
+fastExp(float x)
+{
+  auto t = (x > expMin ? x : expMin) * log2e;
+  auto i = int(t);
+  auto f = t - i;
+  auto p = exp2Poly[5];
+
+  for (int k = 4; k >= 0; --k)
+    p = p * f + exp2Poly[k];
+
+  auto e = uint32_t(i + 127) << 23;
+  float s;
+
+  memcpy(&s, &e, sizeof s);
+  return p * s;
+}
+
+// Weights of a tap are kw * exp(-e), where e is the sum of the squared
+// differences of the features scaled by inv
+struct Tap
+{
+  float kw;
+  float inv[3]; // color, normal and depth
+
+}; // Tap
+
+inline float
+tapWeight(const float* const* p,
+  const float* const* q,
+  int x,
+  int o,
+  const Tap& tap)
+{
+  float d[7];
+
+  for (int k = 0; k < 7; ++k)
+    d[k] = q[k][x + o] - p[k][x];
+
+  auto dz = d[6] / p[6][x];
+  auto e = (d[0] * d[0] + d[1] * d[1] + d[2] * d[2]) * tap.inv[0] +
+    (d[3] * d[3] + d[4] * d[4] + d[5] * d[5]) * tap.inv[1] +
+    dz * dz * tap.inv[2];
+
+  return tap.kw * fastExp(-e);
+}
+
+#ifdef CG_SSE2
+
+inline __m128
+fastExp(__m128 x)
+{
+  x = _mm_max_ps(x, _mm_set1_ps(expMin));
+
+  auto t = _mm_mul_ps(x, _mm_set1_ps(log2e));
+  auto i = _mm_cvttps_epi32(t);
+  auto f = _mm_sub_ps(t, _mm_cvtepi32_ps(i));
+  auto p = _mm_set1_ps(exp2Poly[5]);
+
+  for (int k = 4; k >= 0; --k)
+    p = _mm_add_ps(_mm_mul_ps(p, f), _mm_set1_ps(exp2Poly[k]));
+
+  auto e = _mm_slli_epi32(_mm_add_epi32(i, _mm_set1_epi32(127)), 23);
+
+  return _mm_mul_ps(p, _mm_castsi128_ps(e));
+}
+
+// Returns the weights of pixels [x, x + 4)
+inline __m128
+tapWeights(const float* const* p,
+  const float* const* q,
+  int x,
+  int o,
+  const Tap& tap)
+{
+  __m128 d[7];
+
+  for (int k = 0; k < 7; ++k)
+    d[k] = _mm_sub_ps(_mm_loadu_ps(q[k] + x + o), _mm_loadu_ps(p[k] + x));
+
+  auto sq = [](__m128 a) { return _mm_mul_ps(a, a); };
+  auto dc = _mm_add_ps(_mm_add_ps(sq(d[0]), sq(d[1])), sq(d[2]));
+  auto dn = _mm_add_ps(_mm_add_ps(sq(d[3]), sq(d[4])), sq(d[5]));
+  auto dz = sq(_mm_div_ps(d[6], _mm_loadu_ps(p[6] + x)));
+  auto e = _mm_add_ps(_mm_add_ps(_mm_mul_ps(dc, _mm_set1_ps(tap.inv[0])),
+    _mm_mul_ps(dn, _mm_set1_ps(tap.inv[1]))),
+    _mm_mul_ps(dz, _mm_set1_ps(tap.inv[2])));
+
+  e = fastExp(_mm_sub_ps(_mm_setzero_ps(), e));
+  return _mm_mul_ps(_mm_set1_ps(tap.kw), e);
+}
+
+#endif // CG_SSE2
+
+// Accumulates the colors of the pixels [x0, x1) of a row at offset o
+// from them, weighted by the tap
+void
+accumulate(const float* const* p,
+  const float* const* q,
+  int o,
+  int x0,
+  int x1,
+  const Tap& tap,
+  float* const* sums)
+{
+  auto x = x0;
+
+#ifdef CG_SSE2
+  for (; x + 4 <= x1; x += 4)
+  {
+    auto w = tapWeights(p, q, x, o, tap);
+
+    for (int k = 0; k < 3; ++k)
+    {
+      auto s = _mm_loadu_ps(sums[k] + x);
+
+      s = _mm_add_ps(s, _mm_mul_ps(w, _mm_loadu_ps(q[k] + x + o)));
+      _mm_storeu_ps(sums[k] + x, s);
+    }
+    _mm_storeu_ps(sums[3] + x, _mm_add_ps(_mm_loadu_ps(sums[3] + x), w));
+  }
+#endif // CG_SSE2
+  for (; x < x1; ++x)
+  {
+    auto w = tapWeight(p, q, x, o, tap);
+
+    for (int k = 0; k < 3; ++k)
+      sums[k][x] += w * q[k][x + o];
+    sums[3][x] += w;
+  }
+}
+
+inline ThreadPool&
+pool()
+{
+  static ThreadPool pool;
+  return pool;
+}
+
+} // end namespace internal
+
+
+/////////////////////////////////////////////////////////////////////
+//
+// Denoiser implementation
+// ========
+void
+Denoiser::denoise(int w,
+  int h,
+  const Color* color,
+  const Features& features,
+  Color* out)
+{
+  if (w < 1 || h < 1)
+    return;
+  _W = w;
+  _H = h;
+
+  auto n = size_t(w) * h;
+
+  for (auto& p : _planes)
+    p.resize(n);
+  for (auto& p : _filtered)
+    p.resize(n);
+
+  auto albedo = features.albedo;
+
+  for (size_t i = 0; i < n; ++i)
+  {
+    auto c = color[i];
+
+    if (albedo != nullptr)
+    {
+      c.r /= std::max(albedo[i].r, internal::minAlbedo);
+      c.g /= std::max(albedo[i].g, internal::minAlbedo);
+      c.b /= std::max(albedo[i].b, internal::minAlbedo);
+    }
+    _planes[R][i] = internal::finite(c.r);
+    _planes[G][i] = internal::finite(c.g);
+    _planes[B][i] = internal::finite(c.b);
+    if (features.normal != nullptr)
+    {
+      _planes[NX][i] = features.normal[i].x;
+      _planes[NY][i] = features.normal[i].y;
+      _planes[NZ][i] = features.normal[i].z;
+    }
+    else
+      _planes[NX][i] = _planes[NY][i] = _planes[NZ][i] = 0;
+    // Depth differences are divided by depths
+    _planes[Z][i] = features.depth != nullptr ?
+      std::max(features.depth[i], 1e-6f) :
+      1;
+  }
+
+  auto& pool = internal::pool();
+  std::vector<std::future<void>> bands;
+
+  for (int i = 0; i < settings.iterations; ++i)
+  {
+    for (int y = 0; y < h; y += internal::bandHeight)
+    {
+      auto e = std::min(y + internal::bandHeight, h);
+
+      bands.push_back(pool.submit([=]() { filterRows(y, e, 1 << i); }));
+    }
+    for (auto& band : bands)
+      band.get();
+    bands.clear();
+    for (int k = 0; k < 3; ++k)
+      _planes[R + k].swap(_filtered[k]);
+  }
+  for (size_t i = 0; i < n; ++i)
+  {
+    Color c{_planes[R][i], _planes[G][i], _planes[B][i]};
+
+    out[i] = albedo != nullptr ? c * albedo[i] : c;
+  }
+}
+
+void
+Denoiser::filterRows(int y0, int y1, int step)
+{
+  // The color sigma is halved at each iteration, since the image is
+  // smoother (Dammertz et al.)
+  auto sc = settings.sigmaColor / step;
+  internal::Tap tap;
+
+  tap.inv[0] = 1 / (sc * sc);
+  tap.inv[1] = 1 / (settings.sigmaNormal * settings.sigmaNormal);
+  tap.inv[2] = 1 / (settings.sigmaDepth * settings.sigmaDepth);
+
+  std::vector<float> sums[4];
+  float* s[4];
+
+  for (auto& s : sums)
+    s.resize(_W);
+  for (int y = y0; y < y1; ++y)
+  {
+    const float* p[numberOfPlanes];
+
+    for (int k = 0; k < numberOfPlanes; ++k)
+      p[k] = plane(k, y);
+    for (int k = 0; k < 4; ++k)
+    {
+      std::fill(sums[k].begin(), sums[k].end(), 0.0f);
+      s[k] = sums[k].data();
+    }
+
+    for (int dy = -2; dy <= 2; ++dy)
+    {
+      auto yq = y + dy * step;
+
+      // Taps outside the image are skipped
+      if (yq < 0 || yq >= _H)
+        continue;
+
+      const float* q[numberOfPlanes];
+
+      for (int k = 0; k < numberOfPlanes; ++k)
+        q[k] = plane(k, yq);
+      for (int dx = -2; dx <= 2; ++dx)
+      {
+        auto o = dx * step;
+        auto x0 = std::max(0, -o);
+        auto x1 = std::min(_W, _W - o);
+        tap.kw = internal::kernel[dx + 2] * internal::kernel[dy + 2];
+        internal::accumulate(p, q, o, x0, x1, tap, s);
+      }
+    }
+
+    // The center tap has a positive weight
+    auto fr = _filtered[0].data() + size_t(y) * _W;
+    auto fg = _filtered[1].data() + size_t(y) * _W;
+    auto fb = _filtered[2].data() + size_t(y) * _W;
+
+    for (int x = 0; x < _W; ++x)
+    {
+      auto iw = 1 / s[3][x];
+
+      fr[x] = s[0][x] * iw;
+      fg[x] = s[1][x] * iw;
+      fb[x] = s[2][x] * iw;
+    }
+  }
+}
+
+} // end namespace cg
@@ -28,7 +28,7 @@
 // Source file for OpenGL 3D graphics.
 //
 // Author: Paulo Pagliosa
-// Last revision: 25/10/2019
+// Last revision: 19/10/2026
 
 #include "geometry/MeshSweeper.h"
 #include "graphics/GLGraphics3.h"
@@ -47,15 +47,32 @@ static const char* vertexShader = STRINGIFY(
   uniform vec4 color;
   uniform int flatMode;
 
+  uniform vec3 positionOffset = vec3(0);
+  uniform vec3 positionScale = vec3(1);
+  uniform int octahedralNormals;
+
   layout(location = 0) in vec4 position;
   layout(location = 1) in vec3 normal;
   out vec4 vertexColor;
 
+  vec3 decodeNormal(vec3 n)
+  {
+    if (octahedralNormals == 0)
+      return n;
+
+    vec2 e = n.xy * 2 - 1;
+    vec3 v = vec3(e, 1 - abs(e.x) - abs(e.y));
+
+    if (v.z < 0)
+      v.xy = (1 - abs(v.yx)) * vec2(v.x >= 0 ? 1 : -1, v.y >= 0 ? 1 : -1);
+    return v;
+  }
+
   void main()
   {
-    vec4 P = transform * position;
+    vec4 P = transform * vec4(positionOffset + positionScale * position.xyz, 1);
     vec3 L = normalize(lightPosition - vec3(P));
-    vec3 N = normalize(normalMatrix * normal);
+    vec3 N = normalize(normalMatrix * decodeNormal(normal));
 
     gl_Position = vpMatrix * P;
     vertexColor = color * lightColor * max(dot(N, L), float(flatMode));
@@ -213,6 +230,7 @@ GLGraphics3::GLGraphics3():
   _lightPositionLoc = _meshDrawer.uniformLocation("lightPosition");
   _colorLoc = _meshDrawer.uniformLocation("color");
   _flatModeLoc = _meshDrawer.uniformLocation("flatMode");
+  _decodeLocs.locate(_meshDrawer);
   _meshColor = _gridColor = Color{0.5f, 0.5f, 0.5f};
 }
 
@@ -231,6 +249,7 @@ GLGraphics3::drawMesh(TriangleMesh& mesh, const mat4f& t, const mat3f& n)
 
   auto m = glMesh(&mesh);
 
+  m->setDecodeUniforms(_decodeLocs);
   m->bind();
   glDrawElements(GL_TRIANGLES, m->vertexCount(), GL_UNSIGNED_INT, 0);
   GLSL::Program::setCurrent(cp);
@@ -28,9 +28,11 @@
 // Source file for OpenGL image.
 //
 // Author: Paulo Pagliosa
-// Last revision: 05/06/2019
+// Last revision: 19/10/2026
 
+#include "graphics/ColorConversion.h"
 #include "graphics/GLImage.h"
+#include <algorithm>
 #include <memory>
 
 namespace cg
@@ -79,7 +81,7 @@ createTexture(int w, int h)
   glGenTextures(1, &id);
   glBindTexture(GL_TEXTURE_2D, id);
   // Initialize texture
-  glTexStorage2D(GL_TEXTURE_2D, 1, GL_RGB8, w, h);
+  glTexStorage2D(GL_TEXTURE_2D, 1, GL_RGBA8, w, h);
   // Set texture sampler parameters
   glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
   glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
@@ -183,6 +185,14 @@ GLImage::GLImage(int w, int h):
 
 GLImage::~GLImage()
 {
+  if (_stream.data != nullptr)
+  {
+    glBindBuffer(GL_PIXEL_UNPACK_BUFFER, _stream.buffers[_stream.current]);
+    glUnmapBuffer(GL_PIXEL_UNPACK_BUFFER);
+    glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+  }
+  if (*_stream.buffers != 0)
+    glDeleteBuffers(numberOfBuffers, _stream.buffers);
   glDeleteTextures(1, &_handle);
 }
 
@@ -192,18 +202,124 @@ GLImage::bind() const
   glBindTexture(GL_TEXTURE_2D, _handle);
 }
 
+uint8_t*
+GLImage::mapBuffer()
+{
+  auto& s = _stream;
+
+  if (s.data != nullptr)
+    return s.data;
+
+  const auto size = GLsizeiptr(_W) * _H * 4;
+
+  if (*s.buffers == 0)
+  {
+    glGenBuffers(numberOfBuffers, s.buffers);
+    for (auto buffer : s.buffers)
+    {
+      glBindBuffer(GL_PIXEL_UNPACK_BUFFER, buffer);
+      glBufferData(GL_PIXEL_UNPACK_BUFFER, size, nullptr, GL_STREAM_DRAW);
+    }
+  }
+  glBindBuffer(GL_PIXEL_UNPACK_BUFFER, s.buffers[s.current]);
+  // The previous contents of the buffer are orphaned, so the mapping
+  // does not wait for their upload to finish
+  s.data = (uint8_t*)glMapBufferRange(GL_PIXEL_UNPACK_BUFFER,
+    0,
+    size,
+    GL_MAP_WRITE_BIT | GL_MAP_INVALIDATE_BUFFER_BIT);
+  glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+  s.regions.clear();
+  return s.data;
+}
+
 void
 GLImage::setSubImage(int x, int y, int w, int h, const Pixel* data)
 {
-  setTextureData(x, y, w, h, data);
+  auto dst = mapBuffer();
+
+  if (dst == nullptr)
+  {
+    bind();
+    setTextureData(x, y, w, h, data);
+    return;
+  }
+  // Pixels are expanded to RGBA8, the format uploaded without
+  // conversion by the drivers
+  dst += 4 * ((size_t)y * _W + x);
+  for (int i = 0; i < h; ++i, dst += 4 * _W, data += w)
+    ColorConversion::toRGBA8(data, w, dst);
+
+  auto& regions = _stream.regions;
+
+  if (!regions.empty())
+  {
+    auto& r = regions.back();
+
+    // Merge with the last region if both form a rectangle. Rows may
+    // be set upward or downward (e.g., by a ray tracer)
+    if (r.x == x && r.w == w && (r.y + r.h == y || y + h == r.y))
+    {
+      r.y = std::min(r.y, y);
+      r.h += h;
+      return;
+    }
+    if (r.y == y && r.h == h && r.x + r.w == x)
+    {
+      r.w += w;
+      return;
+    }
+  }
+  regions.push_back({x, y, w, h});
 }
 
 void
 GLImage::getSubImage(int x, int y, int w, int h, Pixel* data) const
 {
+  flush();
   getTextureData(x, y, w, h, data);
 }
 
+void
+GLImage::flush() const
+{
+  auto& s = _stream;
+
+  if (s.data == nullptr)
+    return;
+  glBindBuffer(GL_PIXEL_UNPACK_BUFFER, s.buffers[s.current]);
+  s.data = nullptr;
+  // If the buffer was corrupted, its pixels are lost. Only the regions
+  // set are uploaded: the rest of an orphaned buffer is undefined
+  if (glUnmapBuffer(GL_PIXEL_UNPACK_BUFFER) && !s.regions.empty())
+  {
+    GLint ct;
+
+    glGetIntegerv(GL_TEXTURE_BINDING_2D, &ct);
+    bind();
+    glPixelStorei(GL_UNPACK_ROW_LENGTH, _W);
+    for (const auto& r : s.regions)
+    {
+      const auto offset = 4 * ((size_t)r.y * _W + r.x);
+
+      glTexSubImage2D(GL_TEXTURE_2D,
+        0,
+        r.x,
+        r.y,
+        r.w,
+        r.h,
+        GL_RGBA,
+        GL_UNSIGNED_BYTE,
+        (const void*)offset);
+    }
+    glPixelStorei(GL_UNPACK_ROW_LENGTH, 0);
+    glBindTexture(GL_TEXTURE_2D, ct);
+  }
+  s.regions.clear();
+  glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+  s.current = (s.current + 1) % numberOfBuffers;
+}
+
 GLImage::Drawer*
 GLImage::drawer()
 {
@@ -217,6 +333,7 @@ GLImage::drawer()
 void
 GLImage::draw(int x, int y) const
 {
+  flush();
   drawer()->draw(*this, x, y);
 }
 
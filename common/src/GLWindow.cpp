@@ -211,6 +211,8 @@ GLWindow::mainLoop()
     ImGui::Render();
     ImGui_ImplOpenGL3_RenderDrawData(ImGui::GetDrawData());
     glfwSwapBuffers(_window);
+    // Delete GL objects released by other threads.
+    SharedObject::collectDeferred();
   }
 }
 
@@ -235,6 +237,7 @@ GLWindow::show()
   glfwSetWindowUserPointer(_window, this);
   centerWindow();
   glfwMakeContextCurrent(_window);
+  SharedObject::setOwnerThread();
   gl3wInit();
   if (!gl3wIsSupported(4, 0))
     Application::error("OpenGL v400 is not supported");
@@ -28,9 +28,10 @@
 // Source file for generic image.
 //
 // Author: Paulo Pagliosa
-// Last revision: 28/05/2019
+// Last revision: 19/10/2026
 
 #include "graphics/Image.h"
+#include <algorithm>
 
 namespace cg
 { // begin namespace cg
@@ -107,7 +108,7 @@ Image::setData(int x, int y, const ImageBuffer& buffer)
   if (x + w > _W)
     w = _W - x;
   if (y + h > _H)
-    h = _W - y;
+    h = _H - y;
   setSubImage(x, y, w, h, buffer._data);
 }
 
@@ -123,7 +124,7 @@ Image::data(int x, int y, int w, int h) const
   if (x + w > _W)
     w = _W - x;
   if (y + h > _H)
-    h = _W - y;
+    h = _H - y;
 
   ImageBuffer buffer{w, h};
 
@@ -0,0 +1,879 @@
+//[]---------------------------------------------------------------[]
+//|                                                                 |
+//| Copyright (C) 2019 Orthrus Group.                               |
+//|                                                                 |
+//| This software is provided 'as-is', without any express or       |
+//| implied warranty. In no event will the authors be held liable   |
+//| for any damages arising from the use of this software.          |
+//|                                                                 |
+//| Permission is granted to anyone to use this software for any    |
+//| purpose, including commercial applications, and to alter it and |
+//| redistribute it freely, subject to the following restrictions:  |
+//|                                                                 |
+//| 1. The origin of this software must not be misrepresented; you  |
+//| must not claim that you wrote the original software. If you use |
+//| this software in a product, an acknowledgment in the product    |
+//| documentation would be appreciated but is not required.         |
+//|                                                                 |
+//| 2. Altered source versions must be plainly marked as such, and  |
+//| must not be misrepresented as being the original software.      |
+//|                                                                 |
+//| 3. This notice may not be removed or altered from any source    |
+//| distribution.                                                   |
+//|                                                                 |
+//[]---------------------------------------------------------------[]
+// OVERVIEW: ImageWriter.cpp
+// ========
+// Source file for streaming image writer.
+//
+// Author: Paulo Pagliosa
+// Last revision: 19/10/2026
+
+#include "graphics/ColorConversion.h"
+#include "utils/ImageWriter.h"
+#include <algorithm>
+#include <cctype>
+#include <condition_variable>
+#include <cstring>
+#include <deque>
+#include <mutex>
+#include <thread>
+
+namespace cg
+{ // begin namespace cg
+
+namespace internal
+{ // begin namespace internal
+
+static_assert(sizeof(Pixel) == 3, "Pixel must be packed RGB");
+
+// Tiles are converted to the row format of the writer when buffered
+inline void
+convert(const Pixel* pixels, int n, Color* colors)
+{
+  ColorConversion::toColors(pixels, n, colors);
+}
+
+inline void
+convert(const Color* colors, int n, Pixel* pixels)
+{
+  ColorConversion::toPixels(colors, n, pixels);
+}
+
+template <typename T>
+inline void
+convert(const T* src, int n, T* dst)
+{
+  std::copy_n(src, n, dst);
+}
+
+// Offsets of files larger than 2 GB do not fit in a long on Windows
+inline bool
+seekFile(FILE* file, uint64_t offset)
+{
+#ifdef _WIN32
+  return _fseeki64(file, int64_t(offset), SEEK_SET) == 0;
+#else
+  return fseeko(file, off_t(offset), SEEK_SET) == 0;
+#endif
+}
+
+inline uint64_t
+tellFile(FILE* file)
+{
+#ifdef _WIN32
+  return uint64_t(_ftelli64(file));
+#else
+  return uint64_t(ftello(file));
+#endif
+}
+
+inline const char*
+extension(const char* filename)
+{
+  auto dot = strrchr(filename, '.');
+  return dot != nullptr ? dot + 1 : "";
+}
+
+inline bool
+isExtension(const char* filename, const char* ext)
+{
+  auto e = extension(filename);
+
+  for (; *e != 0 && *ext != 0; ++e, ++ext)
+    if (tolower(*e) != *ext)
+      return false;
+  return *e == *ext;
+}
+
+inline void
+putBigEndian(uint8_t* p, uint32_t v)
+{
+  p[0] = uint8_t(v >> 24);
+  p[1] = uint8_t(v >> 16);
+  p[2] = uint8_t(v >> 8);
+  p[3] = uint8_t(v);
+}
+
+
+/////////////////////////////////////////////////////////////////////
+//
+// PPMWriter: binary PPM (P6) writer class
+// =========
+class PPMWriter final: public ImageWriter
+{
+public:
+  PPMWriter(FILE* file, int width, int height):
+    ImageWriter{file, width, height}
+  {
+    fprintf(file, "P6\n%d %d\n255\n", width, height);
+  }
+
+  ~PPMWriter() override
+  {
+    close();
+  }
+
+private:
+  void writeRow(int, const Pixel* row) override
+  {
+    if (fwrite(row, sizeof(Pixel), _W, _file) != size_t(_W))
+      _failed = true;
+  }
+
+}; // PPMWriter
+
+
+/////////////////////////////////////////////////////////////////////
+//
+// PFMWriter: PFM writer class
+// =========
+//
+// PFM rows are stored from bottom to top, so each row is written at
+// its own offset.
+//
+class PFMWriter final: public ImageWriter
+{
+public:
+  PFMWriter(FILE* file, int width, int height):
+    ImageWriter{file, width, height},
+    _row(width * 3)
+  {
+    const uint16_t one{1};
+    // A negative scale means little-endian floats
+    auto scale = *(const uint8_t*)&one == 1 ? "-1.0" : "1.0";
+
+    fprintf(file, "PF\n%d %d\n%s\n", width, height, scale);
+    _dataOffset = internal::tellFile(file);
+  }
+
+  ~PFMWriter() override
+  {
+    close();
+  }
+
+  bool isHDR() const override
+  {
+    return true;
+  }
+
+private:
+  std::vector<float> _row;
+  uint64_t _dataOffset;
+
+  void writeRow(int y, const Color* row) override
+  {
+    for (int i = 0; i < _W; ++i)
+    {
+      _row[3 * i] = row[i].r;
+      _row[3 * i + 1] = row[i].g;
+      _row[3 * i + 2] = row[i].b;
+    }
+
+    auto size = _row.size() * sizeof(float);
+    auto offset = _dataOffset + uint64_t(_H - 1 - y) * size;
+
+    if (!internal::seekFile(_file, offset) ||
+      fwrite(_row.data(), sizeof(float), _row.size(), _file) != _row.size())
+      _failed = true;
+  }
+
+}; // PFMWriter
+
+
+/////////////////////////////////////////////////////////////////////
+//
+// CRC32: PNG chunk checksum
+// =====
+class CRC32
+{
+public:
+  CRC32()
+  {
+    for (uint32_t n = 0; n < 256; ++n)
+    {
+      auto c = n;
+
+      for (int k = 0; k < 8; ++k)
+        c = c & 1 ? 0xedb88320 ^ (c >> 1) : c >> 1;
+      _table[n] = c;
+    }
+  }
+
+  uint32_t operator ()(const uint8_t* data, size_t n, uint32_t crc = 0) const
+  {
+    crc = ~crc;
+    while (n--)
+      crc = _table[(crc ^ *data++) & 0xff] ^ (crc >> 8);
+    return ~crc;
+  }
+
+private:
+  uint32_t _table[256];
+
+}; // CRC32
+
+static const CRC32 crc32;
+
+inline uint32_t
+adler32(const uint8_t* data, size_t n, uint32_t adler)
+{
+  constexpr uint32_t base = 65521;
+  // Largest n such that 255n(n+1)/2 + (n+1)(base-1) fits in 32 bits
+  constexpr size_t maxBlock = 5552;
+  uint32_t a = adler & 0xffff, b = adler >> 16;
+
+  while (n > 0)
+  {
+    auto m = std::min(n, maxBlock);
+
+    n -= m;
+    while (m--)
+    {
+      a += *data++;
+      b += a;
+    }
+    a %= base;
+    b %= base;
+  }
+  return b << 16 | a;
+}
+
+
+/////////////////////////////////////////////////////////////////////
+//
+// Deflater: streaming zlib (RFC 1950/1951) compressor class
+// ========
+//
+// LZ77 with hash chains over a 32 KB window, encoded with the fixed
+// Huffman codes of deflate. Input is compressed in blocks as it is
+// written; matches may reference the data of previous blocks.
+//
+class Deflater
+{
+public:
+  Deflater():
+    _head(hashSize, -1),
+    _prev(windowSize, -1)
+  {
+    // do nothing
+  }
+
+  /// Compresses \c data, appending the output to \c out.
+  void write(const uint8_t* data, size_t n, std::vector<uint8_t>& out);
+
+  /// Compresses the pending input and ends the stream.
+  void finish(std::vector<uint8_t>& out);
+
+private:
+  static constexpr int windowSize = 32768;
+  static constexpr int minMatch = 3;
+  static constexpr int maxMatch = 258;
+  static constexpr int hashBits = 15;
+  static constexpr int hashSize = 1 << hashBits;
+  static constexpr int maxChain = 64;
+  static constexpr size_t blockSize = 1 << 16;
+
+  std::vector<uint8_t> _buffer; // window and pending input
+  int64_t _base{}; // stream position of _buffer[0]
+  int64_t _next{}; // stream position of the next byte to encode
+  std::vector<int64_t> _head;
+  std::vector<int64_t> _prev;
+  uint32_t _adler{1};
+  uint64_t _bits{};
+  int _bitCount{};
+  bool _headerWritten{};
+
+  int64_t end() const
+  {
+    return _base + int64_t(_buffer.size());
+  }
+
+  const uint8_t* at(int64_t pos) const
+  {
+    return _buffer.data() + (pos - _base);
+  }
+
+  int hash(int64_t pos) const
+  {
+    auto p = at(pos);
+    return ((p[0] << 10) ^ (p[1] << 5) ^ p[2]) & (hashSize - 1);
+  }
+
+  void insert(int64_t pos)
+  {
+    if (pos + minMatch > end())
+      return;
+
+    auto h = hash(pos);
+
+    _prev[pos & (windowSize - 1)] = _head[h];
+    _head[h] = pos;
+  }
+
+  void putBits(uint32_t value, int n, std::vector<uint8_t>& out)
+  {
+    _bits |= uint64_t(value) << _bitCount;
+    _bitCount += n;
+    while (_bitCount >= 8)
+    {
+      out.push_back(uint8_t(_bits));
+      _bits >>= 8;
+      _bitCount -= 8;
+    }
+  }
+
+  // Huffman codes are stored from their most significant bit
+  void putCode(uint32_t code, int n, std::vector<uint8_t>& out)
+  {
+    uint32_t r = 0;
+
+    for (int i = 0; i < n; ++i, code >>= 1)
+      r = r << 1 | (code & 1);
+    putBits(r, n, out);
+  }
+
+  void putSymbol(int symbol, std::vector<uint8_t>& out);
+  void putMatch(int length, int distance, std::vector<uint8_t>& out);
+  int longestMatch(int64_t pos, int& distance) const;
+  void encodeBlock(int64_t limit, bool last, std::vector<uint8_t>& out);
+
+}; // Deflater
+
+void
+Deflater::putSymbol(int symbol, std::vector<uint8_t>& out)
+{
+  // Fixed literal/length codes (RFC 1951, 3.2.6)
+  if (symbol < 144)
+    putCode(0x30 + symbol, 8, out);
+  else if (symbol < 256)
+    putCode(0x190 + symbol - 144, 9, out);
+  else if (symbol < 280)
+    putCode(symbol - 256, 7, out);
+  else
+    putCode(0xc0 + symbol - 280, 8, out);
+}
+
+void
+Deflater::putMatch(int length, int distance, std::vector<uint8_t>& out)
+{
+  static const int lengthBase[]{3, 4, 5, 6, 7, 8, 9, 10, 11, 13, 15, 17,
+    19, 23, 27, 31, 35, 43, 51, 59, 67, 83, 99, 115, 131, 163, 195, 227,
+    258};
+  static const int lengthExtra[]{0, 0, 0, 0, 0, 0, 0, 0, 1, 1, 1, 1, 2,
+    2, 2, 2, 3, 3, 3, 3, 4, 4, 4, 4, 5, 5, 5, 5, 0};
+  static const int distanceBase[]{1, 2, 3, 4, 5, 7, 9, 13, 17, 25, 33,
+    49, 65, 97, 129, 193, 257, 385, 513, 769, 1025, 1537, 2049, 3073,
+    4097, 6145, 8193, 12289, 16385, 24577};
+  static const int distanceExtra[]{0, 0, 0, 0, 1, 1, 2, 2, 3, 3, 4, 4,
+    5, 5, 6, 6, 7, 7, 8, 8, 9, 9, 10, 10, 11, 11, 12, 12, 13, 13};
+
+  int l = 28;
+
+  while (lengthBase[l] > length)
+    --l;
+  putSymbol(257 + l, out);
+  putBits(length - lengthBase[l], lengthExtra[l], out);
+
+  int d = 29;
+
+  while (distanceBase[d] > distance)
+    --d;
+  putCode(d, 5, out);
+  putBits(distance - distanceBase[d], distanceExtra[d], out);
+}
+
+int
+Deflater::longestMatch(int64_t pos, int& distance) const
+{
+  auto available = int(std::min<int64_t>(maxMatch, end() - pos));
+
+  if (available < minMatch)
+    return 0;
+
+  auto s = at(pos);
+  auto best = minMatch - 1;
+  auto chain = maxChain;
+
+  for (auto c = _head[hash(pos)]; c >= 0 && pos - c <= windowSize;)
+  {
+    auto t = at(c);
+
+    // Check the byte after the best match first
+    if (t[best] == s[best])
+    {
+      int n = 0;
+
+      while (n < available && t[n] == s[n])
+        ++n;
+      if (n > best)
+      {
+        best = n;
+        distance = int(pos - c);
+        if (n == available)
+          break;
+      }
+    }
+    if (--chain == 0)
+      break;
+
+    auto p = _prev[c & (windowSize - 1)];
+
+    // Entries of the chain are overwritten after windowSize bytes
+    if (p >= c)
+      break;
+    c = p;
+  }
+  return best >= minMatch ? best : 0;
+}
+
+void
+Deflater::encodeBlock(int64_t limit, bool last, std::vector<uint8_t>& out)
+{
+  // Fixed Huffman block
+  putBits(last, 1, out);
+  putBits(1, 2, out);
+  while (_next < limit)
+  {
+    int distance;
+    auto length = longestMatch(_next, distance);
+
+    if (length == 0)
+    {
+      putSymbol(*at(_next), out);
+      insert(_next++);
+    }
+    else
+    {
+      putMatch(length, distance, out);
+      for (auto e = _next + length; _next < e;)
+        insert(_next++);
+    }
+  }
+  putSymbol(256, out);
+
+  // Keep only the window behind the next byte to encode
+  if (auto n = _next - windowSize - _base; n >= int64_t(blockSize))
+  {
+    _buffer.erase(_buffer.begin(), _buffer.begin() + size_t(n));
+    _base += n;
+  }
+}
+
+void
+Deflater::write(const uint8_t* data, size_t n, std::vector<uint8_t>& out)
+{
+  if (!_headerWritten)
+  {
+    // CM = 8 (deflate), CINFO = 7 (32 KB window), FLEVEL = 0
+    out.push_back(0x78);
+    out.push_back(0x01);
+    _headerWritten = true;
+  }
+  _adler = adler32(data, n, _adler);
+  _buffer.insert(_buffer.end(), data, data + n);
+  // Keep a lookahead of maxMatch bytes for the matches of the block
+  if (end() - _next >= int64_t(blockSize + maxMatch))
+    encodeBlock(end() - maxMatch, false, out);
+}
+
+void
+Deflater::finish(std::vector<uint8_t>& out)
+{
+  write(nullptr, 0, out);
+  encodeBlock(end(), true, out);
+  if (_bitCount > 0)
+    putBits(0, 8 - _bitCount, out);
+
+  uint8_t adler[4];
+
+  putBigEndian(adler, _adler);
+  out.insert(out.end(), adler, adler + 4);
+}
+
+
+/////////////////////////////////////////////////////////////////////
+//
+// PNGWriter: PNG writer class
+// =========
+//
+// Rows are queued to a compressor thread, which filters, deflates and
+// writes them in IDAT chunks. The queue is bounded, so a writer never
+// holds more than a few rows.
+//
+class PNGWriter final: public ImageWriter
+{
+public:
+  PNGWriter(FILE* file, int width, int height);
+
+  ~PNGWriter() override
+  {
+    close();
+  }
+
+private:
+  static constexpr size_t maxQueuedRows = 64;
+  static constexpr size_t chunkSize = 1 << 16;
+
+  std::deque<std::vector<uint8_t>> _rows;
+  std::mutex _lock;
+  std::condition_variable _rowQueued;
+  std::condition_variable _rowTaken;
+  std::thread _compressor;
+  bool _done{};
+
+  void writeRow(int y, const Pixel* row) override;
+  void finish() override;
+
+  void compress();
+  void writeChunk(const char* type, const uint8_t* data, size_t size);
+
+}; // PNGWriter
+
+PNGWriter::PNGWriter(FILE* file, int width, int height):
+  ImageWriter{file, width, height}
+{
+  static const uint8_t signature[]{0x89, 'P', 'N', 'G', '\r', '\n', 0x1a, '\n'};
+  uint8_t ihdr[13];
+
+  fwrite(signature, 1, sizeof signature, file);
+  putBigEndian(ihdr, width);
+  putBigEndian(ihdr + 4, height);
+  ihdr[8] = 8; // bit depth
+  ihdr[9] = 2; // color type: RGB
+  ihdr[10] = ihdr[11] = ihdr[12] = 0; // deflate, adaptive filtering, no interlace
+  writeChunk("IHDR", ihdr, sizeof ihdr);
+  _compressor = std::thread{&PNGWriter::compress, this};
+}
+
+void
+PNGWriter::writeChunk(const char* type, const uint8_t* data, size_t size)
+{
+  uint8_t header[8];
+
+  putBigEndian(header, uint32_t(size));
+  memcpy(header + 4, type, 4);
+
+  auto crc = crc32(header + 4, 4);
+
+  crc = crc32(data, size, crc);
+
+  uint8_t trailer[4];
+
+  putBigEndian(trailer, crc);
+  if (fwrite(header, 1, 8, _file) != 8 ||
+    (size > 0 && fwrite(data, 1, size, _file) != size) ||
+    fwrite(trailer, 1, 4, _file) != 4)
+    _failed = true;
+}
+
+void
+PNGWriter::writeRow(int, const Pixel* row)
+{
+  auto data = (const uint8_t*)row;
+  std::unique_lock<std::mutex> lock{_lock};
+
+  _rowTaken.wait(lock, [this]() { return _rows.size() < maxQueuedRows; });
+  _rows.emplace_back(data, data + _W * sizeof(Pixel));
+  lock.unlock();
+  _rowQueued.notify_one();
+}
+
+inline uint8_t
+paeth(int a, int b, int c)
+{
+  auto p = a + b - c;
+  auto pa = abs(p - a), pb = abs(p - b), pc = abs(p - c);
+
+  return uint8_t(pa <= pb && pa <= pc ? a : pb <= pc ? b : c);
+}
+
+//
+// Filters a row with each filter type, keeping the one whose output
+// has the least sum of absolute (signed) values
+//
+static void
+filterRow(const uint8_t* row,
+  const uint8_t* prior,
+  size_t n,
+  std::vector<uint8_t> filtered[5],
+  std::vector<uint8_t>*& best)
+{
+  constexpr size_t bpp = sizeof(Pixel);
+  size_t bestSum = SIZE_MAX;
+
+  for (int type = 0; type < 5; ++type)
+  {
+    auto& f = filtered[type];
+    size_t sum = 0;
+
+    f.resize(n + 1);
+    f[0] = uint8_t(type);
+    for (size_t i = 0; i < n; ++i)
+    {
+      int a = i >= bpp ? row[i - bpp] : 0;
+      int b = prior[i];
+      int c = i >= bpp ? prior[i - bpp] : 0;
+      uint8_t x = row[i];
+
+      switch (type)
+      {
+        case 1: x -= a; break;
+        case 2: x -= b; break;
+        case 3: x -= (a + b) >> 1; break;
+        case 4: x -= paeth(a, b, c); break;
+      }
+      f[i + 1] = x;
+      sum += x < 128 ? x : 256 - x;
+    }
+    if (sum < bestSum)
+    {
+      bestSum = sum;
+      best = &f;
+    }
+  }
+}
+
+void
+PNGWriter::compress()
+{
+  Deflater deflater;
+  std::vector<uint8_t> prior(_W * sizeof(Pixel));
+  std::vector<uint8_t> filtered[5];
+  std::vector<uint8_t> out;
+
+  for (;;)
+  {
+    std::vector<uint8_t> row;
+
+    {
+      std::unique_lock<std::mutex> lock{_lock};
+
+      _rowQueued.wait(lock, [this]() { return _done || !_rows.empty(); });
+      if (_rows.empty())
+        break;
+      row = std::move(_rows.front());
+      _rows.pop_front();
+    }
+    _rowTaken.notify_one();
+
+    std::vector<uint8_t>* best;
+
+    filterRow(row.data(), prior.data(), row.size(), filtered, best);
+    deflater.write(best->data(), best->size(), out);
+    prior.swap(row);
+    if (out.size() >= chunkSize)
+    {
+      writeChunk("IDAT", out.data(), out.size());
+      out.clear();
+    }
+  }
+  deflater.finish(out);
+  writeChunk("IDAT", out.data(), out.size());
+}
+
+void
+PNGWriter::finish()
+{
+  {
+    std::lock_guard<std::mutex> lock{_lock};
+    _done = true;
+  }
+  _rowQueued.notify_one();
+  _compressor.join();
+  writeChunk("IEND", nullptr, 0);
+}
+
+} // end namespace internal
+
+
+//////////////////////////////////////////////////////////
+//
+// ImageWriter implementation
+// ===========
+ImageWriter*
+ImageWriter::open(const char* filename, int width, int height)
+{
+  if (!canWrite(filename) || width < 1 || height < 1)
+    return nullptr;
+
+  auto file = fopen(filename, "wb");
+
+  if (file == nullptr)
+    return nullptr;
+  if (internal::isExtension(filename, "ppm"))
+    return new internal::PPMWriter{file, width, height};
+  if (internal::isExtension(filename, "pfm"))
+    return new internal::PFMWriter{file, width, height};
+  return new internal::PNGWriter{file, width, height};
+}
+
+bool
+ImageWriter::canWrite(const char* filename)
+{
+  return internal::isExtension(filename, "ppm") ||
+    internal::isExtension(filename, "pfm") ||
+    internal::isExtension(filename, "png");
+}
+
+ImageWriter::ImageWriter(FILE* file, int width, int height):
+  _file{file},
+  _W{width},
+  _H{height}
+{
+  // do nothing
+}
+
+ImageWriter::~ImageWriter()
+{
+  if (_file != nullptr)
+    fclose(_file);
+}
+
+void
+ImageWriter::writeRow(int y, const Pixel* row)
+{
+  _colorRow.resize(_W);
+  ColorConversion::toColors(row, _W, _colorRow.data());
+  writeRow(y, _colorRow.data());
+}
+
+void
+ImageWriter::writeRow(int y, const Color* row)
+{
+  _pixelRow.resize(_W);
+  ColorConversion::toPixels(row, _W, _pixelRow.data());
+  writeRow(y, _pixelRow.data());
+}
+
+void
+ImageWriter::writeRows(const Pixel* pixels, int count)
+{
+  for (; count-- > 0 && _nextRow < _H; pixels += _W)
+    writeRow(_nextRow++, pixels);
+}
+
+void
+ImageWriter::writeRows(const Color* colors, int count)
+{
+  for (; count-- > 0 && _nextRow < _H; colors += _W)
+    writeRow(_nextRow++, colors);
+}
+
+template <typename T>
+void
+ImageWriter::putTile(int x, int y, int w, int h, const T* tile, int stride)
+{
+  if (x < 0 || y < _nextRow || x >= _W || y >= _H)
+    return;
+  w = std::min(w, _W - x);
+
+  auto& band = _bands[y];
+  auto hdr = isHDR();
+
+  if (band.height == 0)
+  {
+    band.height = std::min(h, _H - y);
+
+    auto n = size_t(_W) * band.height;
+
+    if (hdr)
+      band.colors.resize(n, Color::black);
+    else
+      band.pixels.resize(n, Pixel{0, 0, 0});
+  }
+  h = std::min(h, band.height);
+  for (int j = 0; j < h; ++j)
+  {
+    auto offset = size_t(j) * _W + x;
+
+    if (hdr)
+      internal::convert(tile + j * stride, w, band.colors.data() + offset);
+    else
+      internal::convert(tile + j * stride, w, band.pixels.data() + offset);
+  }
+  band.count += w * h;
+  // Write the complete bands at the top of the rows not written
+  for (auto b = _bands.begin(); b != _bands.end() && b->first == _nextRow;)
+  {
+    if (b->second.count < _W * b->second.height)
+      break;
+    writeBand(b->first, b->second);
+    b = _bands.erase(b);
+  }
+}
+
+void
+ImageWriter::writeBand(int y, Band& band)
+{
+  // Rows above the band not written are black
+  if (y > _nextRow)
+  {
+    std::vector<Pixel> black(_W, Pixel{0, 0, 0});
+
+    while (_nextRow < y)
+      writeRow(_nextRow++, black.data());
+  }
+  if (isHDR())
+    writeRows(band.colors.data(), band.height);
+  else
+    writeRows(band.pixels.data(), band.height);
+}
+
+void
+ImageWriter::writeTile(int x, int y, const ImageBuffer& tile)
+{
+  putTile(x, y, tile.width(), tile.height(), tile.data(), tile.width());
+}
+
+void
+ImageWriter::writeTile(int x, int y, int w, int h, const Color* tile)
+{
+  putTile(x, y, w, h, tile, w);
+}
+
+bool
+ImageWriter::close()
+{
+  if (_file == nullptr)
+    return !_failed;
+  // Incomplete bands are written as they are
+  for (auto& band : _bands)
+    writeBand(band.first, band.second);
+  _bands.clear();
+
+  std::vector<Pixel> black(_W, Pixel{0, 0, 0});
+
+  while (_nextRow < _H)
+    writeRow(_nextRow++, black.data());
+  finish();
+
+  auto error = ferror(_file) != 0;
+
+  if (fclose(_file) != 0 || error)
+    _failed = true;
+  _file = nullptr;
+  return !_failed;
+}
+
+} // end namespace cg
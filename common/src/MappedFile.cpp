@@ -0,0 +1,135 @@
+//[]---------------------------------------------------------------[]
+//|                                                                 |
+//| Copyright (C) 2019 Orthrus Group.                               |
+//|                                                                 |
+//| This software is provided 'as-is', without any express or       |
+//| implied warranty. In no event will the authors be held liable   |
+//| for any damages arising from the use of this software.          |
+//|                                                                 |
+//| Permission is granted to anyone to use this software for any    |
+//| purpose, including commercial applications, and to alter it and |
+//| redistribute it freely, subject to the following restrictions:  |
+//|                                                                 |
+//| 1. The origin of this software must not be misrepresented; you  |
+//| must not claim that you wrote the original software. If you use |
+//| this software in a product, an acknowledgment in the product    |
+//| documentation would be appreciated but is not required.         |
+//|                                                                 |
+//| 2. Altered source versions must be plainly marked as such, and  |
+//| must not be misrepresented as being the original software.      |
+//|                                                                 |
+//| 3. This notice may not be removed or altered from any source    |
+//| distribution.                                                   |
+//|                                                                 |
+//[]---------------------------------------------------------------[]
+//
+// OVERVIEW: MappedFile.cpp
+// ========
+// Source file for memory-mapped file.
+//
+// Author: Paulo Pagliosa
+// Last revision: 19/10/2026
+
+#include "utils/MappedFile.h"
+
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace cg
+{ // begin namespace cg
+
+
+//////////////////////////////////////////////////////////
+//
+// MappedFile implementation
+// ==========
+#ifdef _WIN32
+
+MappedFile::MappedFile(const char* filename, bool copyOnWrite)
+{
+  _file = CreateFileA(filename,
+    GENERIC_READ,
+    FILE_SHARE_READ,
+    nullptr,
+    OPEN_EXISTING,
+    FILE_ATTRIBUTE_NORMAL | FILE_FLAG_SEQUENTIAL_SCAN,
+    nullptr);
+  if (_file == INVALID_HANDLE_VALUE)
+    return;
+
+  LARGE_INTEGER size;
+
+  if (!GetFileSizeEx(_file, &size) || size.QuadPart == 0)
+    return;
+  _mapping = CreateFileMappingA(_file,
+    nullptr,
+    copyOnWrite ? PAGE_WRITECOPY : PAGE_READONLY,
+    0,
+    0,
+    nullptr);
+  if (_mapping == nullptr)
+    return;
+  _data = (char*)MapViewOfFile(_mapping,
+    copyOnWrite ? FILE_MAP_COPY : FILE_MAP_READ,
+    0,
+    0,
+    0);
+  if (_data != nullptr)
+    _size = size_t(size.QuadPart);
+}
+
+MappedFile::~MappedFile()
+{
+  if (_data != nullptr)
+    UnmapViewOfFile(_data);
+  if (_mapping != nullptr)
+    CloseHandle(_mapping);
+  if (_file != INVALID_HANDLE_VALUE)
+    CloseHandle(_file);
+}
+
+#else
+
+MappedFile::MappedFile(const char* filename, bool copyOnWrite)
+{
+  auto fd = open(filename, O_RDONLY);
+
+  if (fd == -1)
+    return;
+
+  struct stat s;
+
+  if (fstat(fd, &s) == 0 && s.st_size > 0)
+  {
+    auto prot = copyOnWrite ? PROT_READ | PROT_WRITE : PROT_READ;
+    auto p = mmap(nullptr, size_t(s.st_size), prot, MAP_PRIVATE, fd, 0);
+
+    if (p != MAP_FAILED)
+    {
+      if (!copyOnWrite)
+        madvise(p, size_t(s.st_size), MADV_SEQUENTIAL);
+      _data = (char*)p;
+      _size = size_t(s.st_size);
+    }
+  }
+  // The mapping keeps a reference to the file
+  close(fd);
+}
+
+MappedFile::~MappedFile()
+{
+  if (_data != nullptr)
+    munmap(_data, _size);
+}
+
+#endif // _WIN32
+
+} // end namespace cg
@@ -0,0 +1,280 @@
+//[]---------------------------------------------------------------[]
+//|                                                                 |
+//| Copyright (C) 2019 Orthrus Group.                               |
+//|                                                                 |
+//| This software is provided 'as-is', without any express or       |
+//| implied warranty. In no event will the authors be held liable   |
+//| for any damages arising from the use of this software.          |
+//|                                                                 |
+//| Permission is granted to anyone to use this software for any    |
+//| purpose, including commercial applications, and to alter it and |
+//| redistribute it freely, subject to the following restrictions:  |
+//|                                                                 |
+//| 1. The origin of this software must not be misrepresented; you  |
+//| must not claim that you wrote the original software. If you use |
+//| this software in a product, an acknowledgment in the product    |
+//| documentation would be appreciated but is not required.         |
+//|                                                                 |
+//| 2. Altered source versions must be plainly marked as such, and  |
+//| must not be misrepresented as being the original software.      |
+//|                                                                 |
+//| 3. This notice may not be removed or altered from any source    |
+//| distribution.                                                   |
+//|                                                                 |
+//[]---------------------------------------------------------------[]
+//
+// OVERVIEW: MeshFile.cpp
+// ========
+// Source file for binary mesh file.
+//
+// Author: Paulo Pagliosa
+// Last revision: 19/10/2026
+
+#include "utils/MappedFile.h"
+#include "utils/MeshFile.h"
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+
+namespace cg
+{ // begin namespace cg
+
+namespace internal
+{ // begin namespace internal
+
+static const char meshFileMagic[4]{'C', 'G', 'M', 'F'};
+
+inline uint64_t
+alignOffset(uint64_t offset)
+{
+  return (offset + MeshFile::alignment - 1) & ~(MeshFile::alignment - 1);
+}
+
+class MeshFileWriter
+{
+public:
+  MeshFileWriter(FILE* file):
+    _file{file}
+  {
+    // do nothing
+  }
+
+  void write(uint64_t offset, const void* data, size_t size)
+  {
+    static const char zeros[MeshFile::alignment]{};
+
+    // Pad up to the (aligned) offset of the next array
+    while (_ok && _offset < offset)
+    {
+      auto n = size_t(std::min<uint64_t>(offset - _offset, sizeof zeros));
+
+      _ok = fwrite(zeros, 1, n, _file) == n;
+      _offset += n;
+    }
+    if (_ok && size > 0)
+    {
+      _ok = fwrite(data, 1, size, _file) == size;
+      _offset += size;
+    }
+  }
+
+  bool isOk() const
+  {
+    return _ok;
+  }
+
+private:
+  FILE* _file;
+  uint64_t _offset{};
+  bool _ok{true};
+
+}; // MeshFileWriter
+
+inline bool
+isValidArray(const MeshFile::Header& h,
+  uint64_t offset,
+  uint64_t elementSize,
+  uint64_t count,
+  uint64_t fileSize)
+{
+  return offset >= sizeof h &&
+    offset % MeshFile::alignment == 0 &&
+    offset <= fileSize &&
+    count <= (fileSize - offset) / elementSize;
+}
+
+} // end namespace internal
+
+
+//////////////////////////////////////////////////////////
+//
+// MeshFile implementation
+// ========
+bool
+MeshFile::write(const char* filename,
+  const TriangleMesh& mesh,
+  const void* bvh,
+  size_t bvhSize)
+{
+  auto file = fopen(filename, "wb");
+
+  if (file == nullptr)
+    return false;
+
+  auto ok = write(file, mesh, bvh, bvhSize);
+
+  if (fclose(file) == 0 && ok)
+    return true;
+  remove(filename);
+  return false;
+}
+
+bool
+MeshFile::write(FILE* file,
+  const TriangleMesh& mesh,
+  const void* bvh,
+  size_t bvhSize)
+{
+  using namespace internal;
+
+  const auto& data = mesh.data();
+  uint64_t nv = data.numberOfVertices;
+  uint64_t nt = data.numberOfTriangles;
+  Header h{};
+
+  memcpy(h.magic, meshFileMagic, sizeof h.magic);
+  h.version = version;
+  h.byteOrder = byteOrderMark;
+  h.numberOfVertices = data.numberOfVertices;
+  h.numberOfTriangles = data.numberOfTriangles;
+
+  const auto& bounds = mesh.bounds();
+
+  for (int i = 0; i < 3; ++i)
+  {
+    h.bounds[i] = bounds.min()[i];
+    h.bounds[i + 3] = bounds.max()[i];
+  }
+
+  auto offset = alignOffset(sizeof h);
+
+  h.vertexOffset = offset;
+  offset = alignOffset(offset + nv * sizeof(vec3f));
+  if (data.vertexNormals != nullptr)
+  {
+    h.flags |= HasNormals;
+    h.normalOffset = offset;
+    offset = alignOffset(offset + nv * sizeof(vec3f));
+  }
+  if (data.uv != nullptr)
+  {
+    h.flags |= HasUV;
+    h.uvOffset = offset;
+    offset = alignOffset(offset + nv * sizeof(vec2f));
+  }
+  h.triangleOffset = offset;
+  offset = alignOffset(offset + nt * sizeof(TriangleMesh::Triangle));
+  if (bvh != nullptr && bvhSize > 0)
+  {
+    h.flags |= HasBVH;
+    h.bvhOffset = offset;
+    h.bvhSize = bvhSize;
+  }
+
+  MeshFileWriter writer{file};
+
+  writer.write(0, &h, sizeof h);
+  writer.write(h.vertexOffset, data.vertices, nv * sizeof(vec3f));
+  if (h.flags & HasNormals)
+    writer.write(h.normalOffset, data.vertexNormals, nv * sizeof(vec3f));
+  if (h.flags & HasUV)
+    writer.write(h.uvOffset, data.uv, nv * sizeof(vec2f));
+  writer.write(h.triangleOffset,
+    data.triangles,
+    nt * sizeof(TriangleMesh::Triangle));
+  if (h.flags & HasBVH)
+    writer.write(h.bvhOffset, bvh, bvhSize);
+  return writer.isOk();
+}
+
+TriangleMesh*
+MeshFile::read(const char* filename, Section* bvh)
+{
+  // Mapped copy-on-write: the mesh may transform its arrays in place
+  Reference<MappedFile> file{new MappedFile{filename, true}};
+
+  if (!file->isOpen())
+    return nullptr;
+
+  auto mesh = read(file, file->data(), file->size(), bvh);
+
+  if (mesh == nullptr)
+    printf("Invalid mesh file %s\n", filename);
+  return mesh;
+}
+
+TriangleMesh*
+MeshFile::read(SharedObject* storage, char* image, size_t size, Section* bvh)
+{
+  using namespace internal;
+
+  if (bvh != nullptr)
+    *bvh = {nullptr, 0};
+
+  // Keeps the storage alive (and releases it on failure)
+  Reference<SharedObject> s{storage};
+  Header h;
+
+  if (size < sizeof h)
+    return nullptr;
+  memcpy(&h, image, sizeof h);
+  // A mesh file of the other byte order is rejected as well
+  if (memcmp(h.magic, meshFileMagic, sizeof h.magic) != 0 ||
+    h.version != version ||
+    h.byteOrder != byteOrderMark)
+    return nullptr;
+
+  uint64_t nv = h.numberOfVertices;
+  uint64_t nt = h.numberOfTriangles;
+  auto ok = h.numberOfVertices >= 0 && h.numberOfTriangles >= 0 &&
+    isValidArray(h, h.vertexOffset, sizeof(vec3f), nv, size) &&
+    isValidArray(h, h.triangleOffset, sizeof(TriangleMesh::Triangle), nt, size);
+
+  if (ok && (h.flags & HasNormals))
+    ok = isValidArray(h, h.normalOffset, sizeof(vec3f), nv, size);
+  if (ok && (h.flags & HasUV))
+    ok = isValidArray(h, h.uvOffset, sizeof(vec2f), nv, size);
+  if (ok && (h.flags & HasBVH))
+    ok = isValidArray(h, h.bvhOffset, 1, h.bvhSize, size);
+
+  auto base = image;
+  auto triangles = (TriangleMesh::Triangle*)(base + h.triangleOffset);
+
+  // Out of range indices would make every mesh client read outside
+  // the mapping
+  for (uint64_t i = 0; ok && i < nt; ++i)
+    for (auto v : triangles[i].v)
+      ok &= unsigned(v) < nv;
+  if (!ok)
+    return nullptr;
+
+  TriangleMesh::Data data;
+
+  data.numberOfVertices = h.numberOfVertices;
+  data.vertices = (vec3f*)(base + h.vertexOffset);
+  data.vertexNormals = h.flags & HasNormals ?
+    (vec3f*)(base + h.normalOffset) :
+    nullptr;
+  data.uv = h.flags & HasUV ? (vec2f*)(base + h.uvOffset) : nullptr;
+  data.numberOfTriangles = h.numberOfTriangles;
+  data.triangles = triangles;
+  if (bvh != nullptr && (h.flags & HasBVH))
+    *bvh = {base + h.bvhOffset, size_t(h.bvhSize)};
+
+  Bounds3f bounds{vec3f{h.bounds[0], h.bounds[1], h.bounds[2]},
+    vec3f{h.bounds[3], h.bounds[4], h.bounds[5]}};
+
+  return new TriangleMesh{data, storage, bounds};
+}
+
+} // end namespace cg
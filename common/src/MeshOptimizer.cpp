@@ -0,0 +1,257 @@
+//[]---------------------------------------------------------------[]
+//|                                                                 |
+//| Copyright (C) 2018, 2019 Orthrus Group.                         |
+//|                                                                 |
+//| This software is provided 'as-is', without any express or       |
+//| implied warranty. In no event will the authors be held liable   |
+//| for any damages arising from the use of this software.          |
+//|                                                                 |
+//| Permission is granted to anyone to use this software for any    |
+//| purpose, including commercial applications, and to alter it and |
+//| redistribute it freely, subject to the following restrictions:  |
+//|                                                                 |
+//| 1. The origin of this software must not be misrepresented; you  |
+//| must not claim that you wrote the original software. If you use |
+//| this software in a product, an acknowledgment in the product    |
+//| documentation would be appreciated but is not required.         |
+//|                                                                 |
+//| 2. Altered source versions must be plainly marked as such, and  |
+//| must not be misrepresented as being the original software.      |
+//|                                                                 |
+//| 3. This notice may not be removed or altered from any source    |
+//| distribution.                                                   |
+//|                                                                 |
+//[]---------------------------------------------------------------[]
+//
+// OVERVIEW: MeshOptimizer.cpp
+// ========
+// Source file for mesh optimizer.
+//
+// Author: Paulo Pagliosa
+// Last revision: 19/10/2026
+
+#include "geometry/MeshOptimizer.h"
+#include <algorithm>
+#include <climits>
+#include <cmath>
+#include <vector>
+
+namespace cg
+{ // begin namespace cg
+
+namespace internal
+{ // begin namespace internal
+
+//
+// Forsyth, T. Linear-speed vertex cache optimisation, 2006
+//
+constexpr int forsythCacheSize = 32;
+
+class ForsythScore
+{
+public:
+  ForsythScore()
+  {
+    constexpr auto cacheDecayPower = 1.5f;
+    constexpr auto lastTriangleScore = 0.75f;
+    constexpr auto valenceBoostScale = 2.0f;
+    constexpr auto valenceBoostPower = 0.5f;
+
+    for (int i = 0; i < forsythCacheSize; ++i)
+      // The vertices of the last triangle get a fixed score, so that
+      // the next triangle is not biased towards any of its edges
+      _cache[i] = i < 3 ? lastTriangleScore : std::pow(1 - float(i - 3) /
+        (forsythCacheSize - 3), cacheDecayPower);
+    for (int i = 0; i < maxValence; ++i)
+      _valence[i] = valenceBoostScale * std::pow(float(i), -valenceBoostPower);
+  }
+
+  float operator ()(int cachePosition, int activeTriangles) const
+  {
+    if (activeTriangles == 0)
+      return -1;
+
+    auto score = cachePosition < 0 ? 0 : _cache[cachePosition];
+
+    return score + _valence[std::min(activeTriangles, maxValence - 1)];
+  }
+
+private:
+  static constexpr int maxValence = 64;
+
+  float _cache[forsythCacheSize];
+  float _valence[maxValence];
+
+}; // ForsythScore
+
+std::vector<int>
+forsythOrder(const TriangleMesh::Data& data)
+{
+  static const ForsythScore score;
+  auto nv = data.numberOfVertices;
+  auto nt = data.numberOfTriangles;
+  // Triangles adjacent to each vertex, in CSR form; the first active
+  // entries of each vertex are its triangles not yet emitted
+  std::vector<int> offset(nv + 1);
+  std::vector<int> active(nv);
+  std::vector<int> adjacency(3 * size_t(nt));
+
+  for (int i = 0; i < nt; ++i)
+    for (auto v : data.triangles[i].v)
+      ++active[v];
+  for (int v = 0; v < nv; ++v)
+    offset[v + 1] = offset[v] + active[v];
+  std::fill(active.begin(), active.end(), 0);
+  for (int i = 0; i < nt; ++i)
+    for (auto v : data.triangles[i].v)
+      adjacency[offset[v] + active[v]++] = i;
+
+  std::vector<int> cachePosition(nv, -1);
+  std::vector<float> vertexScore(nv);
+  std::vector<float> triangleScore(nt);
+  std::vector<bool> emitted(nt);
+
+  for (int v = 0; v < nv; ++v)
+    vertexScore[v] = score(-1, active[v]);
+  for (int i = 0; i < nt; ++i)
+  {
+    const auto& t = data.triangles[i].v;
+    triangleScore[i] = vertexScore[t[0]] + vertexScore[t[1]] + vertexScore[t[2]];
+  }
+
+  std::vector<int> order;
+  int cache[forsythCacheSize + 3];
+  int cacheSize{0};
+  int best{-1};
+  int cursor{0};
+
+  order.reserve(nt);
+  while (int(order.size()) < nt)
+  {
+    if (best < 0)
+    {
+      // No candidate in the cache: take the next triangle not emitted
+      while (emitted[cursor])
+        ++cursor;
+      best = cursor;
+    }
+    order.push_back(best);
+    emitted[best] = true;
+
+    // Remove the triangle from the active lists of its vertices and
+    // move them to the front of the cache
+    int newCache[forsythCacheSize + 3];
+    int newSize{0};
+
+    for (auto v : data.triangles[best].v)
+    {
+      auto a = adjacency.begin() + offset[v];
+      auto n = active[v];
+
+      for (int k = 0; k < n; ++k)
+        if (a[k] == best)
+        {
+          std::swap(a[k], a[n - 1]);
+          break;
+        }
+      --active[v];
+      newCache[newSize++] = v;
+    }
+    for (int k = 0; k < cacheSize; ++k)
+    {
+      auto v = cache[k];
+
+      if (v != newCache[0] && v != newCache[1] && v != newCache[2])
+        newCache[newSize++] = v;
+    }
+    // Update the scores of the vertices in (or just out of) the cache
+    // and of their active triangles, taking the best one as candidate
+    best = -1;
+
+    auto bestScore = -1.0f;
+
+    for (int k = 0; k < newSize; ++k)
+    {
+      auto v = newCache[k];
+      auto position = k < forsythCacheSize ? k : -1;
+
+      cachePosition[v] = position;
+      vertexScore[v] = score(position, active[v]);
+    }
+    for (int k = 0; k < newSize; ++k)
+    {
+      auto v = newCache[k];
+      auto a = adjacency.begin() + offset[v];
+
+      for (int j = 0; j < active[v]; ++j)
+      {
+        auto i = a[j];
+        const auto& t = data.triangles[i].v;
+        auto s = vertexScore[t[0]] + vertexScore[t[1]] + vertexScore[t[2]];
+
+        triangleScore[i] = s;
+        if (s > bestScore)
+        {
+          bestScore = s;
+          best = i;
+        }
+      }
+    }
+    cacheSize = std::min(newSize, forsythCacheSize);
+    std::copy(newCache, newCache + cacheSize, cache);
+  }
+  return order;
+}
+
+} // end namespace internal
+
+
+/////////////////////////////////////////////////////////////////////
+//
+// MeshOptimizer implementation
+// =============
+float
+MeshOptimizer::acmr(const TriangleMesh& mesh, int cacheSize)
+{
+  const auto& data = mesh.data();
+  auto nt = data.numberOfTriangles;
+
+  if (nt == 0)
+    return 0;
+
+  // Time stamps of the vertex entries of the FIFO cache: a vertex is in
+  // the cache if it entered it less than cacheSize misses ago
+  std::vector<int> stamp(data.numberOfVertices, INT_MIN / 2);
+  int misses{0};
+
+  for (int i = 0; i < nt; ++i)
+    for (auto v : data.triangles[i].v)
+      if (misses - stamp[v] >= cacheSize)
+        stamp[v] = ++misses;
+  return float(misses) / nt;
+}
+
+void
+MeshOptimizer::optimize(TriangleMesh& mesh)
+{
+  const auto& data = mesh.data();
+  auto order = internal::forsythOrder(data);
+
+  mesh.reorder(order.data(), nullptr);
+
+  // Vertices in order of first use; unused ones are kept at the end
+  auto nv = data.numberOfVertices;
+  std::vector<int> map(nv, -1);
+  int next{0};
+
+  for (int i = 0; i < data.numberOfTriangles; ++i)
+    for (auto v : data.triangles[i].v)
+      if (map[v] < 0)
+        map[v] = next++;
+  for (auto& v : map)
+    if (v < 0)
+      v = next++;
+  mesh.reorder(nullptr, map.data());
+}
+
+} // end namespace cg
@@ -28,10 +28,18 @@
 // Source file for mesh reader.
 //
 // Author: Paulo Pagliosa
-// Last revision: 05/09/2019
+// Last revision: 19/10/2026
 
+#include "utils/MappedFile.h"
 #include "utils/MeshReader.h"
-#include <filesystem>
+#include <algorithm>
+#include <cctype>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <thread>
+#include <vector>
 
 namespace cg
 { // begin namespace cg
@@ -39,191 +47,1057 @@ namespace cg
 namespace internal
 { // begin namespace internal
 
+//
+// Tokenizer
+//
+inline bool
+isDigit(char c)
+{
+  return unsigned(c - '0') < 10u;
+}
+
+inline bool
+isBlank(char c)
+{
+  return c == ' ' || c == '\t' || c == '\r';
+}
+
+inline void
+skipBlanks(const char*& p, const char* end)
+{
+  while (p < end && isBlank(*p))
+    ++p;
+}
+
+inline void
+skipLine(const char*& p, const char* end)
+{
+  auto eol = (const char*)memchr(p, '\n', end - p);
+  p = eol != nullptr ? eol + 1 : end;
+}
+
+inline void
+skipToken(const char*& p, const char* end)
+{
+  while (p < end && !isBlank(*p) && *p != '\n')
+    ++p;
+}
+
+inline bool
+parseInt(const char*& p, const char* end, int& value)
+{
+  auto s = p;
+  auto negative = false;
+
+  if (s < end && (*s == '-' || *s == '+'))
+    negative = *s++ == '-';
+  if (s == end || !isDigit(*s))
+    return false;
+
+  int v{};
+
+  while (s < end && isDigit(*s))
+    v = v * 10 + (*s++ - '0');
+  value = negative ? -v : v;
+  p = s;
+  return true;
+}
+
+inline bool
+parseFloat(const char*& p, const char* end, float& value)
+{
+  // Powers of ten exactly representable as doubles
+  static constexpr double e10[]
+  {
+    1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9, 1e10, 1e11,
+    1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22
+  };
+  constexpr uint64_t maxMantissa{(1ull << 53) / 10};
+
+  auto s = p;
+  auto negative = false;
+
+  if (s < end && (*s == '-' || *s == '+'))
+    negative = *s++ == '-';
+
+  uint64_t m{};
+  int e{};
+  auto digits = false;
+
+  for (; s < end && isDigit(*s); ++s, digits = true)
+    if (m < maxMantissa)
+      m = m * 10 + (*s - '0');
+    else
+      ++e;
+  if (s < end && *s == '.')
+    for (++s; s < end && isDigit(*s); ++s, digits = true)
+      if (m < maxMantissa)
+      {
+        m = m * 10 + (*s - '0');
+        --e;
+      }
+  if (!digits)
+    return false;
+  if (s < end && (*s == 'e' || *s == 'E'))
+  {
+    auto t = s + 1;
+    int x;
+
+    if (parseInt(t, end, x))
+    {
+      e += x;
+      s = t;
+    }
+  }
+
+  auto v = double(m);
+
+  if (m != 0)
+  {
+    if (e < 0)
+      v = e >= -22 ? v / e10[-e] : v * pow(10.0, e);
+    else if (e > 0)
+      v = e <= 22 ? v * e10[e] : v * pow(10.0, e);
+  }
+  value = float(negative ? -v : v);
+  p = s;
+  return true;
+}
+
+//
+// Parsing of a chunk of lines of an OBJ file
+//
+// Indices of the position, texture coordinates and normal of a face
+// corner, in this order (-1 if absent)
+struct OBJCorner
+{
+  int index[3];
+
+  bool operator ==(const OBJCorner& other) const
+  {
+    return index[0] == other.index[0] &&
+      index[1] == other.index[1] &&
+      index[2] == other.index[2];
+  }
+
+}; // OBJCorner
+
+enum
+{
+  Position,
+  UV,
+  Normal
+};
+
+struct OBJChunk
+{
+  std::vector<vec3f> positions;
+  std::vector<vec2f> uv;
+  std::vector<vec3f> normals;
+  std::vector<OBJCorner> corners; // three per triangle
+  // Corners holding relative indices of each attribute, which are
+  // stored as chunk local indices, i.e., without the attribute offset
+  // of the chunk
+  std::vector<int> relative[3];
+  int offset[3]{};
+  int cornerOffset{};
+  int cornersWithUV{};
+  int cornersWithNormal{};
+  bool failed{};
+
+  int count(int attribute) const
+  {
+    return attribute == Position ? int(positions.size()) :
+      attribute == UV ? int(uv.size()) : int(normals.size());
+  }
+
+}; // OBJChunk
+
+template <typename vec>
+inline void
+parseVector(const char*& p, const char* end, OBJChunk& chunk, int size,
+  std::vector<vec>& vectors)
+{
+  vec v;
+
+  for (int i = 0; i < size; ++i)
+  {
+    skipBlanks(p, end);
+    if (!parseFloat(p, end, v[i]))
+    {
+      chunk.failed = true;
+      return;
+    }
+  }
+  vectors.push_back(v);
+}
+
+// Parses a face corner: v, v/t, v//n or v/t/n
+inline bool
+parseCorner(const char*& p, const char* end, OBJChunk& chunk,
+  OBJCorner& corner, bool isRelative[3], bool isPresent[3])
+{
+  int index[3]{0, 0, 0};
+
+  if (!parseInt(p, end, index[Position]))
+    return false;
+  if (p < end && *p == '/')
+  {
+    auto ok = true;
+
+    if (++p < end && *p != '/')
+      ok = parseInt(p, end, index[UV]) && index[UV] != 0;
+    if (ok && p < end && *p == '/')
+      ok = parseInt(++p, end, index[Normal]) && index[Normal] != 0;
+    if (!ok)
+    {
+      chunk.failed = true;
+      return false;
+    }
+  }
+  if (index[Position] == 0)
+  {
+    chunk.failed = true;
+    return false;
+  }
+  for (int a = 0; a < 3; ++a)
+  {
+    auto i = index[a];
+
+    isRelative[a] = i < 0;
+    isPresent[a] = i != 0;
+    corner.index[a] = i < 0 ? chunk.count(a) + i : i - 1;
+  }
+  return true;
+}
+
 void
-readMeshSize(FILE* file, TriangleMesh::Data& data)
+parseFace(const char*& p, const char* end, OBJChunk& chunk)
 {
-  const unsigned int lineSize{128};
-  int nv{};
-  int nt{};
+  // Polygons are triangulated as fans: (v0, vi-1, vi)
+  OBJCorner corners[3];
+  bool isRelative[3][3];
+  bool isPresent[3][3];
+  int n{};
+
+  for (;;)
+  {
+    skipBlanks(p, end);
+
+    auto k = n < 3 ? n : 2;
 
-  for (char line[lineSize]; fscanf_s(file, "%s", line, lineSize) != EOF;)
-    switch (line[0])
+    if (n >= 3)
     {
-      case 'v':
-        if (line[1] == '\0')
-            nv++;
-        fgets(line, lineSize, file);
-        break;
+      corners[1] = corners[2];
+      std::copy_n(isRelative[2], 3, isRelative[1]);
+      std::copy_n(isPresent[2], 3, isPresent[1]);
+    }
+    if (!parseCorner(p, end, chunk, corners[k], isRelative[k], isPresent[k]))
+      break;
+    if (++n >= 3)
+    {
+      auto c = int(chunk.corners.size());
 
-      case 'f':
+      for (int i = 0; i < 3; ++i, ++c)
       {
-        int v;
-        int n;
-        int t;
-
-        fscanf_s(file, "%s", line, lineSize);
-        /* can be one of %d, %d//%d, %d/%d, %d/%d/%d %d//%d */
-        if (strstr(line, "//"))
-        {
-          /* v//n */
-          sscanf_s(line, "%d//%d", &v, &n);
-          fscanf_s(file, "%d//%d", &v, &n);
-          fscanf_s(file, "%d//%d", &v, &n);
-          nt++;
-          while (fscanf_s(file, "%d//%d", &v, &n) > 0)
-            nt++;
-        }
-        else if (sscanf_s(line, "%d/%d/%d", &v, &t, &n) == 3)
-        {
-          /* v/t/n */
-          fscanf_s(file, "%d/%d/%d", &v, &t, &n);
-          fscanf_s(file, "%d/%d/%d", &v, &t, &n);
-          nt++;
-          while (fscanf_s(file, "%d/%d/%d", &v, &t, &n) > 0)
-            nt++;
-        }
-        else if (sscanf_s(line, "%d/%d", &v, &t) == 2)
-        {
-          /* v/t */
-          fscanf_s(file, "%d/%d", &v, &t);
-          fscanf_s(file, "%d/%d", &v, &t);
-          nt++;
-          while (fscanf_s(file, "%d/%d", &v, &t) > 0)
-            nt++;
-        }
-        else
-        {
-          /* v */
-          fscanf_s(file, "%d", &v);
-          fscanf_s(file, "%d", &v);
-          nt++;
-          while (fscanf_s(file, "%d", &v) > 0)
-            nt++;
-        }
-        break;
+        chunk.corners.push_back(corners[i]);
+        chunk.cornersWithUV += isPresent[i][UV];
+        chunk.cornersWithNormal += isPresent[i][Normal];
+        for (int a = 0; a < 3; ++a)
+          if (isRelative[i][a])
+            chunk.relative[a].push_back(c);
       }
+    }
+  }
+  if (n < 3)
+    chunk.failed = true;
+}
 
-      default:
-        fgets(line, lineSize, file);
+void
+parseChunk(const char* p, const char* end, OBJChunk& chunk)
+{
+  while (p < end && !chunk.failed)
+  {
+    skipBlanks(p, end);
+    if (p == end)
+      break;
+    if (*p == 'v' && p + 2 < end)
+    {
+      if (isBlank(p[1]))
+        parseVector(p += 2, end, chunk, 3, chunk.positions);
+      else if (p[1] == 'n' && isBlank(p[2]))
+        parseVector(p += 3, end, chunk, 3, chunk.normals);
+      else if (p[1] == 't' && isBlank(p[2]))
+        parseVector(p += 3, end, chunk, 2, chunk.uv);
     }
-  data.numberOfVertices = nv;
-  data.numberOfTriangles = nt;
+    else if (*p == 'f' && p + 1 < end && isBlank(p[1]))
+      parseFace(p += 2, end, chunk);
+    skipLine(p, end);
+  }
 }
 
+template <typename F>
 void
-readMeshData(FILE* file, TriangleMesh::Data& data)
+parallelFor(int n, F f)
 {
-  const unsigned int lineSize{128};
-  auto vertex = data.vertices;
-  auto triangle = data.triangles;
+  std::vector<std::thread> threads;
 
-  for (char line[lineSize]; fscanf_s(file, "%s", line, lineSize) != EOF;)
-    switch (line[0])
+  threads.reserve(n - 1);
+  for (int i = 1; i < n; ++i)
+    threads.emplace_back(f, i);
+  f(0);
+  for (auto& thread : threads)
+    thread.join();
+}
+
+template <typename T>
+inline void
+append(const std::vector<T>& src, T* dst)
+{
+  std::copy(src.begin(), src.end(), dst);
+}
+
+inline size_t
+hashKey(const OBJCorner& c)
+{
+  auto h = uint64_t(uint32_t(c.index[0])) * 0x9E3779B97F4A7C15ull;
+
+  h ^= uint64_t(uint32_t(c.index[1])) * 0xC2B2AE3D27D4EB4Full;
+  h ^= uint64_t(uint32_t(c.index[2])) * 0x165667B19E3779F9ull;
+  return size_t(h ^ (h >> 29));
+}
+
+inline size_t
+hashKey(const vec3f& p)
+{
+  OBJCorner c;
+
+  // Adding zero maps -0 to 0, since both compare equal
+  for (int i = 0; i < 3; ++i)
+  {
+    auto x = p[i] + 0.0f;
+    memcpy(c.index + i, &x, sizeof x);
+  }
+  return hashKey(c);
+}
+
+//
+// Vertex welder: maps each distinct key, e.g., an OBJ (v, vt, vn)
+// tuple or a position, to a vertex through an open-addressing (linear
+// probing) hash table
+//
+template <typename Key>
+class VertexWelder
+{
+public:
+  VertexWelder(int expectedVertices)
+  {
+    int capacity{1024};
+
+    while (capacity < 2 * expectedVertices)
+      capacity <<= 1;
+    _slots.assign(capacity, -1);
+    _vertices.reserve(expectedVertices);
+  }
+
+  const auto& vertices() const
+  {
+    return _vertices;
+  }
+
+  int vertex(const Key& c)
+  {
+    auto mask = _slots.size() - 1;
+
+    for (auto i = hashKey(c) & mask;; i = (i + 1) & mask)
     {
-      case 'v':
+      auto v = _slots[i];
+
+      if (v == -1)
       {
-        float x;
-        float y;
-        float z;
-
-        switch (line[1])
-        {
-          case '\0':
-            fscanf_s(file, "%f %f %f", &x, &y, &z);
-            vertex->set(x, y, z);
-            vertex++;
-            break;
-
-          default:
-            fgets(line, lineSize, file);
-        }
-        break;
+        v = _slots[i] = int(_vertices.size());
+        _vertices.push_back(c);
+        if (_vertices.size() * 2 > _slots.size())
+          grow();
+        return v;
       }
+      if (_vertices[v] == c)
+        return v;
+    }
+  }
+
+private:
+  std::vector<int> _slots;
+  std::vector<Key> _vertices;
+
+  void grow()
+  {
+    _slots.assign(_slots.size() * 2, -1);
+
+    auto mask = _slots.size() - 1;
+
+    for (int v = 0, n = int(_vertices.size()); v < n; ++v)
+    {
+      auto i = hashKey(_vertices[v]) & mask;
+
+      while (_slots[i] != -1)
+        i = (i + 1) & mask;
+      _slots[i] = v;
+    }
+  }
+
+}; // VertexWelder
+
+TriangleMesh*
+parseOBJ(const char* begin, const char* end)
+{
+  // Split the file into line-aligned chunks parsed in parallel
+  constexpr size_t minChunkSize{1 << 20};
+  auto size = size_t(end - begin);
+  auto n = int(std::thread::hardware_concurrency());
+
+  if (n < 1)
+    n = 1;
+  if (size_t(n) > size / minChunkSize)
+    n = int(size / minChunkSize) + 1;
+
+  std::vector<const char*> bounds(n + 1);
+
+  bounds[0] = begin;
+  bounds[n] = end;
+  for (int i = 1; i < n; ++i)
+  {
+    auto p = begin + size / n * i;
+
+    if (p < bounds[i - 1])
+      p = bounds[i - 1];
+    else
+      skipLine(p, end);
+    bounds[i] = p;
+  }
+
+  std::vector<OBJChunk> chunks(n);
+
+  parallelFor(n, [&] (int i)
+  {
+    parseChunk(bounds[i], bounds[i + 1], chunks[i]);
+  });
+
+  // Merge the chunks with prefix-summed attribute and corner offsets
+  int count[3]{};
+  int nc{};
+  int withUV{};
+  int withNormal{};
+
+  for (auto& chunk : chunks)
+  {
+    if (chunk.failed)
+      return nullptr;
+    for (int a = 0; a < 3; ++a)
+    {
+      chunk.offset[a] = count[a];
+      count[a] += chunk.count(a);
+    }
+    chunk.cornerOffset = nc;
+    nc += int(chunk.corners.size());
+    withUV += chunk.cornersWithUV;
+    withNormal += chunk.cornersWithNormal;
+  }
 
-      case 'f':
+  // Attributes not given for every corner are dropped
+  auto hasUV = nc > 0 && withUV == nc;
+  auto hasNormals = nc > 0 && withNormal == nc;
+  std::vector<vec3f> positions(count[Position]);
+  std::vector<vec2f> uv(hasUV ? count[UV] : 0);
+  std::vector<vec3f> normals(hasNormals ? count[Normal] : 0);
+  std::vector<OBJCorner> corners(nc);
+  std::vector<char> valid(n, true);
+  const bool used[]{true, hasUV, hasNormals};
+
+  parallelFor(n, [&] (int i)
+  {
+    auto& chunk = chunks[i];
+    auto c = corners.data() + chunk.cornerOffset;
+
+    append(chunk.positions, positions.data() + chunk.offset[Position]);
+    if (hasUV)
+      append(chunk.uv, uv.data() + chunk.offset[UV]);
+    if (hasNormals)
+      append(chunk.normals, normals.data() + chunk.offset[Normal]);
+    append(chunk.corners, c);
+    for (int a = 0; a < 3; ++a)
+      for (auto k : chunk.relative[a])
+        c[k].index[a] += chunk.offset[a];
+    for (size_t k = 0, e = chunk.corners.size(); k < e; ++k)
+    {
+      auto& corner = c[k];
+
+      // Unused attributes do not split vertices when welding
+      if (!hasUV)
+        corner.index[UV] = -1;
+      if (!hasNormals)
+        corner.index[Normal] = -1;
+      for (int a = 0; a < 3; ++a)
+        if (corner.index[a] >= count[a] ||
+          (corner.index[a] < 0 && used[a]))
+          valid[i] = false;
+    }
+  });
+  for (auto ok : valid)
+    if (!ok)
+      return nullptr;
+
+  TriangleMesh::Data data;
+  auto nt = nc / 3;
+
+  data.numberOfTriangles = nt;
+  data.triangles = new TriangleMesh::Triangle[nt];
+  data.vertexNormals = nullptr;
+  if (!hasUV && !hasNormals)
+  {
+    // Corners and positions are already in one-to-one correspondence
+    data.numberOfVertices = count[Position];
+    data.vertices = new vec3f[data.numberOfVertices];
+    append(positions, data.vertices);
+    for (int i = 0; i < nc; ++i)
+      data.triangles[i / 3].v[i % 3] = corners[i].index[Position];
+    return new TriangleMesh{std::move(data)};
+  }
+
+  VertexWelder<OBJCorner> welder{count[Position]};
+
+  for (int i = 0; i < nc; ++i)
+    data.triangles[i / 3].v[i % 3] = welder.vertex(corners[i]);
+
+  const auto& vertices = welder.vertices();
+  auto nv = int(vertices.size());
+
+  data.numberOfVertices = nv;
+  data.vertices = new vec3f[nv];
+  if (hasNormals)
+    data.vertexNormals = new vec3f[nv];
+  if (hasUV)
+    data.uv = new vec2f[nv];
+  for (int i = 0; i < nv; ++i)
+  {
+    const auto& v = vertices[i];
+
+    data.vertices[i] = positions[v.index[Position]];
+    if (hasNormals)
+      data.vertexNormals[i] = normals[v.index[Normal]];
+    if (hasUV)
+      data.uv[i] = uv[v.index[UV]];
+  }
+  return new TriangleMesh{std::move(data)};
+}
+
+//
+// Binary PLY and STL
+//
+inline bool
+isLittleEndian()
+{
+  const uint16_t one{1};
+  return *(const unsigned char*)&one == 1;
+}
+
+template <typename T>
+inline T
+loadValue(const char* p, bool swap)
+{
+  T value;
+
+  if (!swap)
+    memcpy(&value, p, sizeof value);
+  else
+  {
+    char bytes[sizeof(T)];
+
+    for (size_t i = 0; i < sizeof(T); ++i)
+      bytes[i] = p[sizeof(T) - 1 - i];
+    memcpy(&value, bytes, sizeof value);
+  }
+  return value;
+}
+
+enum PLYType
+{
+  PLYInt8,
+  PLYUInt8,
+  PLYInt16,
+  PLYUInt16,
+  PLYInt32,
+  PLYUInt32,
+  PLYFloat32,
+  PLYFloat64
+};
+
+inline int
+plyTypeSize(int type)
+{
+  static const int sizes[]{1, 1, 2, 2, 4, 4, 4, 8};
+  return sizes[type];
+}
+
+int
+plyType(const std::string& name)
+{
+  static const char* names[][2]
+  {
+    {"char", "int8"},
+    {"uchar", "uint8"},
+    {"short", "int16"},
+    {"ushort", "uint16"},
+    {"int", "int32"},
+    {"uint", "uint32"},
+    {"float", "float32"},
+    {"double", "float64"}
+  };
+
+  for (int i = 0; i < 8; ++i)
+    if (name == names[i][0] || name == names[i][1])
+      return i;
+  return -1;
+}
+
+inline double
+loadPLYValue(int type, const char* p, bool swap)
+{
+  switch (type)
+  {
+    case PLYInt8: return *(const int8_t*)p;
+    case PLYUInt8: return *(const uint8_t*)p;
+    case PLYInt16: return loadValue<int16_t>(p, swap);
+    case PLYUInt16: return loadValue<uint16_t>(p, swap);
+    case PLYInt32: return loadValue<int32_t>(p, swap);
+    case PLYUInt32: return loadValue<uint32_t>(p, swap);
+    case PLYFloat32: return loadValue<float>(p, swap);
+    default: return loadValue<double>(p, swap);
+  }
+}
+
+struct PLYProperty
+{
+  std::string name;
+  int type; // value type, or item type of a list
+  int countType; // count type of a list (-1 if not a list)
+
+}; // PLYProperty
+
+struct PLYElement
+{
+  std::string name;
+  uint64_t count;
+  std::vector<PLYProperty> properties;
+
+  // Returns the size of a record, or 0 if it has lists
+  size_t stride() const
+  {
+    size_t size{};
+
+    for (const auto& property : properties)
+    {
+      if (property.countType >= 0)
+        return 0;
+      size += plyTypeSize(property.type);
+    }
+    return size;
+  }
+
+  int find(const char* name) const
+  {
+    for (int i = 0, n = int(properties.size()); i < n; ++i)
+      if (properties[i].name == name)
+        return i;
+    return -1;
+  }
+
+}; // PLYElement
+
+inline std::string
+nextToken(const char*& p, const char* end)
+{
+  skipBlanks(p, end);
+
+  auto begin = p;
+
+  skipToken(p, end);
+  return {begin, p};
+}
+
+// Parses the header of a binary PLY file. Returns the pointer to the
+// first element record, or null if the header is invalid
+const char*
+parsePLYHeader(const char* p,
+  const char* end,
+  std::vector<PLYElement>& elements,
+  bool& swap)
+{
+  if (nextToken(p, end) != "ply")
+    return nullptr;
+  skipLine(p, end);
+
+  auto binary = false;
+
+  while (p < end)
+  {
+    auto keyword = nextToken(p, end);
+
+    if (keyword == "format")
+    {
+      auto format = nextToken(p, end);
+
+      if (format == "binary_little_endian")
+        swap = !isLittleEndian();
+      else if (format == "binary_big_endian")
+        swap = isLittleEndian();
+      else
+        return nullptr;
+      binary = true;
+    }
+    else if (keyword == "element")
+    {
+      elements.push_back({nextToken(p, end), 0, {}});
+
+      int count;
+
+      // Element counts of meshes readable into a TriangleMesh fit an int
+      skipBlanks(p, end);
+      if (!parseInt(p, end, count) || count < 0)
+        return nullptr;
+      elements.back().count = count;
+    }
+    else if (keyword == "property")
+    {
+      if (elements.empty())
+        return nullptr;
+
+      auto type = nextToken(p, end);
+      PLYProperty property{};
+
+      property.countType = -1;
+      if (type == "list")
       {
-        int v;
-        int n;
-        int t;
-
-        fscanf_s(file, "%s", line, lineSize);
-        /* Can be one of %d, %d//%d, %d/%d, %d/%d/%d %d//%d */
-        if (strstr(line, "//"))
-        {
-          /* v//n */
-          sscanf_s(line, "%d//%d", &v, &n);
-          triangle->v[0] = v - 1;
-          fscanf_s(file, "%d//%d", &v, &n);
-          triangle->v[1] = v - 1;
-          fscanf_s(file, "%d//%d", &v, &n);
-          triangle->v[2] = v - 1;
-          triangle++;
-          while (fscanf_s(file, "%d//%d", &v, &n) > 0)
-          {
-            triangle->v[0] = triangle[-1].v[0];
-            triangle->v[1] = triangle[-1].v[2];
-            triangle->v[2] = v - 1;
-            triangle++;
-          }
-        }
-        else if (sscanf_s(line, "%d/%d/%d", &v, &t, &n) == 3)
-        {
-          /* v/t/n */
-          triangle->v[0] = v - 1;
-          fscanf_s(file, "%d/%d/%d", &v, &t, &n);
-          triangle->v[1] = v - 1;
-          fscanf_s(file, "%d/%d/%d", &v, &t, &n);
-          triangle->v[2] = v - 1;
-          triangle++;
-          while (fscanf_s(file, "%d/%d/%d", &v, &t, &n) > 0)
-          {
-            triangle->v[0] = triangle[-1].v[0];
-            triangle->v[1] = triangle[-1].v[2];
-            triangle->v[2] = v - 1;
-            triangle++;
-          }
-        }
-        else if (sscanf_s(line, "%d/%d", &v, &t) == 2)
-        {
-          /* v/t */
-          triangle->v[0] = v - 1;
-          fscanf_s(file, "%d/%d", &v, &t);
-          triangle->v[1] = v - 1;
-          fscanf_s(file, "%d/%d", &v, &t);
-          triangle->v[2] = v - 1;
-          triangle++;
-          while (fscanf_s(file, "%d/%d", &v, &t) > 0)
+        property.countType = plyType(nextToken(p, end));
+        property.type = plyType(nextToken(p, end));
+        if (property.countType < 0 || property.countType >= PLYFloat32)
+          return nullptr;
+      }
+      else
+        property.type = plyType(type);
+      if (property.type < 0)
+        return nullptr;
+      property.name = nextToken(p, end);
+      elements.back().properties.push_back(property);
+    }
+    else if (keyword == "end_header")
+    {
+      skipLine(p, end);
+      return binary ? p : nullptr;
+    }
+    skipLine(p, end);
+  }
+  return nullptr;
+}
+
+inline bool
+skipPLYProperty(const char*& p,
+  const char* end,
+  const PLYProperty& property,
+  bool swap)
+{
+  size_t size = plyTypeSize(property.type);
+
+  if (property.countType >= 0)
+  {
+    auto countSize = size_t(plyTypeSize(property.countType));
+
+    if (size_t(end - p) < countSize)
+      return false;
+
+    auto n = loadPLYValue(property.countType, p, swap);
+
+    if (n < 0)
+      return false;
+    p += countSize;
+    size *= size_t(n);
+  }
+  if (size_t(end - p) < size)
+    return false;
+  p += size;
+  return true;
+}
+
+// Skips the record of an element with lists
+inline bool
+skipPLYRecord(const char*& p,
+  const char* end,
+  const PLYElement& element,
+  bool swap)
+{
+  for (const auto& property : element.properties)
+    if (!skipPLYProperty(p, end, property, swap))
+      return false;
+  return true;
+}
+
+bool
+parsePLYVertices(const char*& p,
+  const char* end,
+  const PLYElement& element,
+  bool swap,
+  TriangleMesh::Data& data)
+{
+  static const char* names[]{"x", "y", "z", "nx", "ny", "nz"};
+  int index[6];
+  size_t offset[6];
+  auto stride = element.stride();
+  auto nv = int(element.count);
+
+  for (int i = 0; i < 6; ++i)
+    index[i] = element.find(names[i]);
+  if (index[0] < 0 || index[1] < 0 || index[2] < 0)
+    return false;
+
+  auto hasNormals = index[3] >= 0 && index[4] >= 0 && index[5] >= 0;
+
+  data.numberOfVertices = nv;
+  data.vertices = new vec3f[nv];
+  if (hasNormals)
+    data.vertexNormals = new vec3f[nv];
+  if (stride == 0)
+  {
+    // Records with lists: walk them one property at a time
+    for (int v = 0; v < nv; ++v)
+      for (int i = 0, n = int(element.properties.size()); i < n; ++i)
+      {
+        const auto& property = element.properties[i];
+        auto q = p;
+
+        if (!skipPLYProperty(q, end, property, swap))
+          return false;
+        for (int k = 0; k < 6; ++k)
+          if (index[k] == i && property.countType < 0)
           {
-            triangle->v[0] = triangle[-1].v[0];
-            triangle->v[1] = triangle[-1].v[2];
-            triangle->v[2] = v - 1;
-            triangle++;
+            auto value = float(loadPLYValue(property.type, p, swap));
+
+            if (k < 3)
+              data.vertices[v][k] = value;
+            else if (hasNormals)
+              data.vertexNormals[v][k - 3] = value;
           }
-        }
+        p = q;
+      }
+    return true;
+  }
+  if (uint64_t(end - p) / stride < element.count)
+    return false;
+  for (int k = 0; k < 6; ++k)
+  {
+    offset[k] = 0;
+    for (int i = 0; i < index[k]; ++i)
+      offset[k] += plyTypeSize(element.properties[i].type);
+  }
+
+  auto isFloat = [&] (int k)
+  {
+    return index[k] < 0 || element.properties[index[k]].type == PLYFloat32;
+  };
+  auto allFloat = isFloat(0) && isFloat(1) && isFloat(2) &&
+    (!hasNormals || (isFloat(3) && isFloat(4) && isFloat(5)));
+
+  if (allFloat && !swap && stride == sizeof(vec3f) &&
+    offset[0] == 0 && offset[1] == 4 && offset[2] == 8)
+    // Packed positions of the host byte order: one bulk copy
+    memcpy(data.vertices, p, nv * sizeof(vec3f));
+  else
+    for (int v = 0; v < nv; ++v)
+    {
+      auto record = p + v * stride;
+
+      for (int k = 0; k < 6; ++k)
+      {
+        if (k >= 3 && !hasNormals)
+          break;
+
+        auto q = record + offset[k];
+        auto value = allFloat ?
+          loadValue<float>(q, swap) :
+          float(loadPLYValue(element.properties[index[k]].type, q, swap));
+
+        if (k < 3)
+          data.vertices[v][k] = value;
         else
-        {
-          /* v */
-          sscanf_s(line, "%d", &v);
-          triangle->v[0] = v - 1;
-          fscanf_s(file, "%d", &v);
-          triangle->v[1] = v - 1;
-          fscanf_s(file, "%d", &v);
-          triangle->v[2] = v - 1;
-          triangle++;
-          while (fscanf_s(file, "%d", &v) > 0)
-          {
-            triangle->v[0] = triangle[-1].v[0];
-            triangle->v[1] = triangle[-1].v[2];
-            triangle->v[2] = v - 1;
-            triangle++;
-          }
-        }
-        break;
+          data.vertexNormals[v][k - 3] = value;
       }
+    }
+  p += nv * stride;
+  return true;
+}
+
+bool
+parsePLYFaces(const char*& p,
+  const char* end,
+  const PLYElement& element,
+  bool swap,
+  int nv,
+  std::vector<TriangleMesh::Triangle>& triangles)
+{
+  auto list = element.find("vertex_indices");
+
+  if (list < 0)
+    list = element.find("vertex_index");
+  if (list < 0 || element.properties[list].countType < 0)
+    return false;
+
+  const auto& property = element.properties[list];
+  auto countSize = size_t(plyTypeSize(property.countType));
+  auto indexSize = size_t(plyTypeSize(property.type));
+  auto isInt = property.type == PLYInt32 || property.type == PLYUInt32;
+  std::vector<int> face;
+
+  triangles.reserve(element.count);
+  for (uint64_t f = 0; f < element.count; ++f)
+  {
+    auto q = p;
+
+    // Skip the properties before the index list
+    for (int i = 0; i < list; ++i)
+      if (!skipPLYProperty(q, end, element.properties[i], swap))
+        return false;
+    if (size_t(end - q) < countSize)
+      return false;
 
-      default:
-        fgets(line, lineSize, file);
+    auto n = int(loadPLYValue(property.countType, q, swap));
+
+    q += countSize;
+    if (n < 0 || size_t(end - q) / indexSize < size_t(n))
+      return false;
+    face.resize(n);
+    for (int i = 0; i < n; ++i, q += indexSize)
+    {
+      face[i] = isInt ?
+        loadValue<int32_t>(q, swap) :
+        int(loadPLYValue(property.type, q, swap));
+      if (unsigned(face[i]) >= unsigned(nv))
+        return false;
+    }
+    // Polygons are triangulated as fans
+    for (int i = 2; i < n; ++i)
+    {
+      triangles.emplace_back();
+      triangles.back().setVertices(face[0], face[i - 1], face[i]);
+    }
+    p = q;
+    // Skip the properties after the index list
+    for (int i = list + 1, e = int(element.properties.size()); i < e; ++i)
+      if (!skipPLYProperty(p, end, element.properties[i], swap))
+        return false;
+  }
+  return true;
+}
+
+TriangleMesh*
+parsePLY(const char* begin, const char* end)
+{
+  std::vector<PLYElement> elements;
+  auto swap = false;
+  auto p = parsePLYHeader(begin, end, elements, swap);
+
+  if (p == nullptr)
+    return nullptr;
+
+  TriangleMesh::Data data{};
+  std::vector<TriangleMesh::Triangle> triangles;
+  auto hasVertices = false;
+  auto hasFaces = false;
+  auto ok = true;
+
+  for (const auto& element : elements)
+  {
+    if (element.name == "vertex" && !hasVertices)
+      ok = hasVertices = parsePLYVertices(p, end, element, swap, data);
+    else if (element.name == "face" && hasVertices && !hasFaces)
+      ok = hasFaces = parsePLYFaces(p,
+        end,
+        element,
+        swap,
+        data.numberOfVertices,
+        triangles);
+    else if (auto stride = element.stride())
+    {
+      ok = uint64_t(end - p) / stride >= element.count;
+      if (ok)
+        p += element.count * stride;
     }
+    else
+      for (uint64_t i = 0; ok && i < element.count; ++i)
+        ok = skipPLYRecord(p, end, element, swap);
+    if (!ok)
+      break;
+  }
+  if (!ok || !hasFaces)
+  {
+    delete []data.vertices;
+    delete []data.vertexNormals;
+    return nullptr;
+  }
+
+  auto nt = int(triangles.size());
+
+  data.numberOfTriangles = nt;
+  data.triangles = new TriangleMesh::Triangle[nt];
+  std::copy(triangles.begin(), triangles.end(), data.triangles);
+  return new TriangleMesh{std::move(data)};
+}
+
+TriangleMesh*
+parseSTL(const char* begin, const char* end)
+{
+  constexpr size_t headerSize{80 + 4};
+  constexpr size_t recordSize{12 * 4 + 2};
+  auto size = size_t(end - begin);
+
+  if (size < headerSize)
+    return nullptr;
+
+  // Binary STL is always little-endian
+  auto swap = !isLittleEndian();
+  auto nt = loadValue<uint32_t>(begin + 80, swap);
+
+  if (nt > INT32_MAX || (size - headerSize) / recordSize < nt)
+    return nullptr;
+
+  TriangleMesh::Data data;
+  VertexWelder<vec3f> welder{int(nt / 2)};
+
+  data.numberOfTriangles = int(nt);
+  data.triangles = new TriangleMesh::Triangle[nt];
+  for (uint32_t i = 0; i < nt; ++i)
+  {
+    // Skip the facet normal
+    auto p = begin + headerSize + i * recordSize + 12;
+
+    for (int k = 0; k < 3; ++k, p += 12)
+    {
+      vec3f v;
+
+      if (swap)
+        for (int j = 0; j < 3; ++j)
+          v[j] = loadValue<float>(p + 4 * j, true);
+      else
+        memcpy(&v, p, sizeof v);
+      data.triangles[i].v[k] = welder.vertex(v);
+    }
+  }
+
+  const auto& vertices = welder.vertices();
+
+  data.numberOfVertices = int(vertices.size());
+  data.vertices = new vec3f[data.numberOfVertices];
+  data.vertexNormals = nullptr;
+  append(vertices, data.vertices);
+  return new TriangleMesh{std::move(data)};
 }
 
 } // end namespace internal
@@ -236,27 +1110,106 @@ readMeshData(FILE* file, TriangleMesh::Data& data)
 TriangleMesh*
 MeshReader::readOBJ(const char* filename)
 {
-  FILE* file;
+  MappedFile file{filename};
+
+  if (!file.isOpen())
+    return nullptr;
+  printf("Reading Wavefront OBJ file %s...\n", filename);
+
+  auto mesh = internal::parseOBJ(file.begin(), file.end());
+
+  if (mesh == nullptr)
+    printf("Invalid Wavefront OBJ file %s\n", filename);
+  else if (!mesh->hasVertexNormals())
+    mesh->computeNormals();
+  return mesh;
+}
+
+TriangleMesh*
+MeshReader::readPLY(const char* filename)
+{
+  MappedFile file{filename};
 
-  fopen_s(&file, filename, "r");
-  if (file == nullptr)
+  if (!file.isOpen())
     return nullptr;
+  printf("Reading PLY file %s...\n", filename);
 
-  TriangleMesh::Data data;
+  auto mesh = internal::parsePLY(file.begin(), file.end());
 
-  internal::readMeshSize(file, data);
-  data.vertices = new vec3f[data.numberOfVertices];
-  data.vertexNormals = nullptr;
-  data.triangles = new TriangleMesh::Triangle[data.numberOfTriangles];
-  rewind(file);
-  printf("Reading Wavefront OBJ file %s...\n", filename);
-  internal::readMeshData(file, data);
-  fclose(file);
+  if (mesh == nullptr)
+    printf("Invalid or unsupported (not binary) PLY file %s\n", filename);
+  else if (!mesh->hasVertexNormals())
+    mesh->computeNormals();
+  return mesh;
+}
+
+TriangleMesh*
+MeshReader::readSTL(const char* filename)
+{
+  MappedFile file{filename};
+
+  if (!file.isOpen())
+    return nullptr;
+  printf("Reading STL file %s...\n", filename);
 
-  auto mesh = new TriangleMesh{std::move(data)};
+  auto mesh = internal::parseSTL(file.begin(), file.end());
 
-  mesh->computeNormals();
+  if (mesh == nullptr)
+    printf("Invalid or unsupported (not binary) STL file %s\n", filename);
+  else
+    mesh->computeNormals();
   return mesh;
 }
 
+namespace internal
+{ // begin namespace internal
+
+using MeshReaderFunction = TriangleMesh* (*)(const char*);
+
+MeshReaderFunction
+meshReader(const char* filename)
+{
+  static const struct
+  {
+    const char* extension;
+    MeshReaderFunction read;
+  } readers[]
+  {
+    {"obj", MeshReader::readOBJ},
+    {"ply", MeshReader::readPLY},
+    {"stl", MeshReader::readSTL}
+  };
+  auto dot = strrchr(filename, '.');
+
+  if (dot == nullptr || strlen(dot) != 4)
+    return nullptr;
+  for (const auto& reader : readers)
+  {
+    auto e = reader.extension;
+
+    if (tolower(dot[1]) == e[0] &&
+      tolower(dot[2]) == e[1] &&
+      tolower(dot[3]) == e[2])
+      return reader.read;
+  }
+  return nullptr;
+}
+
+} // end namespace internal
+
+bool
+MeshReader::canRead(const char* filename)
+{
+  return internal::meshReader(filename) != nullptr;
+}
+
+TriangleMesh*
+MeshReader::read(const char* filename)
+{
+  if (auto read = internal::meshReader(filename))
+    return read(filename);
+  printf("Unsupported mesh file %s\n", filename);
+  return nullptr;
+}
+
 } // end namespace cg
@@ -0,0 +1,491 @@
+//[]---------------------------------------------------------------[]
+//|                                                                 |
+//| Copyright (C) 2018, 2019 Orthrus Group.                         |
+//|                                                                 |
+//| This software is provided 'as-is', without any express or       |
+//| implied warranty. In no event will the authors be held liable   |
+//| for any damages arising from the use of this software.          |
+//|                                                                 |
+//| Permission is granted to anyone to use this software for any    |
+//| purpose, including commercial applications, and to alter it and |
+//| redistribute it freely, subject to the following restrictions:  |
+//|                                                                 |
+//| 1. The origin of this software must not be misrepresented; you  |
+//| must not claim that you wrote the original software. If you use |
+//| this software in a product, an acknowledgment in the product    |
+//| documentation would be appreciated but is not required.         |
+//|                                                                 |
+//| 2. Altered source versions must be plainly marked as such, and  |
+//| must not be misrepresented as being the original software.      |
+//|                                                                 |
+//| 3. This notice may not be removed or altered from any source    |
+//| distribution.                                                   |
+//|                                                                 |
+//[]---------------------------------------------------------------[]
+// OVERVIEW: MeshSimplifier.cpp
+// ========
+// Source file for mesh simplifier.
+//
+// Author: Paulo Pagliosa
+// Last revision: 19/10/2026
+
+#include "geometry/MeshSimplifier.h"
+#include <algorithm>
+#include <cmath>
+#include <queue>
+#include <unordered_map>
+#include <vector>
+
+namespace cg
+{ // begin namespace cg
+
+namespace internal
+{ // begin namespace internal
+
+//
+// Garland, M. and Heckbert, P. Surface simplification using quadric
+// error metrics, 1997
+//
+class Quadric
+{
+public:
+  Quadric()
+  {
+    std::fill_n(_a, 10, 0.0);
+  }
+
+  // Quadric of the plane n.x + d = 0 weighted by w
+  Quadric(const vec3d& n, double d, double w)
+  {
+    _a[0] = w * n.x * n.x;
+    _a[1] = w * n.x * n.y;
+    _a[2] = w * n.x * n.z;
+    _a[3] = w * n.x * d;
+    _a[4] = w * n.y * n.y;
+    _a[5] = w * n.y * n.z;
+    _a[6] = w * n.y * d;
+    _a[7] = w * n.z * n.z;
+    _a[8] = w * n.z * d;
+    _a[9] = w * d * d;
+  }
+
+  Quadric& operator +=(const Quadric& q)
+  {
+    for (int i = 0; i < 10; ++i)
+      _a[i] += q._a[i];
+    return *this;
+  }
+
+  Quadric operator +(const Quadric& q) const
+  {
+    return Quadric{*this} += q;
+  }
+
+  double error(const vec3d& p) const
+  {
+    const auto& a = _a;
+    auto e = a[0] * p.x * p.x + 2 * a[1] * p.x * p.y + 2 * a[2] * p.x * p.z
+      + 2 * a[3] * p.x + a[4] * p.y * p.y + 2 * a[5] * p.y * p.z
+      + 2 * a[6] * p.y + a[7] * p.z * p.z + 2 * a[8] * p.z + a[9];
+
+    return std::max(e, 0.0);
+  }
+
+  // Solves for the point of minimum error, if the quadric matrix
+  // is not (nearly) singular
+  bool minimum(vec3d& p) const
+  {
+    const auto& a = _a;
+    auto c00 = a[4] * a[7] - a[5] * a[5];
+    auto c01 = a[2] * a[5] - a[1] * a[7];
+    auto c02 = a[1] * a[5] - a[2] * a[4];
+    auto c11 = a[0] * a[7] - a[2] * a[2];
+    auto c12 = a[1] * a[2] - a[0] * a[5];
+    auto c22 = a[0] * a[4] - a[1] * a[1];
+    auto det = a[0] * c00 + a[1] * c01 + a[2] * c02;
+    auto trace = a[0] + a[4] + a[7];
+
+    if (std::abs(det) <= 1e-6 * trace * trace * trace)
+      return false;
+    p.x = c00 * a[3] + c01 * a[6] + c02 * a[8];
+    p.y = c01 * a[3] + c11 * a[6] + c12 * a[8];
+    p.z = c02 * a[3] + c12 * a[6] + c22 * a[8];
+    p *= -1 / det;
+    return true;
+  }
+
+private:
+  // Upper triangle of the symmetric 4x4 matrix
+  double _a[10];
+
+}; // Quadric
+
+class Simplifier
+{
+public:
+  Simplifier(const TriangleMesh::Data& data);
+
+  void run(int targetTriangles);
+
+  TriangleMesh* mesh() const;
+
+private:
+  struct Vertex
+  {
+    vec3d p;
+    Quadric q;
+    std::vector<int> triangles;
+    int version{};
+    bool removed{};
+
+  }; // Vertex
+
+  struct Triangle
+  {
+    int v[3];
+    bool removed{};
+
+    bool has(int i) const
+    {
+      return v[0] == i || v[1] == i || v[2] == i;
+    }
+
+  }; // Triangle
+
+  struct Collapse
+  {
+    double cost;
+    vec3d p;
+    int v[2];
+    int version[2];
+
+    // Inverted for a min-heap
+    bool operator <(const Collapse& other) const
+    {
+      return cost > other.cost;
+    }
+
+  }; // Collapse
+
+  const TriangleMesh::Data& _data;
+  std::vector<Vertex> _vertices;
+  std::vector<Triangle> _triangles;
+  std::priority_queue<Collapse> _heap;
+  std::vector<int> _ring[2];
+  int _triangleCount;
+
+  void push(int v0, int v1);
+  bool isValid(const Collapse& c);
+  bool flips(int v, int other, const vec3d& p) const;
+  void collapse(const Collapse& c);
+  void ring(int v, std::vector<int>& ring) const;
+
+}; // Simplifier
+
+inline auto
+edgeKey(int v0, int v1)
+{
+  if (v0 > v1)
+    std::swap(v0, v1);
+  return uint64_t(v0) << 32 | uint32_t(v1);
+}
+
+Simplifier::Simplifier(const TriangleMesh::Data& data):
+  _data{data},
+  _vertices(data.numberOfVertices),
+  _triangles(data.numberOfTriangles),
+  _triangleCount{data.numberOfTriangles}
+{
+  // Weight of the quadrics that preserve boundary edges
+  constexpr auto boundaryWeight = 1000.0;
+
+  for (int i = 0; i < data.numberOfVertices; ++i)
+    _vertices[i].p = vec3d{data.vertices[i]};
+
+  std::unordered_map<uint64_t, int> edges;
+
+  edges.reserve(size_t(data.numberOfTriangles) * 3 / 2);
+  for (int i = 0; i < data.numberOfTriangles; ++i)
+  {
+    auto& t = _triangles[i];
+
+    std::copy_n(data.triangles[i].v, 3, t.v);
+
+    const auto& p0 = _vertices[t.v[0]].p;
+    auto n = (_vertices[t.v[1]].p - p0).cross(_vertices[t.v[2]].p - p0);
+    auto area = n.length() * 0.5;
+
+    if (area > 0)
+    {
+      n *= 0.5 / area;
+
+      Quadric q{n, -n.dot(p0), area};
+
+      for (int k = 0; k < 3; ++k)
+        _vertices[t.v[k]].q += q;
+    }
+    for (int k = 0; k < 3; ++k)
+    {
+      _vertices[t.v[k]].triangles.push_back(i);
+      ++edges[edgeKey(t.v[k], t.v[(k + 1) % 3])];
+    }
+  }
+  for (int i = 0; i < data.numberOfTriangles; ++i)
+  {
+    const auto& t = _triangles[i];
+    const auto& p0 = _vertices[t.v[0]].p;
+    auto n = (_vertices[t.v[1]].p - p0).cross(_vertices[t.v[2]].p - p0);
+
+    if (n.isNull())
+      continue;
+    n = n.versor();
+    for (int k = 0; k < 3; ++k)
+    {
+      auto v0 = t.v[k], v1 = t.v[(k + 1) % 3];
+
+      if (edges[edgeKey(v0, v1)] != 1)
+        continue;
+
+      // Plane through the boundary edge orthogonal to the triangle
+      auto e = _vertices[v1].p - _vertices[v0].p;
+      auto m = e.cross(n).versor();
+      Quadric q{m, -m.dot(_vertices[v0].p), boundaryWeight * e.squaredNorm()};
+
+      _vertices[v0].q += q;
+      _vertices[v1].q += q;
+    }
+  }
+  for (const auto& edge : edges)
+    push(int(edge.first >> 32), int(edge.first & 0xffffffff));
+}
+
+void
+Simplifier::push(int v0, int v1)
+{
+  const auto& a = _vertices[v0];
+  const auto& b = _vertices[v1];
+  auto q = a.q + b.q;
+  Collapse c;
+
+  if (q.minimum(c.p))
+    c.cost = q.error(c.p);
+  else
+  {
+    // Singular quadric: the best of the endpoints and the midpoint
+    vec3d candidates[]{a.p, b.p, (a.p + b.p) * 0.5};
+
+    c.cost = math::Limits<double>::inf();
+    for (const auto& p : candidates)
+      if (auto e = q.error(p); e < c.cost)
+      {
+        c.cost = e;
+        c.p = p;
+      }
+  }
+  c.v[0] = v0;
+  c.v[1] = v1;
+  c.version[0] = a.version;
+  c.version[1] = b.version;
+  _heap.push(c);
+}
+
+void
+Simplifier::ring(int v, std::vector<int>& ring) const
+{
+  ring.clear();
+  for (auto i : _vertices[v].triangles)
+    for (auto w : _triangles[i].v)
+      if (w != v)
+        ring.push_back(w);
+  std::sort(ring.begin(), ring.end());
+  ring.erase(std::unique(ring.begin(), ring.end()), ring.end());
+}
+
+bool
+Simplifier::flips(int v, int other, const vec3d& p) const
+{
+  // Minimum cosine between a triangle normal before and after a collapse
+  constexpr auto minCos = 0.2;
+
+  for (auto i : _vertices[v].triangles)
+  {
+    const auto& t = _triangles[i];
+
+    if (t.has(other))
+      continue;
+
+    vec3d q[3];
+
+    for (int k = 0; k < 3; ++k)
+      q[k] = _vertices[t.v[k]].p;
+
+    auto n0 = (q[1] - q[0]).cross(q[2] - q[0]);
+
+    for (int k = 0; k < 3; ++k)
+      if (t.v[k] == v)
+        q[k] = p;
+
+    auto n1 = (q[1] - q[0]).cross(q[2] - q[0]);
+    auto l = n0.length() * n1.length();
+
+    if (l == 0 || n0.dot(n1) < minCos * l)
+      return true;
+  }
+  return false;
+}
+
+bool
+Simplifier::isValid(const Collapse& c)
+{
+  const auto& a = _vertices[c.v[0]];
+  const auto& b = _vertices[c.v[1]];
+
+  if (a.removed || b.removed)
+    return false;
+  if (a.version != c.version[0] || b.version != c.version[1])
+    return false;
+
+  // Link condition: the edge vertices may share only the opposite
+  // vertices of the triangles of the edge
+  int shared = 0;
+
+  for (auto i : a.triangles)
+    shared += _triangles[i].has(c.v[1]);
+  ring(c.v[0], _ring[0]);
+  ring(c.v[1], _ring[1]);
+
+  int common = 0;
+
+  for (auto i = _ring[0].begin(), j = _ring[1].begin();
+    i != _ring[0].end() && j != _ring[1].end();)
+    if (*i < *j)
+      ++i;
+    else if (*j < *i)
+      ++j;
+    else
+    {
+      ++common;
+      ++i;
+      ++j;
+    }
+  if (common != shared)
+    return false;
+  return !flips(c.v[0], c.v[1], c.p) && !flips(c.v[1], c.v[0], c.p);
+}
+
+void
+Simplifier::collapse(const Collapse& c)
+{
+  auto v0 = c.v[0], v1 = c.v[1];
+  auto& a = _vertices[v0];
+  auto& b = _vertices[v1];
+
+  a.p = c.p;
+  a.q += b.q;
+  ++a.version;
+  for (auto i : b.triangles)
+  {
+    auto& t = _triangles[i];
+
+    if (t.has(v0))
+    {
+      t.removed = true;
+      --_triangleCount;
+      for (auto w : t.v)
+        if (w != v0 && w != v1)
+        {
+          auto& triangles = _vertices[w].triangles;
+          triangles.erase(std::find(triangles.begin(), triangles.end(), i));
+        }
+    }
+    else
+    {
+      for (auto& w : t.v)
+        if (w == v1)
+          w = v0;
+      a.triangles.push_back(i);
+    }
+  }
+  a.triangles.erase(std::remove_if(a.triangles.begin(),
+    a.triangles.end(),
+    [this](int i) { return _triangles[i].removed; }),
+    a.triangles.end());
+  b.removed = true;
+  b.triangles.clear();
+  b.triangles.shrink_to_fit();
+  ring(v0, _ring[0]);
+  for (auto w : _ring[0])
+    push(v0, w);
+}
+
+void
+Simplifier::run(int targetTriangles)
+{
+  while (_triangleCount > targetTriangles && !_heap.empty())
+  {
+    auto c = _heap.top();
+
+    _heap.pop();
+    if (isValid(c))
+      collapse(c);
+  }
+}
+
+TriangleMesh*
+Simplifier::mesh() const
+{
+  std::vector<int> map(_vertices.size(), -1);
+  int nv = 0;
+
+  for (const auto& t : _triangles)
+    if (!t.removed)
+      for (auto v : t.v)
+        if (map[v] < 0)
+          map[v] = nv++;
+
+  TriangleMesh::Data data;
+
+  data.numberOfVertices = nv;
+  data.numberOfTriangles = _triangleCount;
+  data.vertices = new vec3f[nv];
+  data.vertexNormals = nullptr;
+  data.uv = _data.uv != nullptr ? new vec2f[nv] : nullptr;
+  data.triangles = new TriangleMesh::Triangle[_triangleCount];
+  for (int i = 0, n = int(_vertices.size()); i < n; ++i)
+    if (auto j = map[i]; j >= 0)
+    {
+      // The uv of a collapsed edge are those of its kept vertex
+      data.vertices[j] = vec3f{_vertices[i].p};
+      if (data.uv != nullptr)
+        data.uv[j] = _data.uv[i];
+    }
+
+  auto triangle = data.triangles;
+
+  for (const auto& t : _triangles)
+    if (!t.removed)
+      (triangle++)->setVertices(map[t.v[0]], map[t.v[1]], map[t.v[2]]);
+
+  auto mesh = new TriangleMesh{std::move(data)};
+
+  mesh->computeNormals();
+  return mesh;
+}
+
+} // end namespace internal
+
+
+/////////////////////////////////////////////////////////////////////
+//
+// MeshSimplifier implementation
+// ==============
+TriangleMesh*
+MeshSimplifier::simplify(const TriangleMesh& mesh, int targetTriangles)
+{
+  internal::Simplifier simplifier{mesh.data()};
+
+  simplifier.run(targetTriangles);
+  return simplifier.mesh();
+}
+
+} // end namespace cg
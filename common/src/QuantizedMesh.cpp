@@ -0,0 +1,158 @@
+//[]---------------------------------------------------------------[]
+//|                                                                 |
+//| Copyright (C) 2018, 2019 Orthrus Group.                         |
+//|                                                                 |
+//| This software is provided 'as-is', without any express or       |
+//| implied warranty. In no event will the authors be held liable   |
+//| for any damages arising from the use of this software.          |
+//|                                                                 |
+//| Permission is granted to anyone to use this software for any    |
+//| purpose, including commercial applications, and to alter it and |
+//| redistribute it freely, subject to the following restrictions:  |
+//|                                                                 |
+//| 1. The origin of this software must not be misrepresented; you  |
+//| must not claim that you wrote the original software. If you use |
+//| this software in a product, an acknowledgment in the product    |
+//| documentation would be appreciated but is not required.         |
+//|                                                                 |
+//| 2. Altered source versions must be plainly marked as such, and  |
+//| must not be misrepresented as being the original software.      |
+//|                                                                 |
+//| 3. This notice may not be removed or altered from any source    |
+//| distribution.                                                   |
+//|                                                                 |
+//[]---------------------------------------------------------------[]
+//
+// OVERVIEW: QuantizedMesh.cpp
+// ========
+// Source file for quantized mesh.
+//
+// Author: Paulo Pagliosa
+// Last revision: 19/10/2026
+
+#include "geometry/QuantizedMesh.h"
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+namespace cg
+{ // begin namespace cg
+
+namespace internal
+{ // begin namespace internal
+
+// Quantizes x in [0, 1] to an unsigned integer of the given range
+inline uint32_t
+quantize(float x, float range)
+{
+  x = x < 0 ? 0 : x > 1 ? 1 : x;
+  return uint32_t(x * range + 0.5f);
+}
+
+inline float
+signNotZero(float x)
+{
+  return x >= 0 ? 1.0f : -1.0f;
+}
+
+} // end namespace internal
+
+
+/////////////////////////////////////////////////////////////////////
+//
+// QuantizedMesh implementation
+// =============
+vec2f
+QuantizedMesh::encodeOctahedral(const vec3f& n)
+{
+  using namespace internal;
+
+  auto s = std::abs(n.x) + std::abs(n.y) + std::abs(n.z);
+
+  if (s == 0)
+    return {0, 0};
+
+  vec2f e{n.x / s, n.y / s};
+
+  // Fold the lower hemisphere over the diagonals
+  if (n.z < 0)
+    e.set((1 - std::abs(e.y)) * signNotZero(e.x),
+      (1 - std::abs(e.x)) * signNotZero(e.y));
+  return e;
+}
+
+QuantizedMesh::QuantizedMesh(const TriangleMesh& mesh,
+  NormalFormat normalFormat):
+  _numberOfVertices{mesh.data().numberOfVertices},
+  _normalFormat{normalFormat}
+{
+  using namespace internal;
+
+  const auto& data = mesh.data();
+  const auto& bounds = mesh.bounds();
+  auto nv = _numberOfVertices;
+  auto stride = this->stride();
+
+  _positionOffset = bounds.min();
+  _positionScale = nv > 0 ? bounds.size() : vec3f{1, 1, 1};
+  _vertices.resize(size_t(nv) * stride);
+  for (int i = 0; i < nv; ++i)
+  {
+    auto v = _vertices.data() + size_t(i) * stride;
+    uint16_t p[3];
+
+    for (int k = 0; k < 3; ++k)
+    {
+      auto s = _positionScale[k];
+      auto x = s > 0 ? (data.vertices[i][k] - _positionOffset[k]) / s : 0;
+
+      p[k] = uint16_t(quantize(x, 65535));
+    }
+    memcpy(v, p, sizeof p);
+
+    // Octahedral coordinates are stored as unsigned normalized values,
+    // whose conversion to float is exact in any GL version
+    vec2f e{0, 0};
+
+    if (data.vertexNormals != nullptr)
+      e = encodeOctahedral(data.vertexNormals[i]);
+    if (normalFormat == NormalFormat::Octahedral16)
+    {
+      uint16_t n[2];
+
+      n[0] = uint16_t(quantize(e.x * 0.5f + 0.5f, 65535));
+      n[1] = uint16_t(quantize(e.y * 0.5f + 0.5f, 65535));
+      memcpy(v + normalOffset(), n, sizeof n);
+    }
+    else
+    {
+      v[normalOffset()] = uint8_t(quantize(e.x * 0.5f + 0.5f, 255));
+      v[normalOffset() + 1] = uint8_t(quantize(e.y * 0.5f + 0.5f, 255));
+    }
+  }
+  if (data.uv == nullptr || nv == 0)
+    return;
+
+  vec2f uvMin{data.uv[0]};
+  vec2f uvMax{data.uv[0]};
+
+  for (int i = 1; i < nv; ++i)
+    for (int k = 0; k < 2; ++k)
+    {
+      uvMin[k] = std::min(uvMin[k], data.uv[i][k]);
+      uvMax[k] = std::max(uvMax[k], data.uv[i][k]);
+    }
+  _uvOffset = uvMin;
+  _uvScale = uvMax - uvMin;
+  _uv.resize(2 * size_t(nv));
+  for (int i = 0; i < nv; ++i)
+    for (int k = 0; k < 2; ++k)
+    {
+      auto s = _uvScale[k];
+      auto x = s > 0 ? (data.uv[i][k] - _uvOffset[k]) / s : 0;
+
+      _uv[2 * i + k] = uint16_t(quantize(x, 65535));
+    }
+}
+
+} // end namespace cg
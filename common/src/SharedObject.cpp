@@ -0,0 +1,96 @@
+//[]---------------------------------------------------------------[]
+//|                                                                 |
+//| Copyright (C) 2018 Orthrus Group.                               |
+//|                                                                 |
+//| This software is provided 'as-is', without any express or       |
+//| implied warranty. In no event will the authors be held liable   |
+//| for any damages arising from the use of this software.          |
+//|                                                                 |
+//| Permission is granted to anyone to use this software for any    |
+//| purpose, including commercial applications, and to alter it and |
+//| redistribute it freely, subject to the following restrictions:  |
+//|                                                                 |
+//| 1. The origin of this software must not be misrepresented; you  |
+//| must not claim that you wrote the original software. If you use |
+//| this software in a product, an acknowledgment in the product    |
+//| documentation would be appreciated but is not required.         |
+//|                                                                 |
+//| 2. Altered source versions must be plainly marked as such, and  |
+//| must not be misrepresented as being the original software.      |
+//|                                                                 |
+//| 3. This notice may not be removed or altered from any source    |
+//| distribution.                                                   |
+//|                                                                 |
+//[]---------------------------------------------------------------[]
+//
+// OVERVIEW: SharedObject.cpp
+// ========
+// Source file for shared object.
+//
+// Author: Paulo Pagliosa
+// Last revision: 19/10/2026
+
+#include "core/SharedObject.h"
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace cg
+{ // begin namespace cg
+
+namespace
+{ // begin namespace
+
+std::mutex deferredLock;
+std::vector<SharedObject*> deferred;
+std::thread::id ownerThread;
+
+} // end namespace
+
+
+/////////////////////////////////////////////////////////////////////
+//
+// SharedObject implementation
+// ============
+void
+SharedObject::setOwnerThread()
+{
+  std::lock_guard<std::mutex> lock{deferredLock};
+  ownerThread = std::this_thread::get_id();
+}
+
+void
+SharedObject::destroy(SharedObject* object)
+{
+  {
+    std::lock_guard<std::mutex> lock{deferredLock};
+
+    // Objects released before an owner thread is set, or released by
+    // the owner thread itself, are deleted immediately
+    if (ownerThread != std::thread::id{} &&
+      ownerThread != std::this_thread::get_id())
+    {
+      deferred.push_back(object);
+      return;
+    }
+  }
+  delete object;
+}
+
+void
+SharedObject::collectDeferred()
+{
+  std::vector<SharedObject*> objects;
+
+  {
+    std::lock_guard<std::mutex> lock{deferredLock};
+    if (deferred.empty())
+      return;
+    objects.swap(deferred);
+  }
+  // Deleting an object can release other objects
+  for (auto object : objects)
+    delete object;
+}
+
+} // end namespace cg
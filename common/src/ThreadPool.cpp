@@ -0,0 +1,94 @@
+//[]---------------------------------------------------------------[]
+//|                                                                 |
+//| Copyright (C) 2019 Orthrus Group.                               |
+//|                                                                 |
+//| This software is provided 'as-is', without any express or       |
+//| implied warranty. In no event will the authors be held liable   |
+//| for any damages arising from the use of this software.          |
+//|                                                                 |
+//| Permission is granted to anyone to use this software for any    |
+//| purpose, including commercial applications, and to alter it and |
+//| redistribute it freely, subject to the following restrictions:  |
+//|                                                                 |
+//| 1. The origin of this software must not be misrepresented; you  |
+//| must not claim that you wrote the original software. If you use |
+//| this software in a product, an acknowledgment in the product    |
+//| documentation would be appreciated but is not required.         |
+//|                                                                 |
+//| 2. Altered source versions must be plainly marked as such, and  |
+//| must not be misrepresented as being the original software.      |
+//|                                                                 |
+//| 3. This notice may not be removed or altered from any source    |
+//| distribution.                                                   |
+//|                                                                 |
+//[]---------------------------------------------------------------[]
+// OVERVIEW: ThreadPool.cpp
+// ========
+// Source file for thread pool.
+//
+// Author: Paulo Pagliosa
+// Last revision: 19/10/2026
+
+#include "core/ThreadPool.h"
+#include <algorithm>
+
+namespace cg
+{ // begin namespace cg
+
+
+/////////////////////////////////////////////////////////////////////
+//
+// ThreadPool implementation
+// ==========
+ThreadPool::ThreadPool(int threads)
+{
+  if (threads <= 0)
+    threads = std::max(int(std::thread::hardware_concurrency()), 1);
+  _workers.reserve(threads);
+  for (int i = 0; i < threads; ++i)
+    _workers.emplace_back(&ThreadPool::run, this);
+}
+
+ThreadPool::~ThreadPool()
+{
+  {
+    std::lock_guard<std::mutex> lock{_lock};
+    _stopping = true;
+  }
+  _ready.notify_all();
+  for (auto& worker : _workers)
+    worker.join();
+}
+
+void
+ThreadPool::enqueue(std::function<void()>&& task)
+{
+  {
+    std::lock_guard<std::mutex> lock{_lock};
+    _tasks.push(std::move(task));
+  }
+  _ready.notify_one();
+}
+
+void
+ThreadPool::run()
+{
+  for (;;)
+  {
+    std::function<void()> task;
+
+    {
+      std::unique_lock<std::mutex> lock{_lock};
+
+      _ready.wait(lock, [this]() { return _stopping || !_tasks.empty(); });
+      // Pending tasks are run before stopping
+      if (_tasks.empty())
+        return;
+      task = std::move(_tasks.front());
+      _tasks.pop();
+    }
+    task();
+  }
+}
+
+} // end namespace cg
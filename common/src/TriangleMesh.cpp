@@ -28,10 +28,13 @@
 // Source file for simple triangle mesh.
 //
 // Author: Paulo Pagliosa
-// Last revision: 02/06/2019
+// Last revision: 19/10/2026
 
 #include "geometry/MeshSweeper.h"
+#include <algorithm>
+#include <atomic>
 #include <memory>
+#include <vector>
 
 namespace cg
 { // begin namespace cg
@@ -41,31 +44,72 @@ namespace cg
 //
 // TriangleMesh implementation
 // ============
-static uint32_t nextMeshId;
+// Meshes may be created concurrently, e.g., by streaming meshes
+static std::atomic<uint32_t> nextMeshId;
 
 TriangleMesh::TriangleMesh(Data&& data):
   id{++nextMeshId},
   _data{data}
 {
   memset(&data, 0, sizeof(Data));
+  updateBounds();
+}
+
+TriangleMesh::TriangleMesh(const Data& data,
+  SharedObject* storage,
+  const Bounds3f& bounds):
+  id{++nextMeshId},
+  _data{data},
+  _bounds{bounds},
+  _storage{storage}
+{
+  // do nothing
 }
 
 TriangleMesh::~TriangleMesh()
 {
+  if (isView())
+    return;
   delete []_data.vertices;
   delete []_data.vertexNormals;
   delete []_data.uv;
   delete []_data.triangles;
 }
 
-Bounds3f
-TriangleMesh::bounds() const
+void
+TriangleMesh::updateBounds()
 {
-  Bounds3f bounds;
-
+  _bounds = Bounds3f{};
   for (int i = 0; i < _data.numberOfVertices; i++)
-    bounds.inflate(_data.vertices[i]);
-  return bounds;
+    _bounds.inflate(_data.vertices[i]);
+}
+
+template <typename T>
+inline T*
+copyArray(const T* a, int n)
+{
+  if (a == nullptr)
+    return nullptr;
+
+  auto c = new T[n];
+
+  std::copy(a, a + n, c);
+  return c;
+}
+
+void
+TriangleMesh::makeOwner()
+{
+  if (!isView())
+    return;
+
+  auto nv = _data.numberOfVertices;
+
+  _data.vertices = copyArray(_data.vertices, nv);
+  _data.vertexNormals = copyArray(_data.vertexNormals, nv);
+  _data.uv = copyArray(_data.uv, nv);
+  _data.triangles = copyArray(_data.triangles, _data.numberOfTriangles);
+  _storage = nullptr;
 }
 
 void
@@ -74,7 +118,11 @@ TriangleMesh::computeNormals()
   auto nv = _data.numberOfVertices;
 
   if (_data.vertexNormals == nullptr)
+  {
+    // A view cannot mix owned and viewed arrays
+    makeOwner();
     _data.vertexNormals = new vec3f[nv];
+  }
 
   auto t = _data.triangles;
 
@@ -94,6 +142,44 @@ TriangleMesh::computeNormals()
     _data.vertexNormals[i].normalize();
 }
 
+template <typename T>
+inline void
+scatterArray(T* a, const int* map, int n)
+{
+  if (a == nullptr)
+    return;
+
+  std::vector<T> c(a, a + n);
+
+  for (int i = 0; i < n; ++i)
+    a[map[i]] = c[i];
+}
+
+void
+TriangleMesh::reorder(const int* triangleOrder, const int* vertexMap)
+{
+  auto nt = _data.numberOfTriangles;
+
+  if (triangleOrder != nullptr)
+  {
+    std::vector<Triangle> c(_data.triangles, _data.triangles + nt);
+
+    for (int i = 0; i < nt; ++i)
+      _data.triangles[i] = c[triangleOrder[i]];
+  }
+  if (vertexMap == nullptr)
+    return;
+
+  auto nv = _data.numberOfVertices;
+
+  scatterArray(_data.vertices, vertexMap, nv);
+  scatterArray(_data.vertexNormals, vertexMap, nv);
+  scatterArray(_data.uv, vertexMap, nv);
+  for (int i = 0; i < nt; ++i)
+    for (auto& v : _data.triangles[i].v)
+      v = vertexMap[v];
+}
+
 void
 TriangleMesh::TRS(const mat4f& trs)
 {
@@ -101,6 +187,7 @@ TriangleMesh::TRS(const mat4f& trs)
 
   for (int i = 0; i < nv; ++i)
     _data.vertices[i] = trs.transform3x4(_data.vertices[i]);
+  updateBounds();
   if (_data.vertexNormals == nullptr)
     return;
 
@@ -110,6 +197,19 @@ TriangleMesh::TRS(const mat4f& trs)
     _data.vertexNormals[i] = (r * _data.vertexNormals[i]).versor();
 }
 
+size_t
+TriangleMesh::memorySize() const
+{
+  size_t nv = _data.numberOfVertices;
+  auto s = nv * sizeof(vec3f) + _data.numberOfTriangles * sizeof(Triangle);
+
+  if (_data.vertexNormals != nullptr)
+    s += nv * sizeof(vec3f);
+  if (_data.uv != nullptr)
+    s += nv * sizeof(vec2f);
+  return s;
+}
+
 static inline void
 printv(const vec3f& p, FILE* f)
 {
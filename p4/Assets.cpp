@@ -28,10 +28,16 @@
 // Source file for assets.
 //
 // Author(s): Paulo Pagliosa (and your name)
-// Last revision: 01/10/2019
+// Last revision: 19/10/2026
 
 #include "Assets.h"
+#include "BVH.h"
+#include "MeshLOD.h"
+#include "geometry/MeshOptimizer.h"
+#include "geometry/MeshSweeper.h"
 #include "graphics/Application.h"
+#include "utils/MeshFile.h"
+#include <algorithm>
 #include <filesystem>
 
 namespace cg
@@ -44,7 +50,14 @@ namespace fs = std::filesystem;
 //
 // Assets implementation
 // ======
+Assets::Memory Assets::budget{1024u << 20, 512u << 20, 512u << 20};
 MeshMap Assets::_meshes;
+std::map<std::string, Assets::MeshLoad> Assets::_loads;
+std::map<TriangleMesh*, Assets::LODBuild> Assets::_lodBuilds;
+std::map<std::string, uint64_t> Assets::_lastUse;
+uint64_t Assets::_frame;
+Assets::Memory Assets::_memoryUsed;
+StreamingMeshMap Assets::_streamingMeshes;
 
 void
 Assets::initialize()
@@ -57,24 +70,289 @@ Assets::initialize()
 
     for (auto e = fs::directory_iterator(); p != e; ++p)
       if (fs::is_regular_file(p->status()))
-        _meshes[p->path().filename().string()] = nullptr;
+      {
+        auto name = p->path().filename().string();
+
+        if (p->path().extension() == ".cgsm")
+          _streamingMeshes[name] = nullptr;
+        else if (MeshReader::canRead(name.c_str()))
+          _meshes[name] = nullptr;
+      }
   }
 }
 
+//
+// Meshes are cached, together with their BVHs, as binary mesh files
+// in meshes/cache. A cache file is used only if it is newer than the
+// mesh file it was converted from.
+//
+static TriangleMesh*
+readCachedMesh(const fs::path& meshPath, const fs::path& cachePath)
+{
+  std::error_code e;
+  auto meshTime = fs::last_write_time(meshPath, e);
+
+  if (e)
+    return nullptr;
+
+  auto cacheTime = fs::last_write_time(cachePath, e);
+
+  if (e || cacheTime < meshTime)
+    return nullptr;
+
+  MeshFile::Section bvh;
+  auto m = MeshFile::read(cachePath.string().c_str(), &bvh);
+
+  if (m != nullptr)
+    BVHCache::set(m, new BVH{*m, bvh.data, bvh.size});
+  return m;
+}
+
+static void
+optimizeMesh(TriangleMesh* m)
+{
+  auto acmr = MeshOptimizer::acmr(*m);
+
+  MeshOptimizer::optimize(*m);
+  printf("Mesh ACMR: %.3f (before optimization: %.3f)\n",
+    MeshOptimizer::acmr(*m),
+    acmr);
+}
+
+static void
+writeCachedMesh(TriangleMesh* m, const fs::path& cachePath)
+{
+  std::vector<char> bvh;
+  std::error_code e;
+
+  BVHCache::get(m)->serialize(bvh);
+  fs::create_directories(cachePath.parent_path(), e);
+  if (e || !MeshFile::write(cachePath.string().c_str(),
+    *m,
+    bvh.data(),
+    bvh.size()))
+    printf("Unable to write mesh cache file %s\n", cachePath.string().c_str());
+}
+
+//
+// Runs on a loader thread. Everything but the GL upload is done here.
+//
+static MeshRef
+readMesh(const std::string& name)
+{
+  auto filename = "meshes/" + name;
+  fs::path meshPath{Application::assetFilePath(filename.c_str())};
+  auto cachePath = meshPath.parent_path() / "cache" / (name + ".cgm");
+  MeshRef m = readCachedMesh(meshPath, cachePath);
+
+  if (m == nullptr)
+    if ((m = Application::loadMesh(filename.c_str())) != nullptr)
+    {
+      // Cached meshes are stored optimized
+      optimizeMesh(m);
+      writeCachedMesh(m, cachePath);
+    }
+  if (m != nullptr && MeshLOD::settings.levels > 1)
+    LODCache::get(m);
+  return m;
+}
+
+static ThreadPool&
+loader()
+{
+  // Leave a hardware thread to the render thread
+  static ThreadPool pool{int(std::thread::hardware_concurrency()) - 1};
+  return pool;
+}
+
 TriangleMesh*
 Assets::loadMesh(MeshMapIterator mit)
 {
   if (mit == _meshes.end())
     return nullptr;
+  if (mit->second != nullptr)
+    return mit->second;
+
+  auto& load = _loads[mit->first];
+
+  if (load.placeholder == nullptr)
+  {
+    load.placeholder = MeshSweeper::makeBox();
+    load.mesh = loader().submit([name = mit->first]() { return readMesh(name); });
+  }
+  return load.placeholder;
+}
+
+void
+Assets::buildLOD(TriangleMesh* mesh)
+{
+  auto& build = _lodBuilds[mesh];
+
+  if (build.mesh == nullptr)
+  {
+    build.mesh = mesh;
+    build.done = loader().submit([mesh]() { LODCache::get(mesh); });
+  }
+}
+
+void
+Assets::update(const MeshLoaded& loaded)
+{
+  using namespace std::chrono_literals;
+
+  for (auto lit = _loads.begin(); lit != _loads.end();)
+  {
+    auto& load = lit->second;
+
+    if (load.mesh.wait_for(0s) != std::future_status::ready)
+    {
+      ++lit;
+      continue;
+    }
+
+    auto m = load.mesh.get();
+
+    // If the mesh cannot be read, its placeholder is kept
+    if (m == nullptr)
+      printf("Unable to load mesh %s\n", lit->first.c_str());
+    else
+    {
+      _meshes[lit->first] = m;
+      loaded(load.placeholder, m);
+      // The placeholder may have been traced or drawn by the renderer
+      BVHCache::remove(load.placeholder);
+      LODCache::remove(load.placeholder);
+    }
+    lit = _loads.erase(lit);
+  }
+  for (auto bit = _lodBuilds.begin(); bit != _lodBuilds.end();)
+  {
+    auto& build = bit->second;
+
+    if (build.done.wait_for(0s) != std::future_status::ready)
+    {
+      ++bit;
+      continue;
+    }
+    // The chain of a mesh released while it was built (e.g., a
+    // placeholder) is referenced only by the build and the chain
+    if (build.mesh->referenceCount() <= 2)
+      LODCache::remove(build.mesh);
+    bit = _lodBuilds.erase(bit);
+  }
+  evict();
+}
+
+static size_t
+glBufferSize(TriangleMesh* m)
+{
+  auto glm = asGLMesh(m->userData);
+  return glm != nullptr ? glm->bufferSize() : 0;
+}
+
+static void
+releaseGLMeshes(TriangleMesh* m, MeshLOD* lod)
+{
+  m->userData = nullptr;
+  if (lod != nullptr)
+    for (int i = 1; i < lod->levelCount(); ++i)
+      lod->level(i)->userData = nullptr;
+}
+
+void
+Assets::evict()
+{
+  struct Unused
+  {
+    MeshMap::iterator mit;
+    uint64_t lastUse;
+    Memory memory;
+
+  }; // Unused
+
+  std::vector<Unused> unused;
+  Memory used{};
+
+  ++_frame;
+  for (auto mit = _meshes.begin(); mit != _meshes.end(); ++mit)
+  {
+    TriangleMesh* m = mit->second;
+
+    if (m == nullptr)
+      continue;
+
+    auto bvh = BVHCache::find(m);
+    auto lod = LODCache::find(m);
+    Memory memory{m->memorySize(), glBufferSize(m), 0};
+
+    if (bvh != nullptr)
+      memory.bvh = bvh->memorySize();
+    if (lod != nullptr)
+      for (int i = 1; i < lod->levelCount(); ++i)
+      {
+        memory.cpu += lod->level(i)->memorySize();
+        memory.gpu += glBufferSize(lod->level(i));
+      }
+    used.cpu += memory.cpu;
+    used.gpu += memory.gpu;
+    used.bvh += memory.bvh;
+
+    // Besides this map, a BVH and a LOD chain reference their mesh;
+    // any other reference is from a primitive
+    auto references = 1 + (bvh != nullptr) + (lod != nullptr);
+
+    if (m->referenceCount() > references)
+      _lastUse[mit->first] = _frame;
+    else
+      unused.push_back({mit, _lastUse[mit->first], memory});
+  }
+  _memoryUsed = used;
+  if (used.cpu <= budget.cpu && used.gpu <= budget.gpu && used.bvh <= budget.bvh)
+    return;
+  std::sort(unused.begin(), unused.end(), [](const Unused& a, const Unused& b)
+    {
+      return a.lastUse < b.lastUse;
+    });
+  for (auto& u : unused)
+  {
+    TriangleMesh* m = u.mit->second;
+
+    if (used.cpu > budget.cpu || used.bvh > budget.bvh)
+    {
+      printf("Unloading mesh %s\n", u.mit->first.c_str());
+      BVHCache::remove(m);
+      LODCache::remove(m);
+      u.mit->second = nullptr;
+      _lastUse.erase(u.mit->first);
+      used.cpu -= u.memory.cpu;
+      used.gpu -= u.memory.gpu;
+      used.bvh -= u.memory.bvh;
+    }
+    else if (used.gpu > budget.gpu && u.memory.gpu > 0)
+    {
+      releaseGLMeshes(m, LODCache::find(m));
+      used.gpu -= u.memory.gpu;
+    }
+    else if (used.gpu <= budget.gpu)
+      break;
+  }
+  _memoryUsed = used;
+}
+
+StreamingMesh*
+Assets::loadStreamingMesh(StreamingMeshMapIterator sit)
+{
+  if (sit == _streamingMeshes.end())
+    return nullptr;
 
-  TriangleMesh* m{mit->second};
+  StreamingMesh* m{sit->second};
 
   if (m == nullptr)
   {
-    auto filename = "meshes/" + mit->first;
+    auto filename = "meshes/" + sit->first;
 
-    m = Application::loadMesh(filename.c_str());
-    _meshes[mit->first] = m;
+    m = StreamingMesh::open(Application::assetFilePath(filename.c_str()).c_str());
+    _streamingMeshes[sit->first] = m;
   }
   return m;
 }
@@ -28,12 +28,15 @@
 // Class definition for assets.
 //
 // Author(s): Paulo Pagliosa (and your name)
-// Last revision: 07/09/2019
+// Last revision: 19/10/2026
 
 #ifndef __Assets_h
 #define __Assets_h
 
+#include "StreamingMesh.h"
+#include "core/ThreadPool.h"
 #include "utils/MeshReader.h"
+#include <functional>
 #include <map>
 #include <string>
 
@@ -43,15 +46,44 @@ namespace cg
 using MeshRef = Reference<TriangleMesh>;
 using MeshMap = std::map<std::string, MeshRef>;
 using MeshMapIterator = typename MeshMap::const_iterator;
+using StreamingMeshMap = std::map<std::string, Reference<StreamingMesh>>;
+using StreamingMeshMapIterator = typename StreamingMeshMap::const_iterator;
 
 
 /////////////////////////////////////////////////////////////////////
 //
 // Assets: assets class
 // ======
+//
+// Meshes are loaded in background by a pool of loader threads, which
+// also build their BVHs and LOD chains (including the chains rebuilt
+// after the LOD settings change, see buildLOD()); GL meshes are
+// created by the render thread when the meshes are first drawn.
+// Meshes requested together are loaded concurrently.
+//
+// The memory used by the loaded meshes is bounded by a budget. When
+// it is exceeded, the least recently used meshes not referenced by any
+// primitive first give up their GL buffers (re-uploaded when drawn)
+// and, if still needed, are unloaded together with their BVHs and LOD
+// chains; an unloaded mesh is loaded again, from the mesh cache, by
+// the next call to loadMesh().
+//
 class Assets
 {
 public:
+  using MeshLoaded = std::function<void(TriangleMesh*, TriangleMesh*)>;
+
+  struct Memory
+  {
+    size_t cpu; // mesh arrays, including LOD levels
+    size_t gpu; // GL buffers
+    size_t bvh; // BVH nodes and triangle indices
+
+  }; // Memory
+
+  /// Memory budget (in bytes) of the loaded meshes.
+  static Memory budget;
+
   static void initialize();
 
   static MeshMap& meshes()
@@ -59,10 +91,60 @@ public:
     return _meshes;
   }
 
+  /// \brief Returns the mesh of \c mit. If the mesh is not loaded,
+  /// starts loading it and returns a placeholder (a box) to be used
+  /// until the mesh is ready (see update()).
   static TriangleMesh* loadMesh(MeshMapIterator mit);
 
+  /// \brief Stores the meshes loaded since the last call. For each
+  /// of them, \c loaded is called with the placeholder returned by
+  /// loadMesh() and the mesh that replaces it. Then, evicts meshes
+  /// if the budget is exceeded. Called by the render thread every
+  /// frame.
+  static void update(const MeshLoaded& loaded);
+
+  /// Returns the memory used by the loaded meshes.
+  static const Memory& memoryUsed()
+  {
+    return _memoryUsed;
+  }
+
+  static StreamingMeshMap& streamingMeshes()
+  {
+    return _streamingMeshes;
+  }
+
+  static StreamingMesh* loadStreamingMesh(StreamingMeshMapIterator sit);
+
+  /// \brief Starts building the LOD chain of \c mesh on a loader
+  /// thread, unless it is already being built. The chain is found in
+  /// the LOD cache when done. Called by the render thread.
+  static void buildLOD(TriangleMesh* mesh);
+
 private:
+  struct MeshLoad
+  {
+    MeshRef placeholder;
+    std::future<MeshRef> mesh;
+
+  }; // MeshLoad
+
+  struct LODBuild
+  {
+    MeshRef mesh; // released by the render thread
+    std::future<void> done;
+
+  }; // LODBuild
+
   static MeshMap _meshes;
+  static std::map<std::string, MeshLoad> _loads;
+  static std::map<std::string, uint64_t> _lastUse;
+  static uint64_t _frame;
+  static Memory _memoryUsed;
+  static StreamingMeshMap _streamingMeshes;
+  static std::map<TriangleMesh*, LODBuild> _lodBuilds;
+
+  static void evict();
 
 }; // Assets
 
@@ -28,9 +28,10 @@
 // Source file for BVH.
 //
 // Author(s): Paulo Pagliosa (and your name)
-// Last revision: 18/11/2019
+// Last revision: 19/10/2026
 
 #include "BVH.h"
+#include <cstring>
 #include <stack>
 
 namespace cg
@@ -60,6 +61,7 @@ struct BVH::Node
   Node* children[2];
   int first;
   int count;
+  int axis{};
 
   Node(const Bounds3f& b, int first, int count):
     bounds{b},
@@ -89,25 +91,21 @@ struct BVH::Node
     return children[0] == nullptr;
   }
 
-  static void iterate(const Node* node, BVHNodeFunction f);
-
 }; // BVH::Node
 
-void
-BVH::Node::iterate(const Node* node, BVHNodeFunction f)
+struct BVH::LinearNode
 {
-  if (node == nullptr)
-    return;
-
-  auto isLeaf = node->isLeaf();
+  Bounds3f bounds;
+  int offset; // first triangle (leaf) or second child (interior node)
+  int count; // number of triangles (0 for interior nodes)
+  int axis; // split axis (interior nodes only)
 
-  f({node->bounds, isLeaf, node->first, node->count});
-  if (!isLeaf)
+  bool isLeaf() const
   {
-    iterate(node->children[0], f);
-    iterate(node->children[1], f);
+    return count > 0;
   }
-}
+
+}; // BVH::LinearNode
 
 inline BVH::Node*
 BVH::makeLeaf(TriangleInfoArray& triangleInfo,
@@ -163,15 +161,56 @@ BVH::makeNode(TriangleInfoArray& triangleInfo,
     {
       return a.centroid[dim] < b.centroid[dim];
     });
-  return new Node{makeNode(triangleInfo, start, mid, orderedTris),
+
+  auto node = new Node{makeNode(triangleInfo, start, mid, orderedTris),
     makeNode(triangleInfo, mid, end, orderedTris)};
+
+  node->axis = dim;
+  return node;
+}
+
+int
+BVH::flatten(const Node* node, int& offset)
+{
+  auto index = offset++;
+  auto& linearNode = _nodes[index];
+
+  linearNode.bounds = node->bounds;
+  if (node->isLeaf())
+  {
+    linearNode.offset = node->first;
+    linearNode.count = node->count;
+    linearNode.axis = 0;
+  }
+  else
+  {
+    linearNode.count = 0;
+    linearNode.axis = node->axis;
+    flatten(node->children[0], offset);
+    linearNode.offset = flatten(node->children[1], offset);
+  }
+  return index;
 }
 
 BVH::BVH(TriangleMesh& mesh, int maxTrisPerNode):
   _mesh{&mesh},
   _maxTrisPerNode{maxTrisPerNode}
 {
-  const auto& data = mesh.data();
+  build();
+}
+
+BVH::BVH(TriangleMesh& mesh, const void* section, size_t size):
+  _mesh{&mesh},
+  _maxTrisPerNode{16}
+{
+  if (!load(section, size))
+    build();
+}
+
+void
+BVH::build()
+{
+  const auto& data = _mesh->data();
   int nt{data.numberOfTriangles};
 
   if (nt == 0)
@@ -196,12 +235,19 @@ BVH::BVH(TriangleMesh& mesh, int maxTrisPerNode):
   TriangleIndexArray orderedTris;
   
   orderedTris.reserve(nt);
-  _root = makeNode(triangleInfo, 0, nt, orderedTris);
+
+  auto root = makeNode(triangleInfo, 0, nt, orderedTris);
+  int offset{0};
+
   _triangles.swap(orderedTris);
+  // Flatten the tree into a depth-first array for traversal
+  _nodes.resize(_nodeCount);
+  flatten(root, offset);
+  delete root;
 #ifdef _DEBUG
   if (true)
   {
-    mesh.bounds().print("Mesh bounds:");
+    _mesh->bounds().print("Mesh bounds:");
     printf("Mesh triangles: %d\n", nt);
     bounds().print("BVH bounds:");
     printf("BVH nodes: %d\n", _nodeCount);
@@ -222,48 +268,279 @@ BVH::BVH(TriangleMesh& mesh, int maxTrisPerNode):
 
 BVH::~BVH()
 {
-  delete _root;
+  // do nothing
+}
+
+size_t
+BVH::memorySize() const
+{
+  return _nodes.size() * sizeof(LinearNode) + _triangles.size() * sizeof(int);
+}
+
+namespace internal
+{ // begin namespace internal
+
+//
+// Node of a BVH section. Nodes are copied field by field, since
+// LinearNode is not trivially copyable (Bounds3f has constructors)
+//
+struct SectionNode
+{
+  float bounds[6];
+  int offset;
+  int count;
+  int axis;
+
+}; // SectionNode
+
+} // end namespace internal
+
+//
+// Section layout: node count, triangle count (uint32 each), nodes,
+// triangle indices
+//
+void
+BVH::serialize(std::vector<char>& section) const
+{
+  uint32_t counts[2]{uint32_t(_nodes.size()), uint32_t(_triangles.size())};
+  auto nodeBytes = _nodes.size() * sizeof(internal::SectionNode);
+  auto triBytes = _triangles.size() * sizeof(int);
+  auto offset = section.size();
+
+  section.resize(offset + sizeof counts + nodeBytes + triBytes);
+
+  auto p = section.data() + offset;
+
+  memcpy(p, counts, sizeof counts);
+  p += sizeof counts;
+  for (const auto& node : _nodes)
+  {
+    const auto& a = node.bounds.min();
+    const auto& b = node.bounds.max();
+    internal::SectionNode s{{a.x, a.y, a.z, b.x, b.y, b.z},
+      node.offset,
+      node.count,
+      node.axis};
+
+    memcpy(p, &s, sizeof s);
+    p += sizeof s;
+  }
+  memcpy(p, _triangles.data(), triBytes);
+}
+
+bool
+BVH::load(const void* section, size_t size)
+{
+  uint32_t counts[2];
+
+  if (section == nullptr || size < sizeof counts)
+    return false;
+  memcpy(counts, section, sizeof counts);
+
+  size_t nn = counts[0];
+  size_t nt = counts[1];
+
+  if (nt != size_t(_mesh->data().numberOfTriangles) || (nn == 0) != (nt == 0))
+    return false;
+
+  auto nodeBytes = nn * sizeof(internal::SectionNode);
+
+  if (size != sizeof counts + nodeBytes + nt * sizeof(int))
+    return false;
+  _nodes.resize(nn);
+  _triangles.resize(nt);
+
+  auto p = static_cast<const char*>(section) + sizeof counts;
+
+  for (auto& node : _nodes)
+  {
+    internal::SectionNode s;
+
+    memcpy(&s, p, sizeof s);
+    p += sizeof s;
+    node.bounds = Bounds3f{vec3f{s.bounds[0], s.bounds[1], s.bounds[2]},
+      vec3f{s.bounds[3], s.bounds[4], s.bounds[5]}};
+    node.offset = s.offset;
+    node.count = s.count;
+    node.axis = s.axis;
+  }
+  memcpy(_triangles.data(), p, nt * sizeof(int));
+  // Reject sections whose links would leave the arrays or whose
+  // depth would overflow the traversal stack of intersect()
+  std::vector<unsigned char> depth(nn);
+  auto ok = true;
+
+  for (size_t i = 0; ok && i < nn; ++i)
+  {
+    const auto& node = _nodes[i];
+
+    if (node.isLeaf())
+      ok = node.offset >= 0 && size_t(node.offset) + node.count <= nt;
+    else if ((ok = node.count == 0 && size_t(node.offset) > i + 1 &&
+      size_t(node.offset) < nn && unsigned(node.axis) < 3 && depth[i] < 64))
+      depth[i + 1] = depth[node.offset] = depth[i] + 1;
+  }
+  for (size_t i = 0; ok && i < nt; ++i)
+    ok = unsigned(_triangles[i]) < nt;
+  if (!ok)
+  {
+    _nodes.clear();
+    _triangles.clear();
+    return false;
+  }
+  _nodeCount = int(nn);
+  return true;
 }
 
 Bounds3f
 BVH::bounds() const
 {
-  return _root == nullptr ? Bounds3f{} : _root->bounds;
+  return _nodes.empty() ? Bounds3f{} : _nodes[0].bounds;
+}
+
+void
+BVH::iterate(int index, BVHNodeFunction f) const
+{
+  const auto& node = _nodes[index];
+  auto isLeaf = node.isLeaf();
+
+  f({node.bounds, isLeaf, node.offset, node.count});
+  if (!isLeaf)
+  {
+    iterate(index + 1, f);
+    iterate(node.offset, f);
+  }
 }
 
 void
 BVH::iterate(BVHNodeFunction f) const
 {
-  Node::iterate(_root, f);
+  if (!_nodes.empty())
+    iterate(0, f);
 }
 
 bool
 BVH::intersect(const Ray& ray, Intersection& hit) const
 {
-  hit.object = nullptr;
-  std::stack<Node*> stack;
-
-  stack.push(_root);
-  while (!stack.empty())
+  if (_nodes.empty())
+    return false;
+
+  const auto& data = _mesh->data();
+  const auto invDir = ray.direction.inverse();
+  const int dirIsNeg[3]{invDir.x < 0, invDir.y < 0, invDir.z < 0};
+  // Median splits keep the tree depth close to log2(nt)
+  int stack[64];
+  int top{0};
+  int current{0};
+  bool found{false};
+
+  for (;;)
   {
-    Node* node = stack.top();
-    stack.pop();
+    const auto& node = _nodes[current];
 
-    float min, max;
-    if (!node->bounds.intersect(ray, min, max))
-        //!intersect(ray, node->bounds))
-        continue;
-    if (node->isLeaf()) {
-        return true;
-    }
-    if (node->count==0)
+    if (intersectBounds(node.bounds, ray, invDir, dirIsNeg, hit.distance))
     {
-        stack.push(node->children[0]);
-        stack.push(node->children[1]);
+      if (!node.isLeaf())
+      {
+        // Visit the near child first
+        if (dirIsNeg[node.axis])
+        {
+          stack[top++] = current + 1;
+          current = node.offset;
+        }
+        else
+        {
+          stack[top++] = node.offset;
+          current = current + 1;
+        }
         continue;
+      }
+      for (int i = node.offset, e = node.offset + node.count; i < e; ++i)
+      {
+        auto t = data.triangles + _triangles[i];
+        float d, b1, b2;
+
+        if (intersectTriangle(ray,
+          data.vertices[t->v[0]],
+          data.vertices[t->v[1]],
+          data.vertices[t->v[2]],
+          d,
+          b1,
+          b2) && d >= ray.tMin && d < hit.distance)
+        {
+          hit.triangleIndex = _triangles[i];
+          hit.distance = d;
+          hit.p.set(1 - b1 - b2, b1, b2);
+          found = true;
+        }
+      }
     }
+    if (top == 0)
+      break;
+    current = stack[--top];
   }
-  return false;
+  return found;
+}
+
+
+/////////////////////////////////////////////////////////////////////
+//
+// BVHCache implementation
+// ========
+BVHCache::BVHMap BVHCache::_bvhs;
+std::shared_mutex BVHCache::_lock;
+
+BVH*
+BVHCache::get(TriangleMesh* mesh)
+{
+  if (mesh == nullptr)
+    return nullptr;
+  {
+    std::shared_lock<std::shared_mutex> lock{_lock};
+
+    if (auto bvh = _bvhs.find(mesh); bvh != _bvhs.end())
+      return bvh->second;
+  }
+
+  // BVHs of different meshes are built concurrently; if two threads
+  // build the BVH of the same mesh, the first one stored is kept
+  Reference<BVH> bvh = new BVH{*mesh, 16};
+  std::lock_guard<std::shared_mutex> lock{_lock};
+  auto& cached = _bvhs[mesh];
+
+  if (cached == nullptr)
+    cached = bvh;
+  return cached;
+}
+
+void
+BVHCache::set(TriangleMesh* mesh, BVH* bvh)
+{
+  std::lock_guard<std::shared_mutex> lock{_lock};
+  _bvhs[mesh] = bvh;
+}
+
+BVH*
+BVHCache::find(TriangleMesh* mesh)
+{
+  std::shared_lock<std::shared_mutex> lock{_lock};
+  auto bvh = _bvhs.find(mesh);
+
+  return bvh != _bvhs.end() ? bvh->second : nullptr;
+}
+
+void
+BVHCache::remove(TriangleMesh* mesh)
+{
+  std::lock_guard<std::shared_mutex> lock{_lock};
+  _bvhs.erase(mesh);
+}
+
+void
+BVHCache::clear()
+{
+  std::lock_guard<std::shared_mutex> lock{_lock};
+  _bvhs.clear();
 }
 
 } // end namespace cg
@@ -28,7 +28,7 @@
 // Class definition for BVH.
 //
 // Author(s): Paulo Pagliosa (and your name)
-// Last revision: 18/11/2019
+// Last revision: 19/10/2026
 
 #ifndef __BVH_h
 #define __BVH_h
@@ -36,6 +36,8 @@
 #include "graphics/GLMesh.h"
 #include "Intersection.h"
 #include <functional>
+#include <map>
+#include <shared_mutex>
 #include <vector>
 
 namespace cg
@@ -52,11 +54,49 @@ struct BVHNodeInfo
 
 using BVHNodeFunction = std::function<void(const BVHNodeInfo&)>;
 
+/// \brief Slab test of a ray against a box, limited to the interval
+/// [ray.tMin, maxDistance). \c dirIsNeg holds the signs of \c invDir.
+inline bool
+intersectBounds(const Bounds3f& b,
+  const Ray& ray,
+  const vec3f& invDir,
+  const int dirIsNeg[3],
+  float maxDistance)
+{
+  auto tMin = (b[dirIsNeg[0]].x - ray.origin.x) * invDir.x;
+  auto tMax = (b[1 - dirIsNeg[0]].x - ray.origin.x) * invDir.x;
+  auto tyMin = (b[dirIsNeg[1]].y - ray.origin.y) * invDir.y;
+  auto tyMax = (b[1 - dirIsNeg[1]].y - ray.origin.y) * invDir.y;
+
+  if (tMin > tyMax || tyMin > tMax)
+    return false;
+  if (tyMin > tMin)
+    tMin = tyMin;
+  if (tyMax < tMax)
+    tMax = tyMax;
+
+  auto tzMin = (b[dirIsNeg[2]].z - ray.origin.z) * invDir.z;
+  auto tzMax = (b[1 - dirIsNeg[2]].z - ray.origin.z) * invDir.z;
+
+  if (tMin > tzMax || tzMin > tMax)
+    return false;
+  if (tzMin > tMin)
+    tMin = tzMin;
+  if (tzMax < tMax)
+    tMax = tzMax;
+  return tMin < maxDistance && tMax > ray.tMin;
+}
+
 class BVH: public SharedObject
 {
 public:
   BVH(TriangleMesh& mesh, int maxTrisPerNode = 16);
 
+  /// \brief Constructs a BVH of \c mesh from a section written by
+  /// serialize(). The BVH is built from scratch if the section does
+  /// not match the mesh.
+  BVH(TriangleMesh& mesh, const void* section, size_t size);
+
   ~BVH() override;
 
   const TriangleMesh* mesh() const
@@ -67,16 +107,28 @@ public:
   Bounds3f bounds() const;
   void iterate(BVHNodeFunction f) const;
 
+  /// \brief Intersects a ray, given in mesh space, with the mesh.
+  /// Only hits closer than \c hit.distance are considered. If one is
+  /// found, the triangle index, distance and barycentric coordinates
+  /// of the closest hit are stored in \c hit and true is returned.
   bool intersect(const Ray& ray, Intersection& hit) const;
 
+  /// Appends the flattened nodes and triangle indices to \c section.
+  void serialize(std::vector<char>& section) const;
+
+  /// Returns the size in bytes of the nodes and triangle indices.
+  size_t memorySize() const;
+
 private:
   struct Node;
+  struct LinearNode;
 
   using TriangleIndexArray = std::vector<int>;
+  using LinearNodeArray = std::vector<LinearNode>;
 
   Reference<TriangleMesh> _mesh;
   TriangleIndexArray _triangles;
-  Node* _root{};
+  LinearNodeArray _nodes;
   int _nodeCount{};
   int _maxTrisPerNode;
 
@@ -94,8 +146,47 @@ private:
     int end,
     TriangleIndexArray&);
 
+  void build();
+  bool load(const void*, size_t);
+  int flatten(const Node*, int& offset);
+  void iterate(int, BVHNodeFunction) const;
+
 }; // BVH
 
+
+/////////////////////////////////////////////////////////////////////
+//
+// BVHCache: per-mesh BVH cache class
+// ========
+//
+// The cache is thread-safe: meshes are loaded, and their BVHs built,
+// by loader threads (see Assets) while the scene is traced.
+//
+class BVHCache
+{
+public:
+  /// Returns the BVH of \c mesh, building it on first use.
+  static BVH* get(TriangleMesh* mesh);
+
+  /// Sets the BVH of \c mesh (e.g., one read from a mesh file).
+  static void set(TriangleMesh* mesh, BVH* bvh);
+
+  /// Returns the BVH of \c mesh, or null if it was not built.
+  static BVH* find(TriangleMesh* mesh);
+
+  /// Discards the BVH of \c mesh, if any.
+  static void remove(TriangleMesh* mesh);
+
+  static void clear();
+
+private:
+  using BVHMap = std::map<TriangleMesh*, Reference<BVH>>;
+
+  static BVHMap _bvhs;
+  static std::shared_mutex _lock;
+
+}; // BVHCache
+
 } // end namespace cg
 
 #endif // __BVH_h
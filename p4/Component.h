@@ -28,12 +28,14 @@
 // Class definition for scene object component.
 //
 // Author(s): Paulo Pagliosa (and your name)
-// Last revision: 25/08/2018
+// Last revision: 19/10/2026
 
 #ifndef __Component_h
 #define __Component_h
 
+#include "core/ObjectPool.h"
 #include "core/SharedObject.h"
+#include "SceneJournal.h"
 
 namespace cg
 { // begin namespace cg
@@ -67,6 +69,10 @@ public:
 
   /// Returns the transform of this component.
   Transform* transform(); // implemented in SceneObject.h
+  const Transform* transform() const; // implemented in SceneObject.h
+
+  /// Records a change of this component in the scene journal.
+  void recordChange(SceneJournal::Event event); // implemented in SceneObject.cpp
 
 protected:
     Component(const char* const typeName) :
@@ -3,6 +3,9 @@
 #include "SceneObject.h"
 
 namespace cg {
+	DEFINE_POOL_ALLOCATED(ComponentList)
+	DEFINE_POOL_ALLOCATED(ComponentListIterator)
+
 	ComponentList::~ComponentList() {
 		while (_head!=_tail) {
 			remove(_tail);
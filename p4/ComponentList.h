@@ -2,12 +2,15 @@
 #define __ComponentList_h
 
 #include "Transform.h"
+#include <cstring>
 namespace cg {
 
 //favor performance over memory -> double linked list
 //head is always a transform component, and shall not be deleted
 class ComponentList {
 public:
+	DECLARE_POOL_ALLOCATED(ComponentList);
+
 	ComponentList(SceneObject* object);
 
 	~ComponentList();
@@ -19,7 +22,7 @@ public:
 	Component* getComponent(const char* typeName) {
 		Component* component = _head;
 		while (component) {
-			if(component->typeName() == typeName){
+			if(strcmp(component->typeName(), typeName) == 0){
 				return component;
 			}
 			else {
@@ -44,6 +47,8 @@ private:
 
 class ComponentListIterator {
 public:
+	DECLARE_POOL_ALLOCATED(ComponentListIterator);
+
 	//returns a pointer to the component the iterator is currently referencing.
 	Component* getReference() {
 		return _currentComponent;
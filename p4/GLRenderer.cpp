@@ -28,10 +28,12 @@
 // Source file for OpenGL renderer.
 //
 // Author(s): Paulo Pagliosa (and your name)
-// Last revision: 09/09/2019
+// Last revision: 19/10/2026
 
+#include "Assets.h"
 #include "GLRenderer.h"
 #include "Light.h"
+#include "MeshLOD.h"
 #include "Primitive.h"
 #include "graphics/Application.h"
 
@@ -86,6 +88,7 @@ namespace cg
 
         _transformLoc = _program.uniformLocation("transform");
         _normalMatrixLoc = _program.uniformLocation("normalMatrix");
+        _decodeLocs.locate(_program);
 
         _vpMatrixLoc = _program.uniformLocation("vpMatrix");
         _cameraPositionLoc = _program.uniformLocation("cameraPosition");
@@ -95,7 +98,49 @@ namespace cg
         GLRenderer::update()
     {
         Renderer::update();
-        // TODO
+        if (_scene != _lastScene) {
+            _lastScene = _scene;
+            _dirty = true;
+        }
+
+        // pull the scene changes since the last frame
+        auto synced = _scene->journal().changesSince(_version,
+            [this](const SceneJournal::Entry& e) {
+                using Event = SceneJournal::Event;
+
+                switch (e.event) {
+                case Event::Visibility:
+                case Event::ObjectAdded:
+                case Event::ObjectRemoved:
+                case Event::ComponentAdded:
+                case Event::ComponentRemoved:
+                    _dirty = true;
+                    break;
+                default: // read every frame
+                    break;
+                }
+            });
+
+        _version = _scene->journal().version();
+        if (_dirty || !synced) {
+            _lights.clear();
+            _primitives.clear();
+            SceneObjectListIterator* it = _scene->objectIterator();
+            //first object is root, so we can skip it
+            it->start();
+            for (SceneObject* obj = it->next(); obj; obj = it->next())
+                collect(obj);
+            it->dispose();
+
+            // forget the LOD levels of primitives no longer visible
+            decltype(_lodLevels) lodLevels;
+            for (auto primitive : _primitives)
+                if (auto lod = _lodLevels.find(primitive); lod != _lodLevels.end())
+                    lodLevels.insert(*lod);
+            _lodLevels.swap(lodLevels);
+            _dirty = false;
+        }
+        getLights();
     }
 
     void
@@ -107,8 +152,6 @@ namespace cg
         glClearColor(bc.r, bc.g, bc.b, 1.0f);
         glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
 
-
-        getLights();
         //set light and camera uniforms
         _program.setUniformMat4(_vpMatrixLoc, vpMatrix(_camera));
         _program.setUniformVec4(_ambientLightLoc, _scene->ambientLight);
@@ -125,70 +168,89 @@ namespace cg
             _program.setUniform(_lightLocs[i]._radialFalloffLoc, _lightProps[i]._radialFalloff);
         }
 
-        //render all objects
-        SceneObjectListIterator* objectIterator = _scene->objectIterator();
-        //first object is root, so we can skip it
-        objectIterator->start();
-        SceneObject* obj = objectIterator->next();
-        //call a recursive render function for each object and render it
-        while (obj) {
-            drawObject(obj);
-
-            obj = objectIterator->next();
-        }
-        objectIterator->dispose();
+        //render all visible primitives
+        for (auto primitive : _primitives)
+            drawPrimitive(primitive);
     }
 
-    void GLRenderer::drawObject(SceneObject* obj) { //draw objects and its children
-        Primitive* primitive = dynamic_cast<Primitive*>(obj->getComponent("Primitive"));
-        if (primitive) {
-            auto m = glMesh(primitive->mesh());
-
-            if (nullptr == m)
-                return;
-
-            auto t = primitive->transform();
-            auto normalMatrix = mat3f{ t->worldToLocalMatrix() }.transposed();
-
-            _program.setUniformMat4(_transformLoc, t->localToWorldMatrix());
-            _program.setUniformMat3(_normalMatrixLoc, normalMatrix);
-            //set material uniforms
-            _program.setUniformVec4(_OaLoc, primitive->material.ambient);
-            _program.setUniformVec4(_OdLoc, primitive->material.diffuse);
-            _program.setUniformVec4(_OsLoc, primitive->material.spot);
-            _program.setUniform(_nsLoc, primitive->material.shine);
-
-            m->bind();
-            //draws mesh
-            glPolygonMode(GL_FRONT_AND_BACK, GL_FILL);
-            glDrawElements(GL_TRIANGLES, m->vertexCount(), GL_UNSIGNED_INT, 0);
-        }
+    void GLRenderer::collect(SceneObject* obj) { //collects lights and primitives of an object and its children
+        if (auto light = dynamic_cast<Light*>(obj->getComponent("Light")))
+            _lights.push_back(light);
+        if (obj->visible)
+            if (auto primitive = dynamic_cast<Primitive*>(obj->getComponent("Primitive")))
+                _primitives.push_back(primitive);
 
-        //draws children
         SceneObjectListIterator* it = obj->objectIterator();
-        SceneObject* newObj = it->start();
-        while (newObj) {
-            drawObject(newObj);
-            newObj = it->next();
-        }
+        for (SceneObject* newObj = it->start(); newObj; newObj = it->next())
+            collect(newObj);
         it->dispose();
     }
 
-    void GLRenderer::getLights() {
-        _lightCount = 0;
-        SceneObjectListIterator* it = _scene->objectIterator();
-        it->start(); //root is skipped
-        SceneObject* obj = it->next();
-        while (obj && _lightCount < MAX_LIGHTS) {
-            recursiveGetLights(obj);
-            obj = it->next();
+    float GLRenderer::screenSize(Primitive* primitive) const {
+        //fraction of the viewport height covered by the bounding sphere
+        Bounds3f bounds{primitive->mesh()->bounds(), primitive->transform()->localToWorldMatrix()};
+        auto radius = bounds.diagonalLength() * 0.5f;
+
+        if (_camera->projectionType() == Camera::Parallel)
+            return 2 * radius / _camera->height();
+
+        auto d = (bounds.center() - _camera->transform()->position()).length();
+
+        if (d <= radius)
+            return math::Limits<float>::inf();
+        return radius / (d * tan(math::toRadians(_camera->viewAngle()) * 0.5f));
+    }
+
+    TriangleMesh* GLRenderer::selectLOD(Primitive* primitive) {
+        auto mesh = primitive->mesh();
+
+        if (nullptr == mesh || MeshLOD::settings.levels < 2)
+            return mesh;
+
+        //the chain is built in background; level 0 is drawn meanwhile
+        auto lod = LODCache::find(mesh);
+
+        if (nullptr == lod) {
+            Assets::buildLOD(mesh);
+            return mesh;
         }
-        it->dispose();
+
+        auto& level = _lodLevels[primitive];
+
+        level = lod->select(screenSize(primitive), level);
+        return lod->level(level);
+    }
+
+    void GLRenderer::drawPrimitive(Primitive* primitive) {
+        auto m = glMesh(selectLOD(primitive));
+
+        if (nullptr == m)
+            return;
+
+        auto t = primitive->transform();
+        auto normalMatrix = mat3f{ t->worldToLocalMatrix() }.transposed();
+
+        _program.setUniformMat4(_transformLoc, t->localToWorldMatrix());
+        _program.setUniformMat3(_normalMatrixLoc, normalMatrix);
+        //set material uniforms
+        _program.setUniformVec4(_OaLoc, primitive->material.ambient);
+        _program.setUniformVec4(_OdLoc, primitive->material.diffuse);
+        _program.setUniformVec4(_OsLoc, primitive->material.spot);
+        _program.setUniform(_nsLoc, primitive->material.shine);
+        m->setDecodeUniforms(_decodeLocs);
+
+        m->bind();
+        //draws mesh
+        glPolygonMode(GL_FRONT_AND_BACK, GL_FILL);
+        glDrawElements(GL_TRIANGLES, m->vertexCount(), GL_UNSIGNED_INT, 0);
     }
 
-    void GLRenderer::recursiveGetLights(SceneObject* obj) {
-        Light* light = dynamic_cast<Light*>(obj->getComponent("Light"));
-        if (light) {
+    void GLRenderer::getLights() {
+        //light properties may change every frame, the light list does not
+        _lightCount = 0;
+        for (auto light : _lights) {
+            if (_lightCount == MAX_LIGHTS)
+                break;
             _lightProps[_lightCount]._type = light->type();
             _lightProps[_lightCount]._color = light->color;
             _lightProps[_lightCount]._position = light->transform()->position();
@@ -198,13 +260,6 @@ namespace cg
             _lightProps[_lightCount]._radialFalloff = light->getRadialFalloff();
             _lightCount++;
         }
-        SceneObjectListIterator* it = obj->objectIterator();
-        SceneObject* newObj = it->start();
-        while (newObj && _lightCount < MAX_LIGHTS) {
-            recursiveGetLights(newObj);
-            newObj = it->next();
-        }
-        it->dispose();
     }
 
 } // end namespace cg
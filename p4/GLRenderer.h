@@ -28,7 +28,7 @@
 // Class definition for OpenGL renderer.
 //
 // Author(s): Paulo Pagliosa (and your name)
-// Last revision: 21/09/2019
+// Last revision: 19/10/2026
 
 #ifndef __GLRenderer_h
 #define __GLRenderer_h
@@ -37,10 +37,16 @@
 
 #include "Renderer.h"
 #include "graphics/GLGraphics3.h"
+#include <unordered_map>
+#include <vector>
 
 namespace cg
 { // begin namespace cg
 
+// Forward definitions
+class Light;
+class Primitive;
+
 
 //////////////////////////////////////////////////////////
 //
@@ -56,8 +62,22 @@ public:
 	void getLights();
 
 private:
-    void recursiveGetLights(SceneObject* obj);
-    void drawObject(SceneObject* obj);
+    void collect(SceneObject* obj);
+    void drawPrimitive(Primitive* primitive);
+    TriangleMesh* selectLOD(Primitive* primitive);
+    float screenSize(Primitive* primitive) const;
+
+    // Lights and visible primitives of the scene, rebuilt only when
+    // objects or components are added, removed, or hidden
+    std::vector<Light*> _lights;
+    std::vector<Primitive*> _primitives;
+    Scene* _lastScene{};
+    uint64_t _version{};
+    bool _dirty{true};
+
+    // LOD level drawn in the last frame for each visible primitive
+    // (see MeshLOD::select)
+    std::unordered_map<Primitive*, int> _lodLevels;
 
     GLSL::Program _program;
 
@@ -97,6 +117,7 @@ private:
     //primitive
     GLfloat _transformLoc;
     GLfloat _normalMatrixLoc;
+    GLMesh::DecodeUniforms _decodeLocs;
 
     //camera
     GLfloat _vpMatrixLoc;
@@ -0,0 +1,554 @@
+//[]---------------------------------------------------------------[]
+//|                                                                 |
+//| Copyright (C) 2019 Orthrus Group.                               |
+//|                                                                 |
+//| This software is provided 'as-is', without any express or       |
+//| implied warranty. In no event will the authors be held liable   |
+//| for any damages arising from the use of this software.          |
+//|                                                                 |
+//| Permission is granted to anyone to use this software for any    |
+//| purpose, including commercial applications, and to alter it and |
+//| redistribute it freely, subject to the following restrictions:  |
+//|                                                                 |
+//| 1. The origin of this software must not be misrepresented; you  |
+//| must not claim that you wrote the original software. If you use |
+//| this software in a product, an acknowledgment in the product    |
+//| documentation would be appreciated but is not required.         |
+//|                                                                 |
+//| 2. Altered source versions must be plainly marked as such, and  |
+//| must not be misrepresented as being the original software.      |
+//|                                                                 |
+//| 3. This notice may not be removed or altered from any source    |
+//| distribution.                                                   |
+//|                                                                 |
+//[]---------------------------------------------------------------[]
+//
+// OVERVIEW: Harness.cpp
+// ========
+// Source file for ray tracer regression harness.
+//
+// Author(s): Paulo Pagliosa (and your name)
+// Last revision: 19/10/2026
+
+#include "Harness.h"
+#include "ScenePresets.h"
+#include "geometry/MeshSweeper.h"
+#include <cmath>
+#include <cstring>
+#include <map>
+#ifdef _WIN32
+#include <windows.h>
+#include <psapi.h>
+#define PATH_SEP '\\'
+#else
+#include <sys/resource.h>
+#define PATH_SEP '/'
+#endif
+
+namespace cg
+{ // begin namespace cg
+
+namespace internal
+{ // begin namespace internal
+
+//
+// Image in memory, on which the scenes are rendered
+//
+class MemoryImage: public Image
+{
+public:
+  MemoryImage(int width, int height):
+    Image{width, height},
+    _buffer{width, height}
+  {
+    // do nothing
+  }
+
+  const auto& buffer() const
+  {
+    return _buffer;
+  }
+
+  void draw(int, int) const override
+  {
+    // do nothing
+  }
+
+private:
+  ImageBuffer _buffer;
+
+  void setSubImage(int x, int y, int w, int h, const Pixel* data) override
+  {
+    for (int j = 0; j < h; ++j, data += w)
+      memcpy(&_buffer(x, y + j), data, w * sizeof(Pixel));
+  }
+
+  void getSubImage(int x, int y, int w, int h, Pixel* data) const override
+  {
+    for (int j = 0; j < h; ++j, data += w)
+      memcpy(data, &_buffer(x, y + j), w * sizeof(Pixel));
+  }
+
+}; // MemoryImage
+
+inline size_t
+peakMemory()
+{
+#ifdef _WIN32
+  PROCESS_MEMORY_COUNTERS pmc;
+
+  GetProcessMemoryInfo(GetCurrentProcess(), &pmc, sizeof pmc);
+  return pmc.PeakWorkingSetSize;
+#else
+  rusage usage;
+
+  getrusage(RUSAGE_SELF, &usage);
+#ifdef __APPLE__
+  return size_t(usage.ru_maxrss);
+#else
+  return size_t(usage.ru_maxrss) << 10;
+#endif
+#endif
+}
+
+// Resets the peak memory of the process to its current memory, where
+// the system allows it (Linux); elsewhere, the peak of a render only
+// grows when it exceeds the peaks of the renders before it
+inline void
+resetPeakMemory()
+{
+#ifdef __linux__
+  if (auto file = fopen("/proc/self/clear_refs", "w"))
+  {
+    fputs("5", file);
+    fclose(file);
+  }
+#endif
+}
+
+// Names of the accumulation buffer layouts, in declaration order
+static const char* layoutNames[]{"row", "tiled", "morton"};
+
+// Images are written and read top to bottom
+bool
+writeImage(const char* filename, const ImageBuffer& image)
+{
+  auto w = image.width();
+  auto h = image.height();
+  Reference<ImageWriter> writer = ImageWriter::open(filename, w, h);
+
+  if (writer == nullptr)
+    return false;
+  for (int j = h - 1; j >= 0; --j)
+    writer->writeRows(&image(0, j), 1);
+  return writer->close();
+}
+
+bool
+readPPM(const char* filename, ImageBuffer& image)
+{
+  auto file = fopen(filename, "rb");
+
+  if (file == nullptr)
+    return false;
+
+  int w;
+  int h;
+  int maxval;
+  auto ok = fscanf(file, "P6 %d %d %d", &w, &h, &maxval) == 3 &&
+    maxval == 255 &&
+    fgetc(file) != EOF &&
+    w == image.width() &&
+    h == image.height();
+
+  for (int j = h - 1; ok && j >= 0; --j)
+    ok = fread(&image(0, j), sizeof(Pixel), w, file) == size_t(w);
+  fclose(file);
+  return ok;
+}
+
+double
+psnr(const ImageBuffer& a, const ImageBuffer& b)
+{
+  double mse = 0;
+
+  for (int i = 0, n = a.length(); i < n; ++i)
+  {
+    double dr = a[i].r - b[i].r;
+    double dg = a[i].g - b[i].g;
+    double db = a[i].b - b[i].b;
+
+    mse += dr * dr + dg * dg + db * db;
+  }
+  mse /= 3.0 * a.length();
+  // Identical images are given 100 dB
+  return mse > 0 ? std::min(100.0, 10 * log10(255 * 255 / mse)) : 100;
+}
+
+inline double
+luma(const Pixel& p)
+{
+  return 0.299 * p.r + 0.587 * p.g + 0.114 * p.b;
+}
+
+//
+// Mean SSIM of the luma of 8x8 windows, overlapped by half (Wang, Z.
+// et al. Image quality assessment: from error visibility to structural
+// similarity, 2004)
+//
+double
+ssim(const ImageBuffer& a, const ImageBuffer& b)
+{
+  constexpr int ws = 8;
+  constexpr double c1 = (0.01 * 255) * (0.01 * 255);
+  constexpr double c2 = (0.03 * 255) * (0.03 * 255);
+  auto w = a.width();
+  auto h = a.height();
+  double sum = 0;
+  int count = 0;
+
+  for (int y = 0; y + ws <= h; y += ws / 2)
+    for (int x = 0; x + ws <= w; x += ws / 2)
+    {
+      double ma = 0, mb = 0, va = 0, vb = 0, cab = 0;
+
+      for (int j = y; j < y + ws; ++j)
+        for (int i = x; i < x + ws; ++i)
+        {
+          auto la = luma(a(i, j));
+          auto lb = luma(b(i, j));
+
+          ma += la;
+          mb += lb;
+          va += la * la;
+          vb += lb * lb;
+          cab += la * lb;
+        }
+
+      constexpr double n = ws * ws;
+
+      ma /= n;
+      mb /= n;
+      va = va / n - ma * ma;
+      vb = vb / n - mb * mb;
+      cab = cab / n - ma * mb;
+      sum += (2 * ma * mb + c1) * (2 * cab + c2) /
+        ((ma * ma + mb * mb + c1) * (va + vb + c2));
+      ++count;
+    }
+  return count > 0 ? sum / count : 1;
+}
+
+// Results are written one per line, so that they are read back
+// without a JSON parser
+inline bool
+readNumber(const char* line, const char* key, double& value)
+{
+  auto s = strstr(line, key);
+
+  if (s == nullptr)
+    return false;
+  value = strtod(s + strlen(key), nullptr);
+  return true;
+}
+
+} // end namespace internal
+
+
+/////////////////////////////////////////////////////////////////////
+//
+// Harness implementation
+// =======
+bool
+Harness::parse(int argc, char** argv)
+{
+  for (int i = 0; i < argc; ++i)
+  {
+    auto option = argv[i];
+    auto more = [&](int n) { return i + n < argc; };
+
+    if (!strcmp(option, "--golden") && more(1))
+      _goldenDir = argv[++i];
+    else if (!strcmp(option, "--update"))
+      _update = true;
+    else if (!strcmp(option, "--results") && more(1))
+      _resultsFile = argv[++i];
+    else if (!strcmp(option, "--compare") && more(1))
+      _compareFile = argv[++i];
+    else if (!strcmp(option, "--size") && more(2))
+    {
+      _W = std::max(atoi(argv[++i]), 8);
+      _H = std::max(atoi(argv[++i]), 8);
+    }
+    else if (!strcmp(option, "--samples") && more(2))
+    {
+      _baseSamples = atoi(argv[++i]);
+      _maxSamples = atoi(argv[++i]);
+    }
+    else if (!strcmp(option, "--denoise"))
+      _denoising = true;
+    else if (!strcmp(option, "--aovs"))
+      _aovs = true;
+    else if (!strcmp(option, "--layout") && more(1))
+    {
+      auto name = argv[++i];
+      int l = 0;
+
+      while (l < 3 && strcmp(name, internal::layoutNames[l]))
+        ++l;
+      if (l == 3)
+      {
+        printf("Harness: bad layout %s\n", name);
+        return false;
+      }
+      _layout = AccumulationBuffer::Layout(l);
+    }
+    else if (!strcmp(option, "--checkpoint") && more(2))
+    {
+      _checkpointDir = argv[++i];
+      _checkpointInterval = (float)atof(argv[++i]);
+    }
+    else if (!strcmp(option, "--resume"))
+      _resuming = true;
+    else if (!strcmp(option, "--psnr") && more(1))
+      _minPSNR = atof(argv[++i]);
+    else if (!strcmp(option, "--ssim") && more(1))
+      _minSSIM = atof(argv[++i]);
+    else if (!strcmp(option, "--tolerance") && more(1))
+      _tolerance = atof(argv[++i]);
+    else
+    {
+      printf("Harness: bad option %s\n", option);
+      return false;
+    }
+  }
+  return true;
+}
+
+bool
+Harness::render(int index)
+{
+  // Memory is measured from here, so that scenes are not charged for
+  // the memory of the scenes rendered before them
+  internal::resetPeakMemory();
+
+  auto baseMemory = internal::peakMemory();
+  MeshMap meshes;
+
+  meshes["Box"] = MeshSweeper::makeBox();
+  meshes["Sphere"] = MeshSweeper::makeSphere();
+
+  SceneObject* object{};
+  Reference<Scene> scene = makeScenePreset(index, meshes, object);
+  auto camera = dynamic_cast<Camera*>(object->getComponent("Camera"));
+  Reference<RayTracer> rayTracer = new RayTracer{*scene, camera};
+  internal::MemoryImage image{_W, _H};
+
+  rayTracer->setSamples(_baseSamples, _maxSamples);
+  rayTracer->setDenoising(_denoising);
+  rayTracer->setBufferLayout(_layout);
+  if (_aovs)
+    rayTracer->setAOVs(RayTracer::AOV::All);
+  if (!_checkpointDir.empty())
+  {
+    auto checkpoint = _checkpointDir + "/scene" + std::to_string(index);
+
+    checkpoint += ".ckpt";
+    rayTracer->setCheckpoint(checkpoint.c_str(), _checkpointInterval);
+    rayTracer->setResuming(_resuming);
+  }
+  // Mesh BVHs are built again, so that their build time is measured
+  BVHCache::clear();
+  rayTracer->renderImage(image);
+  putchar('\n');
+
+  auto stats = rayTracer->statistics();
+  Result r;
+
+  r.scene = scene->name();
+  r.raysPerSecond = stats.numberOfRays / std::max(stats.renderTime, 1e-6f);
+  r.bvhTime = stats.bvhTime;
+  r.renderTime = stats.renderTime;
+  r.peakMemoryGrowth = internal::peakMemory() - baseMemory;
+  r.psnr = r.ssim = 0;
+
+  auto golden = _goldenDir + "/scene" + std::to_string(index) + ".ppm";
+
+  if (_update)
+  {
+    r.passed = internal::writeImage(golden.c_str(), image.buffer());
+    if (!r.passed)
+      printf("Unable to write golden image %s\n", golden.c_str());
+  }
+  else
+  {
+    ImageBuffer reference{_W, _H};
+
+    if (!internal::readPPM(golden.c_str(), reference))
+    {
+      printf("Unable to read golden image %s\n", golden.c_str());
+      r.passed = false;
+    }
+    else
+    {
+      r.psnr = internal::psnr(image.buffer(), reference);
+      r.ssim = internal::ssim(image.buffer(), reference);
+      r.passed = r.psnr >= _minPSNR && r.ssim >= _minSSIM;
+    }
+  }
+  printf("%s: %s (PSNR %.2f dB, SSIM %.4f, %.0f rays/s, BVH %.4f s)\n",
+    r.scene.c_str(),
+    r.passed ? "passed" : "FAILED",
+    r.psnr,
+    r.ssim,
+    r.raysPerSecond,
+    r.bvhTime);
+  _results.push_back(r);
+  return r.passed;
+}
+
+bool
+Harness::writeResults() const
+{
+  auto file = fopen(_resultsFile.c_str(), "w");
+
+  if (file == nullptr)
+    return false;
+  fprintf(file, "{\n  \"width\": %d,\n  \"height\": %d,\n", _W, _H);
+  fprintf(file,
+    "  \"layout\": \"%s\",\n",
+    internal::layoutNames[int(_layout)]);
+  fprintf(file, "  \"results\": [\n");
+  for (size_t i = 0; i < _results.size(); ++i)
+  {
+    const auto& r = _results[i];
+
+    fprintf(file,
+      "    {\"scene\": \"%s\", \"passed\": %s, \"psnr\": %.4f, "
+      "\"ssim\": %.6f, \"raysPerSecond\": %.1f, \"bvhBuildTime\": %.6f, "
+      "\"renderTime\": %.6f, \"peakMemoryGrowth\": %zu}%s\n",
+      r.scene.c_str(),
+      r.passed ? "true" : "false",
+      r.psnr,
+      r.ssim,
+      r.raysPerSecond,
+      r.bvhTime,
+      r.renderTime,
+      r.peakMemoryGrowth,
+      i + 1 < _results.size() ? "," : "");
+  }
+  fprintf(file, "  ]\n}\n");
+  return fclose(file) == 0;
+}
+
+bool
+Harness::compare() const
+{
+  auto file = fopen(_compareFile.c_str(), "r");
+
+  if (file == nullptr)
+  {
+    printf("Unable to read results file %s\n", _compareFile.c_str());
+    return false;
+  }
+
+  struct Prior
+  {
+    double raysPerSecond;
+    double bvhTime;
+    double peakMemoryGrowth;
+  };
+
+  std::map<std::string, Prior> priors;
+  char line[1024];
+
+  while (fgets(line, sizeof line, file))
+  {
+    auto s = strstr(line, "\"scene\": \"");
+
+    if (s == nullptr)
+      continue;
+    s += 10;
+
+    auto e = strchr(s, '"');
+    Prior p{};
+
+    if (e != nullptr &&
+      internal::readNumber(e, "\"raysPerSecond\":", p.raysPerSecond) &&
+      internal::readNumber(e, "\"bvhBuildTime\":", p.bvhTime) &&
+      internal::readNumber(e, "\"peakMemoryGrowth\":", p.peakMemoryGrowth))
+      priors[std::string{s, e}] = p;
+  }
+  fclose(file);
+
+  // Times below the clock resolution and memory growths below a few
+  // pages are not compared
+  constexpr double minTime = 0.01;
+  constexpr size_t minMemory = 1 << 20;
+  auto ok = true;
+
+  for (const auto& r : _results)
+  {
+    auto pit = priors.find(r.scene);
+
+    if (pit == priors.end())
+      continue;
+
+    const auto& p = pit->second;
+
+    if (r.raysPerSecond < p.raysPerSecond * (1 - _tolerance) &&
+      r.renderTime > minTime)
+    {
+      printf("REGRESSION %s: %.0f -> %.0f rays/s\n",
+        r.scene.c_str(),
+        p.raysPerSecond,
+        r.raysPerSecond);
+      ok = false;
+    }
+    if (r.bvhTime > p.bvhTime * (1 + _tolerance) && r.bvhTime > minTime)
+    {
+      printf("REGRESSION %s: BVH build time %.4f -> %.4f s\n",
+        r.scene.c_str(),
+        p.bvhTime,
+        r.bvhTime);
+      ok = false;
+    }
+    if (r.peakMemoryGrowth > p.peakMemoryGrowth * (1 + _tolerance) &&
+      r.peakMemoryGrowth > minMemory)
+    {
+      printf("REGRESSION %s: peak memory growth %.0f -> %zu bytes\n",
+        r.scene.c_str(),
+        p.peakMemoryGrowth,
+        r.peakMemoryGrowth);
+      ok = false;
+    }
+  }
+  return ok;
+}
+
+int
+Harness::run(const char* program, int argc, char** argv)
+{
+  // The golden images are in the asset directory of the program
+  if (const auto slash = strrchr(program, PATH_SEP))
+    _goldenDir = std::string{program, slash} + "/assets/golden";
+  else
+    _goldenDir = "./assets/golden";
+  if (!parse(argc, argv))
+    return EXIT_FAILURE;
+
+  auto ok = true;
+
+  for (int i = 1; i <= numberOfScenePresets; ++i)
+    ok &= render(i);
+  if (!writeResults())
+  {
+    printf("Unable to write results file %s\n", _resultsFile.c_str());
+    ok = false;
+  }
+  if (!_compareFile.empty())
+    ok &= compare();
+  return ok ? EXIT_SUCCESS : EXIT_FAILURE;
+}
+
+} // end namespace cg
@@ -0,0 +1,132 @@
+//[]---------------------------------------------------------------[]
+//|                                                                 |
+//| Copyright (C) 2019 Orthrus Group.                               |
+//|                                                                 |
+//| This software is provided 'as-is', without any express or       |
+//| implied warranty. In no event will the authors be held liable   |
+//| for any damages arising from the use of this software.          |
+//|                                                                 |
+//| Permission is granted to anyone to use this software for any    |
+//| purpose, including commercial applications, and to alter it and |
+//| redistribute it freely, subject to the following restrictions:  |
+//|                                                                 |
+//| 1. The origin of this software must not be misrepresented; you  |
+//| must not claim that you wrote the original software. If you use |
+//| this software in a product, an acknowledgment in the product    |
+//| documentation would be appreciated but is not required.         |
+//|                                                                 |
+//| 2. Altered source versions must be plainly marked as such, and  |
+//| must not be misrepresented as being the original software.      |
+//|                                                                 |
+//| 3. This notice may not be removed or altered from any source    |
+//| distribution.                                                   |
+//|                                                                 |
+//[]---------------------------------------------------------------[]
+//
+// OVERVIEW: Harness.h
+// ========
+// Class definition for ray tracer regression harness.
+//
+// Author(s): Paulo Pagliosa (and your name)
+// Last revision: 19/10/2026
+
+#ifndef __Harness_h
+#define __Harness_h
+
+#include "RayTracer.h"
+#include <string>
+#include <vector>
+
+namespace cg
+{ // begin namespace cg
+
+
+/////////////////////////////////////////////////////////////////////
+//
+// Harness: ray tracer regression harness class
+// =======
+//
+// Renders the scene presets headlessly and compares each image with
+// a golden image by PSNR and SSIM. The golden images of the default
+// options are kept in p4/assets/golden; after a change that alters the
+// images on purpose, they are written again with
+//
+//   p4 --harness --update
+//
+// and committed along with the change. The ray rate, the BVH build time
+// and the growth of the peak memory of the process while building and
+// rendering each scene are written to a JSON results file, which can
+// be compared with the results file of a previous run to flag
+// performance regressions. Invoked as
+//
+//   p4 --harness [options]
+//
+// where the options are
+//
+//   --golden dir      directory of the golden images (assets/golden,
+//                     next to the program)
+//   --update          writes the golden images instead of comparing
+//   --results file    results file written (results.json)
+//   --compare file    results file to which the results are compared
+//   --size w h        image size (320 180)
+//   --samples b m     base and max samples per pixel (1 1)
+//   --denoise         denoises the images
+//   --aovs            fills all AOV buffers while rendering
+//   --layout l        accumulation buffer layout: row, tiled or
+//                     morton (row)
+//   --checkpoint d s  checkpoints to d/scene<i>.ckpt every s seconds
+//   --resume          resumes from the checkpoints
+//   --psnr db         min PSNR (40)
+//   --ssim s          min SSIM (0.98)
+//   --tolerance t     max relative performance loss (0.1)
+//
+class Harness
+{
+public:
+  /// \brief Runs the harness; returns the exit status of the program.
+  /// \c program is the path of the executable.
+  int run(const char* program, int argc, char** argv);
+
+private:
+  struct Result
+  {
+    std::string scene;
+    double psnr;
+    double ssim;
+    double raysPerSecond;
+    double bvhTime;
+    double renderTime;
+    size_t peakMemoryGrowth; // over the memory before the scene
+    bool passed;
+
+  }; // Result
+
+  std::string _goldenDir;
+  std::string _resultsFile{"results.json"};
+  std::string _compareFile;
+  bool _update{};
+  int _W{320};
+  int _H{180};
+  int _baseSamples{1};
+  int _maxSamples{1};
+  bool _denoising{};
+  bool _aovs{};
+  AccumulationBuffer::Layout _layout{};
+  std::string _checkpointDir;
+  float _checkpointInterval{60};
+  bool _resuming{};
+  double _minPSNR{40};
+  double _minSSIM{0.98};
+  double _tolerance{0.1};
+  std::vector<Result> _results;
+
+  bool parse(int argc, char** argv);
+  bool render(int index);
+  bool writeResults() const;
+  bool compare() const;
+
+}; // Harness
+
+} // end namespace cg
+
+#endif // __Harness_h
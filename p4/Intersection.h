@@ -28,12 +28,13 @@
 // Class definition for intersection ray/object.
 //
 // Author(s): Paulo Pagliosa (and your name)
-// Last revision: 21/11/2018
+// Last revision: 19/10/2026
 
 #ifndef __Intersection_h
 #define __Intersection_h
 
 #include "geometry/Ray.h"
+#include <cstdint>
 
 namespace cg
 { // begin namespace Graphics
@@ -49,13 +50,49 @@ class TriangleShape;
 struct Intersection
 {
   const Primitive* object; // object intercepted by the ray
-  int triangleIndex; // index of the triangle intercepted by the ray
+  int64_t triangleIndex; // index of the triangle intercepted by the ray
   float distance; // distance from the ray's origin to the intersection point
   vec3f p; // barycentric coordinates of the intersection point
   void* userData; // any user data
 
 }; // Intersection
 
+/// \brief Intersects a ray with the triangle (v0, v1, v2).
+/// On success, \c distance is the ray parameter of the hit point and
+/// (b1, b2) are the barycentric coordinates relative to v1 and v2.
+inline bool
+intersectTriangle(const Ray& ray,
+  const vec3f& v0,
+  const vec3f& v1,
+  const vec3f& v2,
+  float& distance,
+  float& b1,
+  float& b2)
+{
+  auto e1 = v1 - v0;
+  auto e2 = v2 - v0;
+  auto s1 = ray.direction.cross(e2);
+  auto s1e1 = s1.dot(e1);
+
+  if (s1e1 == 0)
+    return false;
+
+  auto invDivisor = math::inverse(s1e1);
+  auto s = ray.origin - v0;
+
+  b1 = s1.dot(s) * invDivisor;
+  if (b1 < 0 || b1 > 1)
+    return false;
+
+  auto s2 = s.cross(e1);
+
+  b2 = s2.dot(ray.direction) * invDivisor;
+  if (b2 < 0 || b1 + b2 > 1)
+    return false;
+  distance = s2.dot(e2) * invDivisor;
+  return distance >= 0;
+}
+
 } // end namespace cg
 
 #endif // __Intersection_h
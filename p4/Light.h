@@ -28,7 +28,7 @@
 // Class definition for light.
 //
 // Author(s): Paulo Pagliosa (and your name)
-// Last revision: 14/10/2019
+// Last revision: 19/10/2026
 
 #ifndef __Light_h
 #define __Light_h
@@ -47,6 +47,8 @@ namespace cg
     class Light : public Component
     {
     public:
+        DECLARE_POOL_ALLOCATED(Light);
+
         enum Type
         {
             Directional,
@@ -77,7 +79,10 @@ namespace cg
 
         void setType(Type type)
         {
-            _type = type;
+            if (type != _type) {
+                _type = type;
+                recordChange(SceneJournal::Event::Light);
+            }
         }
 
         void update() {
@@ -86,23 +91,23 @@ namespace cg
 
 
         //Directional Light
-        vec3f getWorldDirection() {
-            _worldRotation = transform()->rotation() * quatf::eulerAngles(_localEulerAngles);
-            vec3f worldDirection = _worldRotation * vec3f(0, 0, 1);
+        vec3f getWorldDirection() const {
+            auto worldRotation = transform()->rotation() * quatf::eulerAngles(_localEulerAngles);
+            vec3f worldDirection = worldRotation * vec3f(0, 0, 1);
             return worldDirection.normalize();
         }
 
         void setLocalEulerAngles(vec3f angles) {
             _localEulerAngles = angles;
-            _worldRotation = transform()->rotation() * quatf::eulerAngles(angles);
+            recordChange(SceneJournal::Event::Light);
         }
 
-        vec3f getLocalEulerAngles() {
+        vec3f getLocalEulerAngles() const {
             return _localEulerAngles;
         }
 
         //Point Light
-        float getFalloff() {
+        float getFalloff() const {
             return _falloff;
         }
 
@@ -114,28 +119,31 @@ namespace cg
                 falloff = 2;
             }
             _falloff = falloff;
+            recordChange(SceneJournal::Event::Light);
         }
 
         //Spot Light
-        float getSpotlightAngle() {
+        float getSpotlightAngle() const {
             return _spotlightAngle;
         }
 
-        float getSpotlightAngleRadians() {
+        float getSpotlightAngleRadians() const {
             return _spotlightAngleRadians;
         }
 
         void setSpotlightAngle(float angle) {
             _spotlightAngle = angle;
             _spotlightAngleRadians = angle * M_PI / 180;
+            recordChange(SceneJournal::Event::Light);
         }
 
-        float getRadialFalloff() {
+        float getRadialFalloff() const {
             return _radialFalloff;
         }
 
         void setRadialFalloff(float f) {
             _radialFalloff = f;
+            recordChange(SceneJournal::Event::Light);
         }
 
     private:
@@ -143,7 +151,6 @@ namespace cg
 
         //Directional Light
         vec3f _localEulerAngles = vec3f(0, 0, 0); //also used for spot light
-        quatf _worldRotation = quatf(0, 0, 0, 1);;
 
 
         //Point Light
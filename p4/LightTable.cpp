@@ -0,0 +1,236 @@
+//[]---------------------------------------------------------------[]
+//|                                                                 |
+//| Copyright (C) 2019 Orthrus Group.                               |
+//|                                                                 |
+//| This software is provided 'as-is', without any express or       |
+//| implied warranty. In no event will the authors be held liable   |
+//| for any damages arising from the use of this software.          |
+//|                                                                 |
+//| Permission is granted to anyone to use this software for any    |
+//| purpose, including commercial applications, and to alter it and |
+//| redistribute it freely, subject to the following restrictions:  |
+//|                                                                 |
+//| 1. The origin of this software must not be misrepresented; you  |
+//| must not claim that you wrote the original software. If you use |
+//| this software in a product, an acknowledgment in the product    |
+//| documentation would be appreciated but is not required.         |
+//|                                                                 |
+//| 2. Altered source versions must be plainly marked as such, and  |
+//| must not be misrepresented as being the original software.      |
+//|                                                                 |
+//| 3. This notice may not be removed or altered from any source    |
+//| distribution.                                                   |
+//|                                                                 |
+//[]---------------------------------------------------------------[]
+//
+// OVERVIEW: LightTable.cpp
+// ========
+// Source file for light table.
+//
+// Author(s): Paulo Pagliosa (and your name)
+// Last revision: 19/10/2026
+
+#include "LightTable.h"
+#include <cmath>
+#ifdef CG_SSE2
+#include <emmintrin.h>
+#endif // CG_SSE2
+
+namespace cg
+{ // begin namespace cg
+
+
+/////////////////////////////////////////////////////////////////////
+//
+// LightTable implementation
+// ==========
+std::array<std::vector<float>*, 10>
+LightTable::columns()
+{
+  return {&_px,
+    &_py,
+    &_pz,
+    &_pw,
+    &_dx,
+    &_dy,
+    &_dz,
+    &_falloff,
+    &_radialFalloff,
+    &_cosAngle};
+}
+
+void
+LightTable::build(Scene& scene)
+{
+  _size = 0;
+  _type.clear();
+  _color.clear();
+  for (auto column : columns())
+    column->clear();
+  collect(&scene);
+  // The padding lights are black points at infinity in no direction,
+  // which reach no point
+  while (_type.size() % 4 != 0)
+  {
+    _type.push_back(Light::Directional);
+    _color.push_back(Color::black);
+    for (auto column : columns())
+      column->push_back(0);
+  }
+}
+
+void
+LightTable::collect(SceneNode* node)
+{
+  auto it = node->objectIterator();
+
+  for (auto object = it->start(); object != nullptr; object = it->next())
+  {
+    if (auto light = dynamic_cast<Light*>(object->getComponent("Light")))
+      add(*light);
+    collect(object);
+  }
+  it->dispose();
+}
+
+void
+LightTable::add(const Light& light)
+{
+  auto type = light.type();
+  auto d = light.getWorldDirection();
+  auto directional = type == Light::Directional;
+  auto spot = type == Light::Spot;
+  auto p = directional ? -d : light.transform()->position();
+
+  _type.push_back(type);
+  _color.push_back(light.color);
+  _px.push_back(p.x);
+  _py.push_back(p.y);
+  _pz.push_back(p.z);
+  _pw.push_back(directional ? 0.0f : 1.0f);
+  _dx.push_back(d.x);
+  _dy.push_back(d.y);
+  _dz.push_back(d.z);
+  _falloff.push_back(directional ? 0 : light.getFalloff());
+  // Lights other than spots have no cone, i.e., its cosine is below -1
+  _radialFalloff.push_back(spot ? light.getRadialFalloff() : 0);
+  _cosAngle.push_back(spot ? cos(light.getSpotlightAngleRadians()) : -2);
+  ++_size;
+}
+
+int
+LightTable::illuminate(const vec3f& P,
+  const vec3f& N,
+  Incidence& incidence) const
+{
+  auto n = paddedSize();
+  auto& c = incidence;
+
+  if (int(c.x.size()) < n)
+  {
+    c.x.resize(n);
+    c.y.resize(n);
+    c.z.resize(n);
+    c.distance.resize(n);
+    c.cosine.resize(n);
+    c.spot.resize(n);
+  }
+
+  const auto inf = math::Limits<float>::inf();
+  int lit = 0;
+  int k = 0;
+
+#ifdef CG_SSE2
+  const auto zero = _mm_setzero_ps();
+  const auto one = _mm_set1_ps(1);
+  const auto infinity = _mm_set1_ps(inf);
+  const auto Px = _mm_set1_ps(P.x);
+  const auto Py = _mm_set1_ps(P.y);
+  const auto Pz = _mm_set1_ps(P.z);
+  const auto Nx = _mm_set1_ps(N.x);
+  const auto Ny = _mm_set1_ps(N.y);
+  const auto Nz = _mm_set1_ps(N.z);
+
+  for (; k + 4 <= n; k += 4)
+  {
+    auto w = _mm_loadu_ps(&_pw[k]);
+    auto x = _mm_sub_ps(_mm_loadu_ps(&_px[k]), _mm_mul_ps(w, Px));
+    auto y = _mm_sub_ps(_mm_loadu_ps(&_py[k]), _mm_mul_ps(w, Py));
+    auto z = _mm_sub_ps(_mm_loadu_ps(&_pz[k]), _mm_mul_ps(w, Pz));
+    auto d = _mm_sqrt_ps(_mm_add_ps(_mm_add_ps(_mm_mul_ps(x, x),
+      _mm_mul_ps(y, y)),
+      _mm_mul_ps(z, z)));
+    // Vectors of null length (padding) are kept null
+    auto s = _mm_and_ps(_mm_cmpgt_ps(d, zero), _mm_div_ps(one, d));
+
+    x = _mm_mul_ps(x, s);
+    y = _mm_mul_ps(y, s);
+    z = _mm_mul_ps(z, s);
+
+    auto cosine = _mm_add_ps(_mm_add_ps(_mm_mul_ps(Nx, x), _mm_mul_ps(Ny, y)),
+      _mm_mul_ps(Nz, z));
+    auto spot = _mm_sub_ps(zero,
+      _mm_add_ps(_mm_add_ps(_mm_mul_ps(_mm_loadu_ps(&_dx[k]), x),
+      _mm_mul_ps(_mm_loadu_ps(&_dy[k]), y)),
+      _mm_mul_ps(_mm_loadu_ps(&_dz[k]), z)));
+    auto reaches = _mm_and_ps(_mm_cmpgt_ps(cosine, zero),
+      _mm_cmpge_ps(spot, _mm_loadu_ps(&_cosAngle[k])));
+    auto positional = _mm_cmpgt_ps(w, zero);
+
+    _mm_storeu_ps(&c.x[k], x);
+    _mm_storeu_ps(&c.y[k], y);
+    _mm_storeu_ps(&c.z[k], z);
+    _mm_storeu_ps(&c.distance[k], _mm_or_ps(_mm_and_ps(positional, d),
+      _mm_andnot_ps(positional, infinity)));
+    _mm_storeu_ps(&c.cosine[k], _mm_and_ps(reaches, cosine));
+    _mm_storeu_ps(&c.spot[k], spot);
+
+    auto m = _mm_movemask_ps(reaches);
+
+    lit += (m & 1) + (m >> 1 & 1) + (m >> 2 & 1) + (m >> 3);
+  }
+#endif // CG_SSE2
+  for (; k < n; k++)
+  {
+    auto w = _pw[k];
+    vec3f L{_px[k] - w * P.x, _py[k] - w * P.y, _pz[k] - w * P.z};
+    auto d = L.length();
+
+    if (d > 0)
+      L *= math::inverse(d);
+
+    auto cosine = N.dot(L);
+    auto spot = -(_dx[k] * L.x + _dy[k] * L.y + _dz[k] * L.z);
+    auto reaches = cosine > 0 && spot >= _cosAngle[k];
+
+    c.x[k] = L.x;
+    c.y[k] = L.y;
+    c.z[k] = L.z;
+    c.distance[k] = w > 0 ? d : inf;
+    c.cosine[k] = reaches ? cosine : 0;
+    c.spot[k] = spot;
+    lit += reaches;
+  }
+  return lit;
+}
+
+Color
+LightTable::intensity(int i, const Incidence& incidence) const
+{
+  auto color = _color[i];
+  auto f = _falloff[i];
+  auto d = incidence.distance[i];
+
+  // Falloff exponents are usually 0 (no attenuation), 1 or 2
+  if (f == 1)
+    color *= math::inverse(d);
+  else if (f == 2)
+    color *= math::inverse(d * d);
+  else if (f != 0)
+    color *= pow(d, -f);
+  if ((f = _radialFalloff[i]) != 0)
+    color *= pow(incidence.spot[i], f);
+  return color;
+}
+
+} // end namespace cg
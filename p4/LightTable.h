@@ -0,0 +1,126 @@
+//[]---------------------------------------------------------------[]
+//|                                                                 |
+//| Copyright (C) 2019 Orthrus Group.                               |
+//|                                                                 |
+//| This software is provided 'as-is', without any express or       |
+//| implied warranty. In no event will the authors be held liable   |
+//| for any damages arising from the use of this software.          |
+//|                                                                 |
+//| Permission is granted to anyone to use this software for any    |
+//| purpose, including commercial applications, and to alter it and |
+//| redistribute it freely, subject to the following restrictions:  |
+//|                                                                 |
+//| 1. The origin of this software must not be misrepresented; you  |
+//| must not claim that you wrote the original software. If you use |
+//| this software in a product, an acknowledgment in the product    |
+//| documentation would be appreciated but is not required.         |
+//|                                                                 |
+//| 2. Altered source versions must be plainly marked as such, and  |
+//| must not be misrepresented as being the original software.      |
+//|                                                                 |
+//| 3. This notice may not be removed or altered from any source    |
+//| distribution.                                                   |
+//|                                                                 |
+//[]---------------------------------------------------------------[]
+//
+// OVERVIEW: LightTable.h
+// ========
+// Class definition for light table.
+//
+// Author(s): Paulo Pagliosa (and your name)
+// Last revision: 19/10/2026
+
+#ifndef __LightTable_h
+#define __LightTable_h
+
+#include "Scene.h"
+#include "Light.h"
+#include <array>
+#include <vector>
+
+namespace cg
+{ // begin namespace cg
+
+
+/////////////////////////////////////////////////////////////////////
+//
+// LightTable: light table class
+// ==========
+//
+// Parameters of the lights of a scene, in world space, gathered once
+// per image, such that shading neither walks the scene nor computes
+// light rotations. Each parameter is stored in its own array (SoA),
+// padded to a multiple of four lights, and the incidence of the
+// lights at a point is evaluated four lights at a time. Positions are
+// homogeneous: directional lights are points at infinity, in the
+// opposite direction of the light.
+//
+class LightTable
+{
+public:
+  /// Incidence of the lights at a point.
+  struct Incidence
+  {
+    // Unit vectors from the point to the lights
+    std::vector<float> x;
+    std::vector<float> y;
+    std::vector<float> z;
+    // Distances to the lights (infinity for directional lights)
+    std::vector<float> distance;
+    // Cosines between the normal and the vectors to the lights, or 0
+    // if a light does not reach the point
+    std::vector<float> cosine;
+    // Cosines between the axes of the lights and the vectors from the
+    // lights to the point
+    std::vector<float> spot;
+
+  }; // Incidence
+
+  /// Gathers the lights of \c scene.
+  void build(Scene& scene);
+
+  /// Returns the number of lights (not including the padding).
+  auto size() const
+  {
+    return _size;
+  }
+
+  /// Returns the number of lights, including the padding.
+  auto paddedSize() const
+  {
+    return int(_type.size());
+  }
+
+  /// \brief Computes the incidence of the lights at point \c P with
+  /// unit normal \c N. Returns the number of lights reaching P, i.e.,
+  /// in front of it and, if spots, with P within their cones.
+  int illuminate(const vec3f& P, const vec3f& N, Incidence& incidence) const;
+
+  /// \brief Returns the color of light \c i attenuated by distance
+  /// and, if a spot, by angle, given its incidence at a point.
+  Color intensity(int i, const Incidence& incidence) const;
+
+private:
+  int _size{};
+  std::vector<Light::Type> _type;
+  std::vector<Color> _color;
+  std::vector<float> _px;
+  std::vector<float> _py;
+  std::vector<float> _pz;
+  std::vector<float> _pw;
+  std::vector<float> _dx;
+  std::vector<float> _dy;
+  std::vector<float> _dz;
+  std::vector<float> _falloff;
+  std::vector<float> _radialFalloff;
+  std::vector<float> _cosAngle;
+
+  std::array<std::vector<float>*, 10> columns();
+  void collect(SceneNode* node);
+  void add(const Light& light);
+
+}; // LightTable
+
+} // end namespace cg
+
+#endif // __LightTable_h
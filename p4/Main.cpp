@@ -1,7 +1,45 @@
+#include "Harness.h"
 #include "P4.h"
+#include "StreamingMesh.h"
+#include <cstdlib>
+#include <cstring>
+
+//
+// p4 --build-streaming file [--triangles n] mesh... builds a streaming
+// mesh file from mesh files, with at most n triangles per chunk. Files
+// put in the meshes directory of the assets are listed by P4.
+//
+static int
+buildStreamingMesh(int argc, char** argv)
+{
+  int trianglesPerChunk = 1 << 16;
+  std::vector<std::string> meshFiles;
+
+  for (int i = 1; i < argc; ++i)
+    if (strcmp(argv[i], "--triangles") == 0 && i + 1 < argc)
+      trianglesPerChunk = atoi(argv[++i]);
+    else
+      meshFiles.push_back(argv[i]);
+  if (argc < 1 || meshFiles.empty() || trianglesPerChunk <= 0)
+  {
+    puts("Usage: p4 --build-streaming file [--triangles n] mesh...");
+    return EXIT_FAILURE;
+  }
+  if (!cg::StreamingMesh::build(argv[0], meshFiles, trianglesPerChunk))
+  {
+    printf("Unable to build streaming mesh file %s\n", argv[0]);
+    return EXIT_FAILURE;
+  }
+  return EXIT_SUCCESS;
+}
 
 int
 main(int argc, char** argv)
 {
+  // p4 --harness [options] renders the scene presets without a window
+  if (argc > 1 && strcmp(argv[1], "--harness") == 0)
+    return cg::Harness{}.run(argv[0], argc - 2, argv + 2);
+  if (argc > 1 && strcmp(argv[1], "--build-streaming") == 0)
+    return buildStreamingMesh(argc - 2, argv + 2);
   return cg::Application{new P4{1280, 720}}.run(argc, argv);
 }
@@ -0,0 +1,151 @@
+//[]---------------------------------------------------------------[]
+//|                                                                 |
+//| Copyright (C) 2019 Orthrus Group.                               |
+//|                                                                 |
+//| This software is provided 'as-is', without any express or       |
+//| implied warranty. In no event will the authors be held liable   |
+//| for any damages arising from the use of this software.          |
+//|                                                                 |
+//| Permission is granted to anyone to use this software for any    |
+//| purpose, including commercial applications, and to alter it and |
+//| redistribute it freely, subject to the following restrictions:  |
+//|                                                                 |
+//| 1. The origin of this software must not be misrepresented; you  |
+//| must not claim that you wrote the original software. If you use |
+//| this software in a product, an acknowledgment in the product    |
+//| documentation would be appreciated but is not required.         |
+//|                                                                 |
+//| 2. Altered source versions must be plainly marked as such, and  |
+//| must not be misrepresented as being the original software.      |
+//|                                                                 |
+//| 3. This notice may not be removed or altered from any source    |
+//| distribution.                                                   |
+//|                                                                 |
+//[]---------------------------------------------------------------[]
+//
+// OVERVIEW: MeshLOD.cpp
+// ========
+// Source file for mesh LOD chain.
+//
+// Author(s): Paulo Pagliosa (and your name)
+// Last revision: 19/10/2026
+
+#include "MeshLOD.h"
+#include "geometry/MeshSimplifier.h"
+#include <cmath>
+
+namespace cg
+{ // begin namespace cg
+
+
+/////////////////////////////////////////////////////////////////////
+//
+// MeshLOD implementation
+// =======
+MeshLOD::Settings MeshLOD::settings;
+
+MeshLOD::MeshLOD(TriangleMesh& mesh)
+{
+  _levels.push_back(&mesh);
+  for (int i = 1; i < settings.levels; ++i)
+  {
+    auto nt = _levels.back()->data().numberOfTriangles;
+    auto target = int(nt * settings.ratio);
+
+    if (target < settings.minTriangles)
+      break;
+
+    Reference<TriangleMesh> level = MeshSimplifier::simplify(*_levels.back(),
+      target);
+
+    // Stop if the simplifier got stuck far from the target
+    if (level->data().numberOfTriangles > (nt + target) / 2)
+      break;
+    _levels.push_back(level);
+  }
+}
+
+inline float
+MeshLOD::threshold(int level) const
+{
+  return settings.screenSize * std::pow(settings.ratio, (level - 1) * 0.5f);
+}
+
+int
+MeshLOD::select(float screenSize, int current) const
+{
+  auto level = std::min(std::max(current, 0), levelCount() - 1);
+  auto h = settings.hysteresis;
+
+  while (level > 0 && screenSize > threshold(level) * (1 + h))
+    --level;
+  while (level < levelCount() - 1
+    && screenSize < threshold(level + 1) * (1 - h))
+    ++level;
+  return level;
+}
+
+
+/////////////////////////////////////////////////////////////////////
+//
+// LODCache implementation
+// ========
+LODCache::LODMap LODCache::_lods;
+std::mutex LODCache::_lock;
+uint32_t LODCache::_generation;
+
+MeshLOD*
+LODCache::get(TriangleMesh* mesh)
+{
+  if (mesh == nullptr)
+    return nullptr;
+
+  uint32_t generation;
+
+  {
+    std::lock_guard<std::mutex> lock{_lock};
+
+    if (auto lod = _lods.find(mesh); lod != _lods.end())
+      return lod->second;
+    generation = _generation;
+  }
+
+  // The chain is built unlocked (see BVHCache::get())
+  Reference<MeshLOD> lod = new MeshLOD{*mesh};
+  std::lock_guard<std::mutex> lock{_lock};
+
+  if (generation != _generation)
+    return nullptr;
+
+  auto& cached = _lods[mesh];
+
+  if (cached == nullptr)
+    cached = lod;
+  return cached;
+}
+
+MeshLOD*
+LODCache::find(TriangleMesh* mesh)
+{
+  std::lock_guard<std::mutex> lock{_lock};
+  auto lod = _lods.find(mesh);
+
+  return lod != _lods.end() ? lod->second : nullptr;
+}
+
+void
+LODCache::remove(TriangleMesh* mesh)
+{
+  std::lock_guard<std::mutex> lock{_lock};
+  _lods.erase(mesh);
+}
+
+void
+LODCache::clear()
+{
+  std::lock_guard<std::mutex> lock{_lock};
+  _lods.clear();
+  ++_generation;
+}
+
+} // end namespace cg
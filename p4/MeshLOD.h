@@ -0,0 +1,139 @@
+//[]---------------------------------------------------------------[]
+//|                                                                 |
+//| Copyright (C) 2019 Orthrus Group.                               |
+//|                                                                 |
+//| This software is provided 'as-is', without any express or       |
+//| implied warranty. In no event will the authors be held liable   |
+//| for any damages arising from the use of this software.          |
+//|                                                                 |
+//| Permission is granted to anyone to use this software for any    |
+//| purpose, including commercial applications, and to alter it and |
+//| redistribute it freely, subject to the following restrictions:  |
+//|                                                                 |
+//| 1. The origin of this software must not be misrepresented; you  |
+//| must not claim that you wrote the original software. If you use |
+//| this software in a product, an acknowledgment in the product    |
+//| documentation would be appreciated but is not required.         |
+//|                                                                 |
+//| 2. Altered source versions must be plainly marked as such, and  |
+//| must not be misrepresented as being the original software.      |
+//|                                                                 |
+//| 3. This notice may not be removed or altered from any source    |
+//| distribution.                                                   |
+//|                                                                 |
+//[]---------------------------------------------------------------[]
+//
+// OVERVIEW: MeshLOD.h
+// ========
+// Class definition for mesh LOD chain.
+//
+// Author(s): Paulo Pagliosa (and your name)
+// Last revision: 19/10/2026
+
+#ifndef __MeshLOD_h
+#define __MeshLOD_h
+
+#include "geometry/TriangleMesh.h"
+#include <map>
+#include <mutex>
+#include <vector>
+
+namespace cg
+{ // begin namespace cg
+
+
+/////////////////////////////////////////////////////////////////////
+//
+// MeshLOD: mesh LOD chain class
+// =======
+//
+// Level 0 is the mesh itself; each further level is simplified from
+// the previous one (see MeshSimplifier) to settings.ratio of its
+// triangles. The chain ends at settings.levels levels, or earlier
+// when a level would have fewer than settings.minTriangles triangles.
+//
+// A level is selected by the screen size of the mesh, i.e., the
+// fraction of the viewport height covered by its bounding sphere.
+// Since the triangle count halves with the covered area when ratio is
+// 0.5, level i (i > 0) is selected below the screen size
+// settings.screenSize * sqrt(ratio)^(i - 1). Transitions must cross
+// a threshold by settings.hysteresis (relative to it), so that objects
+// near a threshold do not pop between levels every frame.
+//
+class MeshLOD: public SharedObject
+{
+public:
+  struct Settings
+  {
+    int levels{4};
+    float ratio{0.5f};
+    int minTriangles{256};
+    float screenSize{0.5f};
+    float hysteresis{0.15f};
+
+  }; // Settings
+
+  static Settings settings;
+
+  /// Constructs the LOD chain of \c mesh.
+  MeshLOD(TriangleMesh& mesh);
+
+  auto levelCount() const
+  {
+    return int(_levels.size());
+  }
+
+  TriangleMesh* level(int i) const
+  {
+    return _levels[i];
+  }
+
+  /// \brief Returns the level to draw at \c screenSize given the
+  /// level drawn in the last frame.
+  int select(float screenSize, int current) const;
+
+private:
+  std::vector<Reference<TriangleMesh>> _levels;
+
+  float threshold(int level) const;
+
+}; // MeshLOD
+
+
+/////////////////////////////////////////////////////////////////////
+//
+// LODCache: per-mesh LOD chain cache class
+// ========
+//
+// The cache is thread-safe (see BVHCache). Chains are built by the
+// loader threads (see Assets::buildLOD()); the render thread only
+// finds them.
+//
+class LODCache
+{
+public:
+  /// \brief Returns the LOD chain of \c mesh, building it on first
+  /// use. A chain whose build overlaps a call to clear() is built with
+  /// stale settings, so it is not cached and null is returned.
+  static MeshLOD* get(TriangleMesh* mesh);
+
+  /// Returns the LOD chain of \c mesh, or null if it was not built.
+  static MeshLOD* find(TriangleMesh* mesh);
+
+  /// Discards the LOD chain of \c mesh, if any.
+  static void remove(TriangleMesh* mesh);
+
+  static void clear();
+
+private:
+  using LODMap = std::map<TriangleMesh*, Reference<MeshLOD>>;
+
+  static LODMap _lods;
+  static std::mutex _lock;
+  static uint32_t _generation; // incremented by clear()
+
+}; // LODCache
+
+} // end namespace cg
+
+#endif // __MeshLOD_h
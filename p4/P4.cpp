@@ -1,5 +1,7 @@
 #include "geometry/MeshSweeper.h"
 #include "P4.h"
+#include "MeshLOD.h"
+#include "ScenePresets.h"
 
 MeshMap P4::_defaultMeshes;
 
@@ -49,134 +51,16 @@ P4::buildDefaultMeshes()
   _defaultMeshes["Sphere"] = GLGraphics3::sphere();
 }
 
-inline Primitive*
-makePrimitive(MeshMapIterator mit)
-{
-  return new Primitive(mit->second, mit->first);
-}
-
 inline void
 P4::buildScene(int index)
 {
+  SceneObject* camera{};
 
-    if (index == 1) {
-        _current = _scene = new Scene{ "Room" };
-        _editor = new SceneEditor{ *_scene };
-        _editor->setDefaultView((float)width() / (float)height());
-
-        //makes room
-        SceneObject* room = new SceneObject("Room", _scene);
-
-        SceneObject* floor = new SceneObject("Floor", room);
-        floor->addComponent(makePrimitive(_defaultMeshes.find("Box")));
-        Primitive* prim = dynamic_cast<Primitive*>(floor->getComponent("Primitive"));
-        prim->material.diffuse = Color::darkGray;
-        prim->material.spot = Color::white;
-        floor->transform()->setLocalPosition(vec3f(0, -1.3, 0));
-        floor->transform()->setLocalScale(vec3f(4, 0.2, 4));
-
-        SceneObject* wall1 = new SceneObject("Wall 1", room);
-        wall1->addComponent(makePrimitive(_defaultMeshes.find("Box")));
-        prim = dynamic_cast<Primitive*>(wall1->getComponent("Primitive"));
-        prim->material.diffuse = Color::white;
-        prim->material.spot = Color::blue;
-        wall1->transform()->setLocalPosition(vec3f(-3.9, 2.6, 0));
-        wall1->transform()->setLocalScale(vec3f(0.2, 4, 4));
-
-        SceneObject* wall2 = new SceneObject("Wall 2", room);
-        wall2->addComponent(makePrimitive(_defaultMeshes.find("Box")));
-        prim = dynamic_cast<Primitive*>(wall2->getComponent("Primitive"));
-        prim->material.diffuse = Color::white;
-        prim->material.spot = Color::red;
-        prim->material.shine = 2;
-        wall2->transform()->setLocalPosition(vec3f(0, 2.6, -4));
-        wall2->transform()->setLocalScale(vec3f(4, 4, 0.2));
-
-
-        //place ball, camera and lights
-        SceneObject* rootObject1 = new SceneObject("Object 1", _scene);
-        rootObject1->addComponent(makePrimitive(_defaultMeshes.find("Sphere")));
-        prim = dynamic_cast<Primitive*>(rootObject1->getComponent("Primitive"));
-        prim->material.diffuse = Color::red;
-        prim->material.spot = Color::white;
-
-        SceneObject* mainCamera = new SceneObject("Main Camera", _scene);
-        mainCamera->addComponent(new Camera);
-        mainCamera->transform()->setLocalPosition(vec3f(0, 2, 4));
-        mainCamera->transform()->setLocalEulerAngles(vec3f(-27, 0, 0));
-
-        SceneObject* pointLight = new SceneObject("Point Light", _scene);
-        Light* light = new Light();
-        light->setType(Light::Point);
-        light->setFalloff(0.5);
-        pointLight->addComponent(light);
-        pointLight->transform()->setLocalPosition(vec3f(1, 2.7, 4.4));
-        pointLight->transform()->setLocalEulerAngles(vec3f(-150, 0, 0));
-        _current = mainCamera;
-    }
-    else if (index == 2) {
-        _current = _scene = new Scene{ "Balls" };
-        _editor = new SceneEditor{ *_scene };
-        _editor->setDefaultView((float)width() / (float)height());
-
-        SceneObject* ball1 = new SceneObject("Ball 1", _scene);
-        ball1->transform()->setLocalPosition(vec3f(-1, 0, -1));
-        ball1->addComponent(makePrimitive(_defaultMeshes.find("Sphere")));
-        Primitive* prim = dynamic_cast<Primitive*>(ball1->getComponent("Primitive"));
-        prim->material.diffuse = Color::red;
-        prim->material.spot = Color::white;
-
-        SceneObject* ball2 = new SceneObject("Ball 2", _scene);
-        ball2->transform()->setLocalPosition(vec3f(2, 0, 0));
-        ball2->addComponent(makePrimitive(_defaultMeshes.find("Sphere")));
-        prim = dynamic_cast<Primitive*>(ball2->getComponent("Primitive"));
-        prim->material.diffuse = Color::green;
-        prim->material.spot = Color::white;
-
-        SceneObject* ball3 = new SceneObject("Ball 3", _scene);
-        ball3->transform()->setLocalPosition(vec3f(0, 0, 2));
-        ball3->addComponent(makePrimitive(_defaultMeshes.find("Sphere")));
-        prim = dynamic_cast<Primitive*>(ball3->getComponent("Primitive"));
-        prim->material.diffuse = Color::blue;
-        prim->material.spot = Color::white;
-
-        SceneObject* mainCamera = new SceneObject("Main Camera", _scene);
-        mainCamera->addComponent(new Camera);
-        mainCamera->transform()->setLocalPosition(vec3f(0, 2, 4));
-        mainCamera->transform()->setLocalEulerAngles(vec3f(-27, 0, 0));
-
-        SceneObject* pointLight = new SceneObject("Point Light", _scene);
-        Light* light = new Light();
-        light->setType(Light::Point);
-        pointLight->addComponent(light);
-        pointLight->transform()->setLocalPosition(vec3f(0, 2.7, 4.4));
-        pointLight->transform()->setLocalEulerAngles(vec3f(-150, 0, 0));
-        _current = mainCamera;
-    }
-    else if (index == 3) {
-        _current = _scene = new Scene{ "Scene 3" };
-        _editor = new SceneEditor{ *_scene };
-        _editor->setDefaultView((float)width() / (float)height());
-
-        SceneObject* rootObject1 = new SceneObject("Object 1", _scene);
-        rootObject1->addComponent(makePrimitive(_defaultMeshes.find("Sphere")));
-        Primitive* prim = dynamic_cast<Primitive*>(rootObject1->getComponent("Primitive"));
-        prim->material.diffuse = Color::red;
-        prim->material.spot = Color::white;
-
-        SceneObject* mainCamera = new SceneObject("Main Camera", _scene);
-        mainCamera->addComponent(new Camera);
-        mainCamera->transform()->setLocalPosition(vec3f(0, 2, 4));
-        mainCamera->transform()->setLocalEulerAngles(vec3f(-27, 0, 0));
-
-        SceneObject* pointLight = new SceneObject("Point Light", _scene);
-        Light* light = new Light();
-        light->setType(Light::Point);
-        pointLight->addComponent(light);
-        pointLight->transform()->setLocalPosition(vec3f(0, 2.7, 4.4));
-        pointLight->transform()->setLocalEulerAngles(vec3f(-150, 0, 0));
-        _current = mainCamera;
-    }
+  _scene = makeScenePreset(index, _defaultMeshes, camera);
+  _editor = new SceneEditor{*_scene};
+  _editor->setDefaultView((float)width() / (float)height());
+  _current = camera;
+  _sceneBVH = new SceneBVH{*_scene};
 }
 
 void
@@ -229,6 +113,7 @@ P4::initialize()
 
   _transformLoc = _program.uniformLocation("transform");
   _normalMatrixLoc = _program.uniformLocation("normalMatrix");
+  _decodeLocs.locate(_program);
 
   _vpMatrixLoc = _program.uniformLocation("vpMatrix");
   _cameraPositionLoc = _program.uniformLocation("cameraPosition");
@@ -322,9 +207,9 @@ P4::hierarchyWindow()
     _current = _scene;
   if (ImGui::BeginDragDropTarget()) {
       if (auto payload = ImGui::AcceptDragDropPayload("SceneObject")) {
-          SceneObject** payloadObj = (SceneObject**)payload->Data;
-          if (payloadObj)
-              (*payloadObj)->setParent(nullptr);
+          auto h = *(const SceneObject::Handle*)payload->Data;
+          if (auto payloadObj = SceneObject::get(h))
+              payloadObj->setParent(nullptr);
       }
       ImGui::EndDragDropTarget();
   }
@@ -358,15 +243,16 @@ void P4::openNodeHyerarchy(SceneNode* node) {
         //begin parent change
         if (ImGui::BeginDragDropSource()) {
 
-            ImGui::SetDragDropPayload("SceneObject", &object, sizeof(SceneObject*));
+            auto h = object->handle();
+            ImGui::SetDragDropPayload("SceneObject", &h, sizeof(h));
             ImGui::EndDragDropSource();
         }
 
         if (ImGui::BeginDragDropTarget()) {
             if (auto payload = ImGui::AcceptDragDropPayload("SceneObject")) {
-                SceneObject** payloadObj = (SceneObject**)payload->Data;
-                if (payloadObj)
-                    (*payloadObj)->setParent(object);
+                auto h = *(const SceneObject::Handle*)payload->Data;
+                if (auto payloadObj = SceneObject::get(h))
+                    payloadObj->setParent(object);
             }
             ImGui::EndDragDropTarget();
         }
@@ -460,7 +346,7 @@ P4::inspectShape(Primitive& primitive)
     if (auto* payload = ImGui::AcceptDragDropPayload("PrimitiveMesh"))
     {
       auto mit = *(MeshMapIterator*)payload->Data;
-      primitive.setMesh(mit->second, mit->first);
+      primitive.setMesh(Assets::loadMesh(mit), mit->first);
     }
     ImGui::EndDragDropTarget();
   }
@@ -478,6 +364,16 @@ P4::inspectShape(Primitive& primitive)
           primitive.setMesh(Assets::loadMesh(mit), mit->first);
       ImGui::Separator();
     }
+
+    auto& streamingMeshes = Assets::streamingMeshes();
+
+    if (!streamingMeshes.empty())
+    {
+      for (auto sit = streamingMeshes.begin(); sit != streamingMeshes.end(); ++sit)
+        if (ImGui::Selectable(sit->first.c_str()))
+          primitive.setStreamingMesh(Assets::loadStreamingMesh(sit), sit->first);
+      ImGui::Separator();
+    }
     for (auto mit = _defaultMeshes.begin(); mit != _defaultMeshes.end(); ++mit)
       if (ImGui::Selectable(mit->first.c_str()))
         primitive.setMesh(mit->second, mit->first);
@@ -485,14 +381,16 @@ P4::inspectShape(Primitive& primitive)
   }
 }
 
-inline void
+inline bool
 P4::inspectMaterial(Material& material)
 {
-  ImGui::ColorEdit3("Ambient", material.ambient);
-  ImGui::ColorEdit3("Diffuse", material.diffuse);
-  ImGui::ColorEdit3("Spot", material.spot);
-  ImGui::DragFloat("Shine", &material.shine, 1, 0, 1000.0f);
-  ImGui::ColorEdit3("Specular", material.specular);
+  auto edited = ImGui::ColorEdit3("Ambient", material.ambient);
+
+  edited |= ImGui::ColorEdit3("Diffuse", material.diffuse);
+  edited |= ImGui::ColorEdit3("Spot", material.spot);
+  edited |= ImGui::DragFloat("Shine", &material.shine, 1, 0, 1000.0f);
+  edited |= ImGui::ColorEdit3("Specular", material.specular);
+  return edited;
 }
 
 inline void
@@ -503,7 +401,8 @@ P4::inspectPrimitive(Primitive& primitive)
   if (ImGui::TreeNodeEx("Shape", flag))
     inspectShape(primitive);
   if (ImGui::TreeNodeEx("Material", flag))
-    inspectMaterial(primitive.material);
+    if (inspectMaterial(primitive.material))
+      primitive.recordChange(SceneJournal::Event::Material);
 }
 
 inline void
@@ -526,7 +425,8 @@ P4::inspectLight(Light& light)
     ImGui::EndCombo();
   }
   light.setType(lt);
-  ImGui::ColorEdit3("Color", light.color);
+  if (ImGui::ColorEdit3("Color", light.color))
+    light.recordChange(SceneJournal::Event::Light);
 
   if (lt == 0) {
       //directional light
@@ -670,7 +570,8 @@ P4::sceneObjectGui()
   ImGui::Separator();
   ImGui::ObjectNameInput(object);
   ImGui::SameLine();
-  ImGui::Checkbox("###visible", &object->visible);
+  if (ImGui::Checkbox("###visible", &object->visible))
+    object->recordChange(SceneJournal::Event::Visibility);
   ImGui::Separator();
   if (ImGui::CollapsingHeader(object->transform()->typeName()))
     ImGui::TransformEdit(object->transform());
@@ -885,6 +786,102 @@ P4::showOptions()
   ImGui::PushItemWidth(ImGui::GetWindowWidth() * 0.6f);
   showStyleSelector("Color Theme##Selector");
   ImGui::ColorEdit3("Selected Wireframe", _selectedWireframeColor);
+
+  // Meshes are uploaded again in the new format when next drawn
+  auto format = int(GLMesh::defaultFormat);
+
+  if (ImGui::Combo("Mesh Vertices",
+    &format,
+    "Float\0Quantized (16-bit normals)\0Quantized (8-bit normals)\0\0"))
+    GLMesh::defaultFormat = GLMesh::Format(format);
+
+  // The LOD chains are rebuilt in background when next drawn
+  auto& lod = MeshLOD::settings;
+
+  if (ImGui::SliderInt("LOD Levels", &lod.levels, 1, 8))
+    LODCache::clear();
+  ImGui::SliderFloat("LOD Screen Size", &lod.screenSize, 0.05f, 2.0f);
+
+  // Memory budget of the loaded meshes, in MB
+  auto& budget = Assets::budget;
+  int mb[]{int(budget.cpu >> 20), int(budget.gpu >> 20), int(budget.bvh >> 20)};
+
+  if (ImGui::DragInt3("CPU/GPU/BVH Budget (MB)", mb, 16, 16, 65536))
+  {
+    budget.cpu = size_t(mb[0]) << 20;
+    budget.gpu = size_t(mb[1]) << 20;
+    budget.bvh = size_t(mb[2]) << 20;
+  }
+
+  const auto& used = Assets::memoryUsed();
+
+  ImGui::Text("Meshes: CPU %zu MB, GPU %zu MB, BVH %zu MB",
+    used.cpu >> 20,
+    used.gpu >> 20,
+    used.bvh >> 20);
+
+  int samples[]{_rayTracer->baseSamples(), _rayTracer->maxSamples()};
+  auto tolerance = _rayTracer->tolerance();
+  auto denoising = _rayTracer->denoising();
+
+  // Changing the sampling rate invalidates the ray traced image
+  if (ImGui::SliderInt2("Samples (base/max)", samples, 1, MAX_SAMPLES))
+  {
+    _rayTracer->setSamples(samples[0], samples[1]);
+    _image = nullptr;
+  }
+  if (ImGui::SliderFloat("Tolerance", &tolerance, 0.001f, 0.1f, "%.3f"))
+  {
+    _rayTracer->setTolerance(tolerance);
+    _image = nullptr;
+  }
+  if (ImGui::Checkbox("Denoise", &denoising))
+  {
+    _rayTracer->setDenoising(denoising);
+    _image = nullptr;
+  }
+
+  // The buffer layout changes only the render time, not the image
+  auto layout = int(_rayTracer->bufferLayout());
+
+  if (ImGui::Combo("Buffer Layout", &layout, "Row-major\0Tiled\0Morton\0\0"))
+    _rayTracer->setBufferLayout(AccumulationBuffer::Layout(layout));
+
+  // An empty region (w or h <= 0) stands for the whole image
+  const auto& region = _rayTracer->region();
+  int r[]{region.x, region.y, region.w, region.h};
+
+  if (ImGui::InputInt4("Region (x/y/w/h)", r))
+  {
+    _rayTracer->setRegion({r[0], r[1], r[2], r[3]});
+    _image = nullptr;
+  }
+
+  // The ray traced image is resolved again, not traced
+  auto& tm = _rayTracer->toneMapping();
+  auto op = int(tm.op);
+  auto changed = ImGui::SliderFloat("Exposure", &tm.exposure, -8, 8);
+
+  if (ImGui::Combo("Tone Mapping", &op, "Clamp\0Reinhard\0ACES\0\0"))
+  {
+    tm.op = ToneMapping::Operator(op);
+    changed = true;
+  }
+  changed |= ImGui::Checkbox("sRGB", &tm.sRGB);
+  if (changed && _image != nullptr)
+    _rayTracer->resolve(*_image);
+  // PPM, PFM or PNG file to which ray traced images are written
+  ImGui::InputText("Render Output", _renderOutput, sizeof _renderOutput);
+  // File to which the tiles finished are saved, e.g., to resume
+  // interrupted renders
+  ImGui::InputText("Render Checkpoint",
+    _renderCheckpoint,
+    sizeof _renderCheckpoint);
+
+  auto resuming = _rayTracer->resuming();
+
+  if (ImGui::Checkbox("Resume", &resuming))
+    _rayTracer->setResuming(resuming);
   ImGui::PopItemWidth();
 }
 
@@ -996,6 +993,7 @@ P4::drawPrimitive(Primitive& primitive)
   _program.setUniformVec4(_OdLoc, primitive.material.diffuse);
   _program.setUniformVec4(_OsLoc, primitive.material.spot);
   _program.setUniform(_nsLoc, primitive.material.shine);
+  m->setDecodeUniforms(_decodeLocs);
 
   m->bind();
   drawMesh(m, GL_FILL);
@@ -1141,6 +1139,7 @@ P4::renderScene()
     {
       _renderer->setCamera(camera);
       _renderer->setImageSize(width(), height());
+      _renderer->update();
       _renderer->render();
       return;
     }
@@ -1151,7 +1150,19 @@ P4::renderScene()
       _image = new GLImage{w, h};
       _rayTracer->setImageSize(w, h);
       _rayTracer->setCamera(camera);
+
+      // The image file is written while the image is rendered
+      Reference<ImageWriter> output;
+
+      if (*_renderOutput != 0)
+        if ((output = ImageWriter::open(_renderOutput, w, h)) == nullptr)
+          printf("Unable to create image file %s\n", _renderOutput);
+      _rayTracer->setOutput(output);
+      _rayTracer->setCheckpoint(_renderCheckpoint);
       _rayTracer->renderImage(*_image);
+      _rayTracer->setOutput(nullptr);
+      if (output != nullptr && !output->close())
+        printf("Unable to write image file %s\n", _renderOutput);
     }
     _image->draw(0, 0);
   }
@@ -1163,6 +1174,7 @@ constexpr auto ZOOM_SCALE = 1.01f;
 void
 P4::render()
 {
+    updateAssets();
     _program.use();
     if (_viewMode != ViewMode::Editor)
     {
@@ -1249,6 +1261,38 @@ P4::render()
     }
 }
 
+void
+P4::updateAssets()
+{
+  Assets::update([this](TriangleMesh* placeholder, TriangleMesh* mesh)
+    {
+      auto it = _scene->objectIterator();
+
+      for (auto obj = it->start(); obj; obj = it->next())
+        replaceMesh(obj, placeholder, mesh);
+      it->dispose();
+      // The ray traced image may show the placeholder
+      _image = nullptr;
+    });
+}
+
+void
+P4::replaceMesh(SceneObject* object,
+  TriangleMesh* placeholder,
+  TriangleMesh* mesh)
+{
+  auto primitive = dynamic_cast<Primitive*>(object->getComponent("Primitive"));
+
+  if (primitive != nullptr && primitive->mesh() == placeholder)
+    primitive->setMesh(mesh, primitive->meshName());
+
+  auto it = object->objectIterator();
+
+  for (auto child = it->start(); child; child = it->next())
+    replaceMesh(child, placeholder, mesh);
+  it->dispose();
+}
+
 void
 P4::recursiveRender(SceneObject* object) {
     //render this object's primitive
@@ -1325,6 +1369,7 @@ P4::deleteCurrentObject() {
             }
         }
 
+        sceneObject->recordChange(SceneJournal::Event::ObjectRemoved);
         if (sceneObject->parent()) {
             sceneObject->parent()->removeChildSceneObject(sceneObject);
         }
@@ -1354,7 +1399,6 @@ P4::mouseButtonInputEvent(int button, int actions, int mods)
 
   auto active = actions == GLFW_PRESS;
 
-  /*
   if (button == GLFW_MOUSE_BUTTON_LEFT)
   {
     if (active)
@@ -1362,29 +1406,15 @@ P4::mouseButtonInputEvent(int button, int actions, int mods)
       cursorPosition(_pivotX, _pivotY);
 
       const auto ray = makeRay(_pivotX, _pivotY);
-      auto minDistance = math::Limits<float>::inf();
-
-      // **Begin picking of temporary scene objects
-      // It should be replaced by your picking code
-      for (const auto& o : _objects)
-      {
-        if (!o->visible)
-          continue;
-
-        auto component = o->component();
-        float distance;
+      Intersection hit;
 
-        if (auto p = dynamic_cast<Primitive*>(component))
-          if (p->intersect(ray, distance) && distance < minDistance)
-          {
-            minDistance = distance;
-            _current = o;
-          }
-      }
-      // **End picking of temporary scene objects
+      // Closest triangle hit through the scene and mesh BVHs
+      _sceneBVH->update();
+      if (_sceneBVH->intersect(ray, hit))
+        _current = hit.object->sceneObject();
     }
     return true;
-  }*/
+  }
   if (button == GLFW_MOUSE_BUTTON_RIGHT)
     _dragFlags.enable(DragBits::Rotate, active);
   else if (button == GLFW_MOUSE_BUTTON_MIDDLE)
@@ -2,12 +2,12 @@
 #define __P4_h
 
 #include "Assets.h"
-#include "BVH.h"
 #include "GLRenderer.h"
 #include "Light.h"
 #include "Primitive.h"
 #include "SceneEditor.h"
 #include "RayTracer.h"
+#include "SceneBVH.h"
 #include "core/Flags.h"
 #include "graphics/Application.h"
 #include "graphics/GLImage.h"
@@ -61,9 +61,6 @@ private:
     Pan = 2
   };
 
-  using BVHRef = Reference<BVH>;
-  using BVHMap = std::map<TriangleMesh*, BVHRef>;
-
   GLSL::Program _program;
   Reference<Scene> _scene;
   Reference<SceneEditor> _editor;
@@ -71,6 +68,8 @@ private:
 
   SceneNode* _current{};
   Color _selectedWireframeColor{255, 102, 0};
+  char _renderOutput[256]{};
+  char _renderCheckpoint[256]{};
   Flags<MoveBits> _moveFlags{};
   Flags<DragBits> _dragFlags{};
   int _pivotX;
@@ -82,12 +81,14 @@ private:
   ViewMode _viewMode{ViewMode::Editor};
   Reference<RayTracer> _rayTracer;
   Reference<GLImage> _image;
-  BVHMap bvhMap;
+  Reference<SceneBVH> _sceneBVH;
 
   static MeshMap _defaultMeshes;
 
   void buildScene(int index);
   void renderScene();
+  void updateAssets();
+  void replaceMesh(SceneObject*, TriangleMesh*, TriangleMesh*);
   void recursiveRender(SceneObject*);
 
   void mainMenu();
@@ -104,7 +105,7 @@ private:
   void editorViewGui();
   void inspectPrimitive(Primitive&);
   void inspectShape(Primitive&);
-  void inspectMaterial(Material&);
+  bool inspectMaterial(Material&);
   void inspectLight(Light&);
   void inspectCamera(Camera&);
   void addComponentButton(SceneObject&);
@@ -161,6 +162,7 @@ private:
   //primitive
   GLfloat _transformLoc;
   GLfloat _normalMatrixLoc;
+  GLMesh::DecodeUniforms _decodeLocs;
 
   //camera
   GLfloat _vpMatrixLoc;
@@ -28,94 +28,92 @@
 // Source file for primitive.
 //
 // Author(s): Paulo Pagliosa (and your name)
-// Last revision: 30/10/2018
+// Last revision: 19/10/2026
 
+#include "BVH.h"
 #include "Primitive.h"
-#include "Transform.h"
+#include "SceneObject.h"
 
 namespace cg
 { // begin namespace cg
-bool intersectTriangle(const Ray& ray, const vec3f& v0, const vec3f& v1, const vec3f& v2, float& distance, float& b1, float& b2) 
+
+DEFINE_POOL_ALLOCATED(Primitive)
+
+
+/////////////////////////////////////////////////////////////////////
+//
+// Primitive implementation
+// =========
+bool
+Primitive::localBounds(Bounds3f& bounds, const BVH* bvh) const
 {
-    //calculate b1 and b2
-    auto e1 = v1 - v0;
-    auto e2 = v2 - v0;
-    auto s1 = ray.direction.cross(e2);
+  if (_streamingMesh != nullptr)
+  {
+    bounds = _streamingMesh->bounds();
+    return true;
+  }
+  if (bvh == nullptr)
+    return false;
+  bounds = bvh->bounds();
+  return true;
+}
 
-    auto s1e1 = s1.dot(e1);
-    if (s1e1==0)
-        return false;
+bool
+Primitive::intersect(const Ray& ray, Intersection& hit, const BVH* bvh) const
+{
+  if (bvh == nullptr && _streamingMesh == nullptr)
+    return false;
 
-    auto s = ray.origin - v0;
-    auto s2 = s.cross(e1);
-    distance = s2.dot(e2) / s1e1;
-    if (distance < 0)
-        return false;
+  auto t = const_cast<Primitive*>(this)->transform();
+  const auto& m = t->worldToLocalMatrix();
+  auto direction = m.transformVector(ray.direction);
+  // Length in mesh space of a unit step along the world ray
+  auto s = direction.length();
+  Ray localRay;
 
-    b1 = s1.dot(s) / s1e1;
+  localRay.origin = m.transform3x4(ray.origin);
+  localRay.direction = direction * math::inverse(s);
+  localRay.tMin = ray.tMin * s;
+  localRay.tMax = ray.tMax * s;
 
-    b2 = s2.dot(ray.direction) / s1e1;
-    if (b2 < 0 || b1 < 0 || b1 + b2 >1)
-        return false;
+  Intersection localHit;
 
-    return true;
-}
+  localHit.distance = hit.distance * s;
 
-bool intersectMesh(const Ray& ray, const TriangleMesh& mesh, Intersection& hit) {
-    auto& data = mesh.data();
-    bool isHitting = false;
-
-    hit.distance = ray.tMax;//math::Limits<float>::inf();
-    for (int i = 0; i < data.numberOfTriangles; i++) {
-        auto n = data.triangles + i;
-        const auto& v0 = data.vertices[n->v[0]];
-        const auto& v1 = data.vertices[n->v[1]];
-        const auto& v2 = data.vertices[n->v[2]];
-        float d, b1, b2;
-
-        if (intersectTriangle(ray, v0, v1, v2, d, b1, b2) && d < hit.distance) {
-            isHitting = true;
-            hit.triangleIndex = i;
-            hit.distance = d;
-            hit.p = { 1 - b1 - b2, b1, b2 };
-        }
-    }
-    return isHitting;
-}
+  auto found = _streamingMesh != nullptr ?
+    _streamingMesh->intersect(localRay, localHit) :
+    bvh->intersect(localRay, localHit);
 
+  if (!found)
+    return false;
+  hit.object = this;
+  hit.triangleIndex = localHit.triangleIndex;
+  hit.distance = localHit.distance / s;
+  hit.p = localHit.p;
+  return true;
+}
 
-bool
-Primitive::intersect(const Ray& ray, Intersection& hit) const
+vec3f
+Primitive::normal(const Intersection& hit) const
 {
-  if (_mesh == nullptr)
-    return false;
+  vec3f n;
+
+  if (_streamingMesh != nullptr)
+    n = _streamingMesh->normal(hit);
+  else
+  {
+    const auto& data = _mesh->data();
+    const auto& triangle = data.triangles[hit.triangleIndex];
+
+    n = data.vertexNormals[triangle.v[0]] * hit.p.x +
+      data.vertexNormals[triangle.v[1]] * hit.p.y +
+      data.vertexNormals[triangle.v[2]] * hit.p.z;
+  }
 
   auto t = const_cast<Primitive*>(this)->transform();
-  Ray localRay{ray, t->worldToLocalMatrix()};
-  auto d = math::inverse(localRay.direction.length());
-  float tMin;
-  float tMax;
-
-  localRay.direction *= d;
-  //if (_mesh->bounds().intersect(localRay, tMin, tMax))
-  //{
-    if (intersectMesh(ray, *_mesh, hit)) {
-        hit.object = this;
-        return true;
-    }
-    /*
-    if (tMin >= ray.tMin && tMin <= ray.tMax)
-    {
-      hit.distance = tMin * d;
-      return true;
-    }
-    if (tMax >= ray.tMin && tMax <= ray.tMax)
-    {
-      hit.distance = tMax * d;
-      return true;
-    }
-    */
-  //}
-  return false;
+
+  // Normals are transformed by the inverse transpose
+  return mat3f{t->worldToLocalMatrix()}.transposeTransform(n).versor();
 }
-} // end namespace cg
\ No newline at end of file
+
+} // end namespace cg
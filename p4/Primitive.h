@@ -28,7 +28,7 @@
 // Class definition for primitive.
 //
 // Author(s): Paulo Pagliosa (and your name)
-// Last revision: 30/10/2018
+// Last revision: 19/10/2026
 
 #ifndef __Primitive_h
 #define __Primitive_h
@@ -37,6 +37,7 @@
 #include "graphics/GLMesh.h"
 #include "Intersection.h"
 #include "Material.h"
+#include "StreamingMesh.h"
 
 namespace cg
 { // begin namespace cg
@@ -49,6 +50,8 @@ namespace cg
 class Primitive: public Component
 {
 public:
+  DECLARE_POOL_ALLOCATED(Primitive);
+
   Material material;
 
   Primitive(TriangleMesh* mesh, const std::string& meshName):
@@ -72,13 +75,61 @@ public:
   void setMesh(TriangleMesh* mesh, const std::string& meshName)
   {
     _mesh = mesh;
+    _streamingMesh = nullptr;
+    _meshName = meshName;
+    recordChange(SceneJournal::Event::Mesh);
+  }
+
+  /// \brief Returns the streaming mesh of this primitive, if any. A
+  /// streaming mesh is ray traced only.
+  StreamingMesh* streamingMesh() const
+  {
+    return _streamingMesh;
+  }
+
+  void setStreamingMesh(StreamingMesh* mesh, const std::string& meshName)
+  {
+    _mesh = nullptr;
+    _streamingMesh = mesh;
     _meshName = meshName;
+    recordChange(SceneJournal::Event::Mesh);
   }
 
-  bool intersect(const Ray& ray, Intersection& hit) const;
+  /// \brief Returns the BVH of the mesh of this primitive, building
+  /// it on first use, or null if the primitive has a streaming mesh
+  /// or no mesh.
+  BVH* bvh() const
+  {
+    return _mesh != nullptr ? BVHCache::get(_mesh) : nullptr;
+  }
+
+  /// \brief Gets the bounds, in local space, of the geometry of this
+  /// primitive. Returns false if the primitive has no geometry.
+  bool localBounds(Bounds3f& bounds) const
+  {
+    return localBounds(bounds, bvh());
+  }
+
+  /// \brief Gets the bounds of the geometry of this primitive given
+  /// the BVH of its mesh, as returned by bvh().
+  bool localBounds(Bounds3f& bounds, const BVH* bvh) const;
+
+  bool intersect(const Ray& ray, Intersection& hit) const
+  {
+    return intersect(ray, hit, bvh());
+  }
+
+  /// \brief Intersects a ray with this primitive given the BVH of its
+  /// mesh, as returned by bvh(). Callers resolving the BVH once (e.g.,
+  /// a scene BVH) avoid the lookup in the BVH cache, which is locked.
+  bool intersect(const Ray& ray, Intersection& hit, const BVH* bvh) const;
+
+  /// Returns the unit normal, in world space, at a hit point.
+  vec3f normal(const Intersection& hit) const;
 
 private:
   Reference<TriangleMesh> _mesh;
+  Reference<StreamingMesh> _streamingMesh;
   std::string _meshName;
 
 }; // Primitive
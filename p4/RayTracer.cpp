@@ -28,13 +28,15 @@
 // Source file for simple ray tracer.
 //
 // Author(s): Paulo Pagliosa (and your name)
-// Last revision: 16/10/2019
+// Last revision: 19/10/2026
 
 #include "Camera.h"
 #include "RayTracer.h"
 #include "Primitive.h"
+#include <cstddef>
+#include <cstring>
+#include <filesystem>
 #include <time.h>
-#include "BVH.h"
 
 using namespace std;
 
@@ -57,7 +59,7 @@ RayTracer::RayTracer(Scene& scene, Camera* camera):
   _maxRecursionLevel{6},
   _minWeight{MIN_WEIGHT}
 {
-  // TODO: BVH
+  // do nothing
 }
 
 void
@@ -97,13 +99,38 @@ RayTracer::renderImage(Image& image)
   _pixelRay.origin = _camera->transform()->position();
   _pixelRay.direction = -_vrc.n;
   _camera->clippingPlanes(_pixelRay.tMin, _pixelRay.tMax);
-  _numberOfRays = _numberOfHits = 0;
+  _numberOfRays = _numberOfHits = _numberOfSamples = 0;
+  if (_sceneBVH == nullptr || _sceneBVH->scene() != _scene)
+    _sceneBVH = new SceneBVH{*_scene};
+  _bvhTime = clock();
+  _sceneBVH->update();
+  _bvhTime = clock() - _bvhTime;
+  // Lights are gathered once, not by each shade() call
+  _lights.build(*_scene);
   scan(image);
+  _renderTime = clock() - t;
   printf("\nNumber of rays: %llu", _numberOfRays);
   printf("\nNumber of hits: %llu", _numberOfHits);
+
+  auto pixels = std::max(_scanRegion.w * _scanRegion.h, 1);
+
+  printf("\nSamples per pixel: %.2f", double(_numberOfSamples) / pixels);
   printElapsedTime("\nDONE! ", clock() - t);
 }
 
+RayTracer::Statistics
+RayTracer::statistics() const
+{
+  Statistics s;
+
+  s.numberOfRays = _numberOfRays;
+  s.numberOfHits = _numberOfHits;
+  s.numberOfSamples = _numberOfSamples;
+  s.bvhTime = (float)_bvhTime / CLOCKS_PER_SEC;
+  s.renderTime = (float)_renderTime / CLOCKS_PER_SEC;
+  return s;
+}
+
 void
 RayTracer::setPixelRay(float x, float y)
 //[]---------------------------------------------------[]
@@ -131,15 +158,691 @@ RayTracer::scan(Image& image)
 {
   ImageBuffer scanLine{_W, 1};
 
-  for (int j = 0; j < _H; j++)
+  if (_buffer.width() != _W ||
+    _buffer.height() != _H ||
+    _buffer.layout() != _bufferLayout)
+    _buffer = AccumulationBuffer{_W, _H, _bufferLayout};
+  else
+    _buffer.clear();
+  _denoised = AccumulationBuffer{};
+  initAOVs();
+  initTiles();
+  if (!_checkpointFile.empty())
+    hashView();
+  if (_resuming && !_checkpointFile.empty())
+    loadCheckpoint();
+  _lastCheckpoint = clock();
+
+  auto bands = int(_tilesDone.size()) / std::max(_tilesPerRow, 1);
+  auto j = _H - 1;
+
+  // Rows are output from the top, the order of image files, as soon
+  // as their band of tiles is finished
+  auto outputRows = [&](int end)
+  {
+    for (; j >= end; j--)
+    {
+      _buffer.resolve(scanLine, 0, j, _toneMapping);
+      image.setData(0, j, scanLine);
+      // Denoised images are written when finished
+      if (_output != nullptr && !_denoising)
+        writeOutput(j, scanLine);
+    }
+  };
+
+  for (int band = bands - 1; band >= 0; band--)
+  {
+    printf("Scanning band %d of %d\r", bands - band, bands);
+    for (int i = 0; i < _tilesPerRow; i++)
+    {
+      auto t = band * _tilesPerRow + i;
+
+      if (_tilesDone[t])
+        continue;
+      renderTile(t);
+      _tilesDone[t] = 1;
+      if (!_checkpointFile.empty() &&
+        clock() - _lastCheckpoint >= _checkpointInterval)
+        saveCheckpoint();
+    }
+    outputRows(tile(band * _tilesPerRow).y);
+  }
+  outputRows(0);
+  if (!_checkpointFile.empty())
+    saveCheckpoint();
+  if (_activeAOVs)
+    resolveAOVs();
+  if (_denoising)
+    denoise(image);
+}
+
+void
+RayTracer::initTiles()
+{
+  auto& r = _scanRegion;
+
+  if (_region.w <= 0 || _region.h <= 0)
+    r = {0, 0, _W, _H};
+  else
+  {
+    r.x = math::clamp(_region.x, 0, _W);
+    r.y = math::clamp(_region.y, 0, _H);
+    r.w = std::max(std::min(_region.x + _region.w, _W) - r.x, 0);
+    r.h = std::max(std::min(_region.y + _region.h, _H) - r.y, 0);
+  }
+  // Tiles of regions start at block boundaries, so that no block of
+  // the buffer is split between tiles
+  _tileX = r.x & ~(AccumulationBuffer::blockSize - 1);
+  _tileY = r.y & ~(AccumulationBuffer::blockSize - 1);
+  _tilesPerRow = (r.x + r.w - _tileX + TILE_SIZE - 1) / TILE_SIZE;
+
+  auto bands = (r.y + r.h - _tileY + TILE_SIZE - 1) / TILE_SIZE;
+
+  if (r.w == 0 || r.h == 0)
+    _tilesPerRow = bands = 0;
+
+  _tilesDone.assign(size_t(_tilesPerRow) * bands, 0);
+}
+
+RayTracer::Region
+RayTracer::tile(int t) const
+{
+  const auto& r = _scanRegion;
+  auto x = _tileX + t % _tilesPerRow * TILE_SIZE;
+  auto y = _tileY + t / _tilesPerRow * TILE_SIZE;
+  auto x1 = std::min(x + TILE_SIZE, r.x + r.w);
+  auto y1 = std::min(y + TILE_SIZE, r.y + r.h);
+
+  // The first tiles of a row or column are clipped to the region
+  x = std::max(x, r.x);
+  y = std::max(y, r.y);
+  return {x, y, x1 - x, y1 - y};
+}
+
+void
+RayTracer::renderTile(int t)
+{
+  auto r = tile(t);
+
+  for (int j = r.y + r.h - 1; j >= r.y; j--)
+    for (int i = r.x; i < r.x + r.w; i++)
+      samplePixel(i, j);
+}
+
+void
+RayTracer::initAOVs()
+{
+  _activeAOVs = _aovs;
+  if (_denoising)
+  {
+    _activeAOVs.set(AOV::Depth);
+    _activeAOVs.set(AOV::Normal);
+    _activeAOVs.set(AOV::Albedo);
+  }
+
+  auto n = size_t(_W) * _H;
+  auto init = [&](auto& buffer, AOV aov, auto value)
+  {
+    if (_activeAOVs.isSet(aov))
+      buffer.assign(n, value);
+    else
+    {
+      buffer.clear();
+      buffer.shrink_to_fit();
+    }
+  };
+
+  init(_aovBuffers.depth, AOV::Depth, 0.0f);
+  init(_aovBuffers.normal, AOV::Normal, vec3f{0, 0, 0});
+  init(_aovBuffers.objectId, AOV::ObjectId, int32_t(-1));
+  init(_aovBuffers.triangleId, AOV::TriangleId, int64_t(-1));
+  init(_aovBuffers.albedo, AOV::Albedo, Color::black);
+  _objectIds.clear();
+  if (_activeAOVs.isSet(AOV::ObjectId))
+  {
+    int32_t id{0};
+
+    numberObjects(_scene, id);
+  }
+}
+
+void
+RayTracer::numberObjects(SceneNode* node, int32_t& id)
+{
+  auto it = node->objectIterator();
+
+  for (auto object = it->start(); object != nullptr; object = it->next())
+  {
+    auto component = object->getComponent("Primitive");
+
+    if (auto primitive = dynamic_cast<Primitive*>(component))
+      _objectIds[primitive] = id++;
+    numberObjects(object, id);
+  }
+  it->dispose();
+}
+
+void
+RayTracer::addAOVs(int i, int j)
+{
+  auto k = size_t(j) * _W + i;
+  const auto& hit = _primaryHit;
+  auto& b = _aovBuffers;
+
+  if (hit.object == nullptr)
+  {
+    // Misses are far, facing nowhere, and of unit albedo
+    if (_activeAOVs.isSet(AOV::Depth))
+      b.depth[k] += 1e10f;
+    if (_activeAOVs.isSet(AOV::Albedo))
+      b.albedo[k] += Color::white;
+    return;
+  }
+  if (_activeAOVs.isSet(AOV::Depth))
+    b.depth[k] += hit.distance;
+  if (_activeAOVs.isSet(AOV::Normal))
+    b.normal[k] += hit.object->normal(hit);
+  if (_activeAOVs.isSet(AOV::Albedo))
+    b.albedo[k] += hit.object->material.diffuse;
+  // Ids are not averaged: they are taken from the first sample
+  if (_buffer.samples(i, j) == 1)
+  {
+    if (_activeAOVs.isSet(AOV::ObjectId))
+    {
+      auto id = _objectIds.find(hit.object);
+
+      if (id != _objectIds.end())
+        b.objectId[k] = id->second;
+    }
+    if (_activeAOVs.isSet(AOV::TriangleId))
+      b.triangleId[k] = hit.triangleIndex;
+  }
+}
+
+void
+RayTracer::resolveAOVs()
+{
+  auto& b = _aovBuffers;
+
+  for (int j = 0, k = 0; j < _H; j++)
+    for (int i = 0; i < _W; i++, k++)
+    {
+      auto s = math::inverse(float(std::max(_buffer.samples(i, j), 1u)));
+
+      if (!b.depth.empty())
+        b.depth[k] *= s;
+      if (!b.normal.empty())
+        b.normal[k].normalize();
+      if (!b.albedo.empty())
+        b.albedo[k] *= s;
+    }
+}
+
+namespace internal
+{ // begin namespace internal
+
+//
+// Header of checkpoint files, which is followed by a flag per tile
+// and by the samples and AOV sums of the pixels of the tiles done
+//
+struct CheckpointHeader
+{
+  char magic[4];
+  uint32_t version;
+  int32_t width;
+  int32_t height;
+  RayTracer::Region region;
+  int32_t tileSize;
+  int32_t baseSamples;
+  int32_t maxSamples;
+  float tolerance;
+  uint32_t aovs;
+  uint64_t cameraHash;
+  uint64_t sceneHash;
+  // The fields below are not compared when resuming
+  uint64_t numberOfRays;
+  uint64_t numberOfHits;
+  uint64_t numberOfSamples;
+
+  CheckpointHeader()
+  {
+    // Padding is zeroed, so that headers can be compared with memcmp
+    memset(this, 0, sizeof *this);
+    memcpy(magic, "CGRT", 4);
+    version = 3;
+    tileSize = TILE_SIZE;
+  }
+
+  bool matches(const CheckpointHeader& other) const
+  {
+    return memcmp(this, &other, offsetof(CheckpointHeader, numberOfRays)) == 0;
+  }
+
+}; // CheckpointHeader
+
+template <typename T>
+inline bool
+write(FILE* file, const T* data, size_t count)
+{
+  return fwrite(data, sizeof(T), count, file) == count;
+}
+
+template <typename T>
+inline bool
+read(FILE* file, T* data, size_t count)
+{
+  return fread(data, sizeof(T), count, file) == count;
+}
+
+// Calls f for each AOV buffer, which is empty if its AOV is not set
+template <typename F>
+inline void
+forEachBuffer(RayTracer::AOVBuffers& b, F f)
+{
+  f(b.depth);
+  f(b.normal);
+  f(b.objectId);
+  f(b.triangleId);
+  f(b.albedo);
+}
+
+//
+// FNV-1a hash of the bytes of values, which must have no padding
+//
+class Hash
+{
+public:
+  template <typename T>
+  Hash& add(const T& value)
+  {
+    auto bytes = reinterpret_cast<const unsigned char*>(&value);
+
+    for (size_t i = 0; i < sizeof(T); i++)
+      _value = (_value ^ bytes[i]) * 0x100000001b3ULL;
+    return *this;
+  }
+
+  auto value() const
+  {
+    return _value;
+  }
+
+private:
+  uint64_t _value{0xcbf29ce484222325ULL};
+
+}; // Hash
+
+// Hashes the visible primitives and the lights of the subtree of node.
+// Meshes are hashed by their sizes, not by their vertices, which
+// would be too slow for big meshes
+void
+hashObjects(SceneNode* node, Hash& hash)
+{
+  auto it = node->objectIterator();
+
+  for (auto object = it->start(); object != nullptr; object = it->next())
+  {
+    auto component = object->getComponent("Primitive");
+    auto primitive = dynamic_cast<Primitive*>(component);
+
+    if (primitive != nullptr && object->visible)
+    {
+      const auto& m = primitive->material;
+      auto mesh = primitive->mesh();
+
+      hash.add(object->transform()->localToWorldMatrix());
+      hash.add(m.ambient).add(m.diffuse).add(m.spot).add(m.shine);
+      hash.add(m.specular);
+      if (mesh != nullptr)
+      {
+        hash.add(mesh->data().numberOfVertices);
+        hash.add(mesh->data().numberOfTriangles);
+      }
+    }
+    if (auto light = dynamic_cast<Light*>(object->getComponent("Light")))
+    {
+      hash.add(light->type()).add(light->color);
+      hash.add(light->transform()->position());
+      hash.add(light->getWorldDirection());
+      hash.add(light->getFalloff()).add(light->getRadialFalloff());
+      hash.add(light->getSpotlightAngle());
+    }
+    hashObjects(object, hash);
+  }
+  it->dispose();
+}
+
+} // end namespace internal
+
+void
+RayTracer::hashView()
+{
+  internal::Hash camera;
+  float F;
+  float B;
+
+  _camera->clippingPlanes(F, B);
+  camera.add(_camera->cameraToWorldMatrix());
+  camera.add(_camera->projectionType());
+  camera.add(_camera->viewAngle()).add(_camera->height());
+  camera.add(F).add(B);
+  _cameraHash = camera.value();
+
+  internal::Hash scene;
+
+  scene.add(_scene->backgroundColor).add(_scene->ambientLight);
+  internal::hashObjects(_scene, scene);
+  _sceneHash = scene.value();
+}
+
+bool
+RayTracer::saveCheckpoint()
+{
+  namespace fs = std::filesystem;
+
+  _lastCheckpoint = clock();
+
+  // The file is replaced only when written, so that a crash while
+  // saving does not lose the last checkpoint
+  auto temp = _checkpointFile + ".tmp";
+  auto file = fopen(temp.c_str(), "wb");
+
+  if (file == nullptr)
+  {
+    printf("Unable to create checkpoint file %s\n", temp.c_str());
+    return false;
+  }
+
+  internal::CheckpointHeader h;
+
+  h.width = _W;
+  h.height = _H;
+  h.region = _scanRegion;
+  h.baseSamples = _baseSamples;
+  h.maxSamples = _maxSamples;
+  h.tolerance = _tolerance;
+  h.aovs = int(_activeAOVs);
+  h.cameraHash = _cameraHash;
+  h.sceneHash = _sceneHash;
+  h.numberOfRays = _numberOfRays;
+  h.numberOfHits = _numberOfHits;
+  h.numberOfSamples = _numberOfSamples;
+
+  auto ok = internal::write(file, &h, 1) &&
+    internal::write(file, _tilesDone.data(), _tilesDone.size());
+  std::vector<AccumulationBuffer::PixelState> states(TILE_SIZE);
+
+  for (size_t t = 0; ok && t < _tilesDone.size(); t++)
+  {
+    if (!_tilesDone[t])
+      continue;
+
+    auto r = tile(int(t));
+
+    for (int y = r.y; ok && y < r.y + r.h; y++)
+    {
+      auto k = size_t(y) * _W + r.x;
+
+      for (int x = 0; x < r.w; x++)
+        states[x] = _buffer.state(r.x + x, y);
+      ok = internal::write(file, states.data(), r.w);
+      internal::forEachBuffer(_aovBuffers, [&](auto& b)
+      {
+        if (!b.empty())
+          ok = ok && internal::write(file, &b[k], r.w);
+      });
+    }
+  }
+  ok = fclose(file) == 0 && ok;
+
+  std::error_code e;
+
+  if (ok)
+    fs::rename(temp, _checkpointFile, e);
+  if (!ok || e)
+  {
+    printf("Unable to write checkpoint file %s\n", _checkpointFile.c_str());
+    fs::remove(temp, e);
+    return false;
+  }
+  return true;
+}
+
+bool
+RayTracer::loadCheckpoint()
+{
+  auto file = fopen(_checkpointFile.c_str(), "rb");
+
+  if (file == nullptr)
+    return false;
+
+  internal::CheckpointHeader h;
+  internal::CheckpointHeader expected;
+
+  expected.width = _W;
+  expected.height = _H;
+  expected.region = _scanRegion;
+  expected.baseSamples = _baseSamples;
+  expected.maxSamples = _maxSamples;
+  expected.tolerance = _tolerance;
+  expected.aovs = int(_activeAOVs);
+  expected.cameraHash = _cameraHash;
+  expected.sceneHash = _sceneHash;
+
+  auto ok = internal::read(file, &h, 1) && h.matches(expected) &&
+    internal::read(file, _tilesDone.data(), _tilesDone.size());
+  std::vector<AccumulationBuffer::PixelState> states(TILE_SIZE);
+  int done = 0;
+
+  for (size_t t = 0; ok && t < _tilesDone.size(); t++)
+  {
+    if (!_tilesDone[t])
+      continue;
+
+    auto r = tile(int(t));
+
+    for (int y = r.y; ok && y < r.y + r.h; y++)
+    {
+      auto k = size_t(y) * _W + r.x;
+
+      if ((ok = internal::read(file, states.data(), r.w)))
+        for (int x = 0; x < r.w; x++)
+          _buffer.setState(r.x + x, y, states[x]);
+      internal::forEachBuffer(_aovBuffers, [&](auto& b)
+      {
+        if (!b.empty())
+          ok = ok && internal::read(file, &b[k], r.w);
+      });
+    }
+    ++done;
+  }
+  fclose(file);
+  if (!ok)
+  {
+    // Partially restored tiles are discarded
+    printf("Ignoring checkpoint file %s\n", _checkpointFile.c_str());
+    _buffer.clear();
+    initAOVs();
+    std::fill(_tilesDone.begin(), _tilesDone.end(), 0);
+    return false;
+  }
+  _numberOfRays = h.numberOfRays;
+  _numberOfHits = h.numberOfHits;
+  _numberOfSamples = h.numberOfSamples;
+  printf("Resuming from %s: %d of %d tiles done\n",
+    _checkpointFile.c_str(),
+    done,
+    int(_tilesDone.size()));
+  return true;
+}
+
+void
+RayTracer::denoise(Image& image)
+{
+  auto n = size_t(_W) * _H;
+  std::vector<Color> color(n);
+
+  for (int j = 0, k = 0; j < _H; j++)
+    for (int i = 0; i < _W; i++, k++)
+      color[k] = _buffer.mean(i, j);
+
+  Denoiser::Features features;
+
+  features.normal = _aovBuffers.normal.data();
+  features.depth = _aovBuffers.depth.data();
+  features.albedo = _aovBuffers.albedo.data();
+  _denoiser.denoise(_W, _H, color.data(), features, color.data());
+  _denoised = AccumulationBuffer{_W, _H, _bufferLayout};
+  for (int j = 0, k = 0; j < _H; j++)
+    for (int i = 0; i < _W; i++, k++)
+      _denoised.add(i, j, color[k]);
+  resolve(image);
+  if (_output != nullptr)
+  {
+    ImageBuffer scanLine{_W, 1};
+
+    for (int j = _H - 1; j >= 0; j--)
+    {
+      _denoised.resolve(scanLine, 0, j, _toneMapping);
+      writeOutput(j, scanLine);
+    }
+  }
+}
+
+namespace internal
+{ // begin namespace internal
+
+//
+// PCG32 random number generator (O'Neill, M. PCG: a family of simple
+// fast space-efficient statistically good algorithms for random number
+// generation, 2014)
+//
+class Random
+{
+public:
+  Random(uint64_t seed)
+  {
+    next();
+    _state += seed;
+    next();
+  }
+
+  uint32_t next()
+  {
+    auto s = _state;
+
+    _state = s * 6364136223846793005ULL + 1442695040888963407ULL;
+
+    auto x = uint32_t(((s >> 18) ^ s) >> 27);
+    auto r = uint32_t(s >> 59);
+
+    return x >> r | x << ((32 - r) & 31);
+  }
+
+  // Uniform in [0, 1)
+  float uniform()
+  {
+    return (next() >> 8) * (1.0f / (1 << 24));
+  }
+
+private:
+  uint64_t _state{};
+
+}; // Random
+
+} // end namespace internal
+
+void
+RayTracer::samplePixel(int i, int j)
+{
+  if (_maxSamples == 1)
+  {
+    addSample(i, j, (float)i + 0.5f, (float)j + 0.5f);
+    ++_numberOfSamples;
+    return;
+  }
+
+  // Samples are jittered in the strata of a g x g grid, which are
+  // visited in random order, so that any number of samples is spread
+  // over the pixel
+  auto g = (int)ceil(sqrt((float)_maxSamples));
+  auto ns = g * g;
+  internal::Random random{uint64_t(j) * _W + i};
+  int n = 0;
+
+  for (int k = 0; k < ns; k++)
+    _strata[k] = k;
+
+  auto sample = [&]()
   {
-    auto y = (float)j + 0.5f;
+    std::swap(_strata[n], _strata[n + random.next() % (ns - n)]);
+
+    auto s = _strata[n++];
+    auto x = i + (s % g + random.uniform()) / g;
+    auto y = j + (s / g + random.uniform()) / g;
+
+    addSample(i, j, x, y);
+  };
+
+  while (n < _baseSamples)
+    sample();
+  while (n < _maxSamples && !converged(i, j))
+    for (int k = 0; k < _baseSamples && n < _maxSamples; k++)
+      sample();
+  _numberOfSamples += n;
+}
+
+void
+RayTracer::addSample(int i, int j, float x, float y)
+{
+  _buffer.add(i, j, shoot(x, y));
+  if (_activeAOVs)
+    addAOVs(i, j);
+}
+
+bool
+RayTracer::converged(int i, int j) const
+{
+  auto n = _buffer.samples(i, j);
+
+  if (n < 2)
+    return false;
+
+  // Absolute error for dark pixels, relative for bright ones
+  auto mean = AccumulationBuffer::luminance(_buffer.mean(i, j));
 
-    printf("Scanning line %d of %d\r", j + 1, _H);
-    for (int i = 0; i < _W; i++)
-      scanLine[i] = shoot((float)i + 0.5f, y);
-    image.setData(0, j, scanLine);
+  return sqrt(_buffer.variance(i, j) / n) <= _tolerance * (1 + mean);
+}
+
+void
+RayTracer::writeOutput(int j, const ImageBuffer& scanLine)
+{
+  if (!_output->isHDR())
+  {
+    _output->writeRows(scanLine.data(), 1);
+    return;
   }
+
+  // HDR images store the radiance, not tone mapped
+  std::vector<Color> row(_W);
+
+  for (int i = 0; i < _W; i++)
+    row[i] = output().mean(i, j);
+  _output->writeRows(row.data(), 1);
+}
+
+void
+RayTracer::resolve(Image& image) const
+{
+  const auto& output = this->output();
+
+  if (output.width() == 0)
+    return;
+
+  ImageBuffer buffer{output.width(), output.height()};
+
+  output.resolve(buffer, _toneMapping);
+  image.setData(buffer);
 }
 
 Color
@@ -154,18 +857,8 @@ RayTracer::shoot(float x, float y)
   // set pixel ray
   setPixelRay(x, y);
 
-  // trace pixel ray
-  Color color = trace(_pixelRay, 0, 1.0f);
-
-  // adjust RGB color
-  if (color.r > 1.0f)
-    color.r = 1.0f;
-  if (color.g > 1.0f)
-    color.g = 1.0f;
-  if (color.b > 1.0f)
-    color.b = 1.0f;
-  // return pixel color
-  return color;
+  // trace pixel ray; the HDR color is tone mapped when resolved
+  return trace(_pixelRay, 0, 1.0f);
 }
 
 Color
@@ -183,8 +876,15 @@ RayTracer::trace(const Ray& ray, uint32_t level, float weight)
   _numberOfRays++;
 
   Intersection hit;
-  
-  return intersect(ray, hit) ? shade(ray, hit, level, weight) : background();
+
+  auto found = intersect(ray, hit);
+
+  // The primary hit is kept to fill the AOVs of the sample
+  if (level == 0 && _activeAOVs)
+    _primaryHit = hit;
+  if (!found)
+    return background();
+  return shade(ray, hit, level, weight);
 }
 
 inline constexpr auto
@@ -202,62 +902,20 @@ RayTracer::intersect(const Ray& ray, Intersection& hit)
 //|  @return true if the ray intersects an object       |
 //[]---------------------------------------------------[]
 {
-  hit.object = nullptr;
-  hit.distance = ray.tMax;
-  //go through each object
-  recursiveIntersect(ray, hit, _scene);
-  return hit.object != nullptr;
-}
-
-void RayTracer::recursiveIntersect(const Ray& ray, Intersection& hit, SceneNode* node) {
-    SceneObjectListIterator* it = node->objectIterator();
-    SceneObject* obj = it->start();
-    while (obj) {
-        recursiveIntersect(ray, hit, obj);
-        obj = it->next();
-    }
-    SceneObject* currentObj = dynamic_cast<SceneObject*>(node);
-    if (currentObj) {
-        Component* comp = currentObj->getComponent("Primitive");
-        if (comp) {
-            Primitive* prim = dynamic_cast<Primitive*>(comp);
-            if (prim) {
-                TriangleMesh* mesh = prim->mesh();
-                if (mesh) {
-                    BVH* bvh = bvhMap[mesh];
-                    if (bvh == nullptr)
-                        bvhMap[mesh] = bvh = new BVH{ *mesh, 16 };
-                    if (bvh->intersect(ray, hit))
-                        prim->intersect(ray, hit);
-                }
-            }
-        }
-    }
+  return _sceneBVH->intersect(ray, hit);
 }
 
-
-
-BVH* RayTracer::getBVH(SceneObject* obj) {
-    Component* comp = obj->getComponent("Primitive");
-    if (comp) {
-        Primitive* prim = dynamic_cast<Primitive*>(comp);
-        if (prim) {
-            TriangleMesh* mesh = prim->mesh();
-            if (mesh) {
-                BVH* bvh = bvhMap[mesh];
-                if (bvh == nullptr)
-                    bvhMap[mesh] = bvh = new BVH{ *mesh, 16 };
-                return bvh;
-            }
-        }
-    }
+BVH*
+RayTracer::getBVH(SceneObject* obj)
+{
+  auto primitive = dynamic_cast<Primitive*>(obj->getComponent("Primitive"));
+  return primitive != nullptr ? BVHCache::get(primitive->mesh()) : nullptr;
 }
 
-BVH* RayTracer::getBVH(TriangleMesh* mesh) {
-    BVH* bvh = bvhMap[mesh];
-    if (bvh == nullptr)
-        bvhMap[mesh] = bvh = new BVH{ *mesh, 16 };
-    return bvh;
+BVH*
+RayTracer::getBVH(TriangleMesh* mesh)
+{
+  return BVHCache::get(mesh);
 }
 
 Color
@@ -272,8 +930,53 @@ RayTracer::shade(const Ray& ray, Intersection& hit, int level, float weight)
 //[]---------------------------------------------------[]
 {
   _numberOfHits++;
-  //return Color::red;
-  return Color::black;
+
+  const auto& m = hit.object->material;
+  auto P = ray.origin + hit.distance * ray.direction;
+  auto N = hit.object->normal(hit);
+  auto V = -ray.direction;
+
+  // Back faces are shaded as front faces
+  if (N.dot(V) < 0)
+    N.negate();
+
+  auto color = m.ambient * _scene->ambientLight;
+  // Secondary rays start off the surface, avoiding self intersections
+  auto O = P + rt_eps() * N;
+
+  if (_lights.illuminate(P, N, _incidence) > 0)
+    for (int i = 0, n = _lights.paddedSize(); i < n; i++)
+    {
+      auto cosine = _incidence.cosine[i];
+
+      if (cosine <= 0)
+        continue;
+
+      vec3f L{_incidence.x[i], _incidence.y[i], _incidence.z[i]};
+
+      if (shadow(Ray{O, L, 0, _incidence.distance[i]}))
+        continue;
+
+      auto I = _lights.intensity(i, _incidence);
+      auto R = 2 * cosine * N - L;
+      auto s = R.dot(V);
+
+      color += I * m.diffuse * cosine;
+      if (s > 0)
+        color += I * m.spot * pow(s, m.shine);
+    }
+  if (m.specular != Color::black)
+  {
+    auto w = weight * std::max({m.specular.r, m.specular.g, m.specular.b});
+
+    if (w > _minWeight)
+    {
+      auto R = 2 * N.dot(V) * N - V;
+
+      color += m.specular * trace(Ray{O, R}, level + 1, w);
+    }
+  }
+  return color;
 }
 
 Color
@@ -28,22 +28,30 @@
 // Class definition for simple ray tracer.
 //
 // Author(s): Paulo Pagliosa (and your name)
-// Last revision: 16/10/2019
+// Last revision: 19/10/2026
 
 #ifndef __RayTracer_h
 #define __RayTracer_h
 
-#include "graphics/Image.h"
+#include "core/Flags.h"
+#include "graphics/AccumulationBuffer.h"
+#include "graphics/Denoiser.h"
+#include "utils/ImageWriter.h"
 #include "Intersection.h"
+#include "LightTable.h"
 #include "Renderer.h"
-#include "BVH.h"
-#include <map>
+#include "SceneBVH.h"
+#include <ctime>
+#include <string>
+#include <unordered_map>
 
 namespace cg
 { // begin namespace cg
 
 #define MIN_WEIGHT float(0.001)
 #define MAX_RECURSION_LEVEL uint32_t(20)
+#define MAX_SAMPLES 256
+#define TILE_SIZE 32
 
 
 /////////////////////////////////////////////////////////////////////
@@ -52,10 +60,55 @@ namespace cg
 // =========
 class RayTracer: public Renderer
 {
-using BVHRef = Reference<BVH>;
-using BVHMap = std::map<TriangleMesh*, BVHRef>;
-
 public:
+  struct Statistics
+  {
+    uint64_t numberOfRays;
+    uint64_t numberOfHits;
+    uint64_t numberOfSamples;
+    float bvhTime; // in seconds
+    float renderTime; // in seconds
+
+  }; // Statistics
+
+  /// Arbitrary output variables (AOVs) of the primary hits.
+  enum class AOV
+  {
+    Depth = 1,
+    Normal = 2,
+    ObjectId = 4,
+    TriangleId = 8,
+    Albedo = 16,
+    All = 31
+  };
+
+  using AOVs = Flags<AOV>;
+
+  /// \brief AOV buffers of the image last rendered, stored row by row
+  /// from the bottom, as the pixels of the image. Depth, normal and
+  /// albedo are averaged over the samples of each pixel, whereas the
+  /// ids are those of the first sample. Misses have depth 1e10, null
+  /// normal, unit albedo and ids -1.
+  struct AOVBuffers
+  {
+    std::vector<float> depth;
+    std::vector<vec3f> normal;
+    std::vector<int32_t> objectId;
+    std::vector<int64_t> triangleId;
+    std::vector<Color> albedo;
+
+  }; // AOVBuffers
+
+  /// Rectangle of pixels whose bottom-left corner is (x, y).
+  struct Region
+  {
+    int x;
+    int y;
+    int w;
+    int h;
+
+  }; // Region
+
   // Constructor
   RayTracer(Scene&, Camera* = 0);
 
@@ -82,9 +135,161 @@ public:
     _minWeight = std::max(w, MIN_WEIGHT);
   }
 
+  auto baseSamples() const
+  {
+    return _baseSamples;
+  }
+
+  auto maxSamples() const
+  {
+    return _maxSamples;
+  }
+
+  auto tolerance() const
+  {
+    return _tolerance;
+  }
+
+  /// \brief Sets the number of samples per pixel. \c base jittered
+  /// samples are shot through each pixel, and then further ones, in
+  /// rounds of \c base, up to \c max samples while the standard error
+  /// of the luminance of the pixel exceeds tolerance() * (1 + mean).
+  /// If \c max is 1, one ray is shot through the pixel center.
+  void setSamples(int base, int max)
+  {
+    _maxSamples = std::min(std::max(max, 1), MAX_SAMPLES);
+    _baseSamples = std::min(std::max(base, 1), _maxSamples);
+  }
+
+  void setTolerance(float tolerance)
+  {
+    _tolerance = std::max(tolerance, 0.0f);
+  }
+
+  auto bufferLayout() const
+  {
+    return _bufferLayout;
+  }
+
+  /// \brief Sets the memory layout of the buffers in which the samples
+  /// of the images rendered are accumulated. The layout changes only
+  /// the locality of the accesses of scan() to the buffers, not the
+  /// images. Tiles are rendered one at a time, and the denoiser reads
+  /// row-major copies of the buffers.
+  void setBufferLayout(AccumulationBuffer::Layout layout)
+  {
+    _bufferLayout = layout;
+  }
+
+  auto& toneMapping()
+  {
+    return _toneMapping;
+  }
+
+  auto denoising() const
+  {
+    return _denoising;
+  }
+
+  /// \brief Sets whether the images rendered are denoised, guided by
+  /// the normal, depth and albedo of the primary hits of the pixels.
+  void setDenoising(bool denoising)
+  {
+    _denoising = denoising;
+  }
+
+  auto& denoiser()
+  {
+    return _denoiser;
+  }
+
+  auto aovs() const
+  {
+    return _aovs;
+  }
+
+  /// \brief Sets the AOVs filled, in the same pass, along with the
+  /// images rendered. Object ids are the indices of the primitives in
+  /// a preorder traversal of the scene.
+  void setAOVs(AOVs aovs)
+  {
+    _aovs = aovs;
+  }
+
+  /// \brief Returns the AOV buffers of the image last rendered. Only
+  /// the buffers of the AOVs set (and of the features used to denoise
+  /// the image) are filled; the others are empty.
+  const auto& aovBuffers() const
+  {
+    return _aovBuffers;
+  }
+
+  const auto& region() const
+  {
+    return _region;
+  }
+
+  /// \brief Sets the region of the images rendered; the pixels out of
+  /// it are black. An empty region stands for the whole image.
+  void setRegion(const Region& region)
+  {
+    _region = region;
+  }
+
+  const auto& checkpointFile() const
+  {
+    return _checkpointFile;
+  }
+
+  /// \brief Sets the file to which the tiles finished, along with
+  /// their samples, are saved every \c interval seconds and when the
+  /// image is finished. An empty file name disables checkpoints.
+  void setCheckpoint(const char* filename, float interval = 60)
+  {
+    _checkpointFile = filename;
+    _checkpointInterval = clock_t(std::max(interval, 0.0f) * CLOCKS_PER_SEC);
+  }
+
+  auto resuming() const
+  {
+    return _resuming;
+  }
+
+  /// \brief Sets whether the tiles saved in the checkpoint file are
+  /// restored instead of rendered again. The file is ignored if the
+  /// image size, region, sampling, AOVs, camera or scene differ from
+  /// the current ones. Scenes are compared by the transforms,
+  /// materials and mesh sizes of their visible primitives, by their
+  /// lights, and by their background and ambient colors.
+  void setResuming(bool resuming)
+  {
+    _resuming = resuming;
+  }
+
+  /// \brief Sets a writer to which the rows of the images rendered
+  /// are written as they are finished.
+  void setOutput(ImageWriter* output)
+  {
+    _output = output;
+  }
+
+  /// Returns the statistics of the image last rendered.
+  Statistics statistics() const;
+
   void render();
   virtual void renderImage(Image&);
 
+  /// \brief Resolves the image last rendered into \c image (e.g.,
+  /// after changing the tone mapping) without tracing it again.
+  void resolve(Image& image) const;
+
+  /// \brief Returns the buffer from which the image last rendered is
+  /// resolved (denoised, if so).
+  const AccumulationBuffer& output() const
+  {
+    return _denoised.width() != 0 ? _denoised : _buffer;
+  }
+
 private:
   struct VRC
   {
@@ -97,7 +302,41 @@ private:
   float _minWeight;
   uint64_t _numberOfRays;
   uint64_t _numberOfHits;
+  uint64_t _numberOfSamples;
+  clock_t _bvhTime{};
+  clock_t _renderTime{};
+  int _baseSamples{1};
+  int _maxSamples{1};
+  float _tolerance{0.01f};
+  int _strata[MAX_SAMPLES];
   Ray _pixelRay;
+  Reference<SceneBVH> _sceneBVH;
+  LightTable _lights;
+  LightTable::Incidence _incidence;
+  AccumulationBuffer _buffer;
+  AccumulationBuffer::Layout _bufferLayout{};
+  bool _denoising{};
+  Denoiser _denoiser;
+  AccumulationBuffer _denoised;
+  AOVs _aovs;
+  AOVs _activeAOVs; // AOVs set plus features to denoise
+  Intersection _primaryHit; // of the last sample shot
+  AOVBuffers _aovBuffers;
+  std::unordered_map<const Primitive*, int32_t> _objectIds;
+  Region _region{};
+  Region _scanRegion; // region clipped to the image
+  int _tilesPerRow;
+  int _tileX; // origin of the tiles, aligned to the buffer blocks
+  int _tileY;
+  std::vector<uint8_t> _tilesDone;
+  std::string _checkpointFile;
+  uint64_t _cameraHash; // of the image being rendered
+  uint64_t _sceneHash;
+  clock_t _checkpointInterval{60 * CLOCKS_PER_SEC};
+  clock_t _lastCheckpoint;
+  bool _resuming{};
+  ToneMapping _toneMapping;
+  Reference<ImageWriter> _output;
   VRC _vrc;
   float _Vh;
   float _Vw;
@@ -105,16 +344,28 @@ private:
   float _Iw;
 
   void scan(Image& image);
+  void initTiles();
+  Region tile(int t) const;
+  void renderTile(int t);
+  bool saveCheckpoint();
+  bool loadCheckpoint();
+  void hashView();
+  void initAOVs();
+  void numberObjects(SceneNode* node, int32_t& id);
+  void addAOVs(int i, int j);
+  void resolveAOVs();
+  void samplePixel(int i, int j);
+  void addSample(int i, int j, float x, float y);
+  void denoise(Image& image);
+  bool converged(int i, int j) const;
+  void writeOutput(int j, const ImageBuffer& scanLine);
   void setPixelRay(float x, float y);
   Color shoot(float x, float y);
   bool intersect(const Ray&, Intersection&);
-  void recursiveIntersect(const Ray&, Intersection&, SceneNode*);
-  bool intersectBVH(const Ray& ray, BVH* bvh);
   Color trace(const Ray& ray, uint32_t level, float weight);
   Color shade(const Ray&, Intersection&, int, float);
   bool shadow(const Ray&);
   Color background() const;
-  BVHMap bvhMap;
 
   vec3f imageToWindow(float x, float y) const
   {
@@ -69,7 +69,19 @@ public:
     return _root;
   }
 
+  /// Returns the change journal of this scene.
+  const auto& journal() const
+  {
+    return _journal;
+  }
+
+  auto& journal()
+  {
+    return _journal;
+  }
+
 private:
+  SceneJournal _journal;
   SceneObject* _root;
 
 }; // Scene
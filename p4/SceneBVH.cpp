@@ -0,0 +1,327 @@
+//[]---------------------------------------------------------------[]
+//|                                                                 |
+//| Copyright (C) 2019 Orthrus Group.                               |
+//|                                                                 |
+//| This software is provided 'as-is', without any express or       |
+//| implied warranty. In no event will the authors be held liable   |
+//| for any damages arising from the use of this software.          |
+//|                                                                 |
+//| Permission is granted to anyone to use this software for any    |
+//| purpose, including commercial applications, and to alter it and |
+//| redistribute it freely, subject to the following restrictions:  |
+//|                                                                 |
+//| 1. The origin of this software must not be misrepresented; you  |
+//| must not claim that you wrote the original software. If you use |
+//| this software in a product, an acknowledgment in the product    |
+//| documentation would be appreciated but is not required.         |
+//|                                                                 |
+//| 2. Altered source versions must be plainly marked as such, and  |
+//| must not be misrepresented as being the original software.      |
+//|                                                                 |
+//| 3. This notice may not be removed or altered from any source    |
+//| distribution.                                                   |
+//|                                                                 |
+//[]---------------------------------------------------------------[]
+//
+// OVERVIEW: SceneBVH.cpp
+// ========
+// Source file for scene BVH.
+//
+// Author(s): Paulo Pagliosa (and your name)
+// Last revision: 19/10/2026
+
+#include "Primitive.h"
+#include "SceneBVH.h"
+
+namespace cg
+{ // begin namespace cg
+
+inline auto
+splitAxis(const Bounds3f& b)
+{
+  auto s = b.size();
+  return s.x > s.y && s.x > s.z ? 0 : (s.y > s.z ? 1 : 2);
+}
+
+
+/////////////////////////////////////////////////////////////////////
+//
+// SceneBVH implementation
+// ========
+SceneBVH::SceneBVH(Scene& scene, int maxPrimitivesPerNode):
+  _scene{&scene},
+  _maxPrimitivesPerNode{maxPrimitivesPerNode}
+{
+  // do nothing
+}
+
+void
+SceneBVH::collect(SceneNode* node)
+{
+  auto it = node->objectIterator();
+
+  for (auto object = it->start(); object != nullptr; object = it->next())
+  {
+    auto component = object->getComponent("Primitive");
+    auto primitive = dynamic_cast<Primitive*>(component);
+
+    if (primitive != nullptr && object->visible)
+    {
+      auto bvh = primitive->bvh();
+      Bounds3f localBounds;
+
+      if (primitive->localBounds(localBounds, bvh))
+      {
+        const auto& m = object->transform()->localToWorldMatrix();
+        Bounds3f bounds{localBounds, m};
+
+        _entries.push_back({primitive, bvh, bounds, bounds.center()});
+      }
+    }
+    collect(object);
+  }
+  it->dispose();
+}
+
+int
+SceneBVH::makeNode(int start, int end)
+{
+  auto index = int(_nodes.size());
+  Bounds3f bounds;
+  Bounds3f centroidBounds;
+
+  _nodes.emplace_back();
+  for (int i = start; i < end; ++i)
+  {
+    bounds.inflate(_entries[i].bounds);
+    centroidBounds.inflate(_entries[i].centroid);
+  }
+
+  auto dim = splitAxis(centroidBounds);
+
+  if (end - start <= _maxPrimitivesPerNode ||
+    centroidBounds.max()[dim] == centroidBounds.min()[dim])
+  {
+    _nodes[index] = {bounds, start, end - start, 0};
+    return index;
+  }
+
+  auto mid = (start + end) / 2;
+
+  std::nth_element(_entries.begin() + start,
+    _entries.begin() + mid,
+    _entries.begin() + end,
+    [dim] (const Entry& a, const Entry& b)
+    {
+      return a.centroid[dim] < b.centroid[dim];
+    });
+  makeNode(start, mid);
+
+  auto second = makeNode(mid, end);
+
+  _nodes[index] = {bounds, second, 0, dim};
+  return index;
+}
+
+void
+SceneBVH::build()
+{
+  _entries.clear();
+  _nodes.clear();
+  _entryOf.clear();
+  _version = _scene->journal().version();
+  _built = true;
+  collect(_scene);
+  if (_entries.empty())
+    return;
+  _nodes.reserve(2 * _entries.size());
+  makeNode(0, size());
+
+  // Links used by refit()
+  auto nodeCount = int(_nodes.size());
+
+  _parents.assign(nodeCount, -1);
+  _leaves.resize(_entries.size());
+  for (int i = 0; i < nodeCount; ++i)
+  {
+    const auto& node = _nodes[i];
+
+    if (!node.isLeaf())
+      _parents[i + 1] = _parents[node.offset] = i;
+    else
+      for (int k = node.offset, e = node.offset + node.count; k < e; ++k)
+        _leaves[k] = i;
+  }
+  for (int i = 0, n = size(); i < n; ++i)
+    _entryOf[_entries[i].primitive->sceneObject()] = i;
+}
+
+void
+SceneBVH::update()
+{
+  if (!_built)
+  {
+    build();
+    return;
+  }
+
+  auto rebuild = false;
+  std::vector<int> moved;
+  auto synced = _scene->journal().changesSince(_version,
+    [&] (const SceneJournal::Entry& e)
+    {
+      using Event = SceneJournal::Event;
+
+      switch (e.event)
+      {
+        case Event::Material:
+        case Event::Light:
+          break;
+        case Event::Transform:
+        case Event::Mesh:
+          if (auto object = SceneObject::get(e.object))
+          {
+            auto eit = _entryOf.find(object);
+
+            if (eit != _entryOf.end())
+              moved.push_back(eit->second);
+            // A primitive may have got its first mesh
+            else if (e.event == Event::Mesh)
+              rebuild = true;
+          }
+          break;
+        default:
+          rebuild = true;
+      }
+    });
+
+  if (!synced || rebuild)
+  {
+    build();
+    return;
+  }
+  _version = _scene->journal().version();
+  if (moved.empty())
+    return;
+  std::sort(moved.begin(), moved.end());
+  moved.erase(std::unique(moved.begin(), moved.end()), moved.end());
+  // Refitting many entries costs more and degrades the tree
+  if (moved.size() * 4 > _entries.size())
+    build();
+  else
+    refit(moved);
+}
+
+void
+SceneBVH::refit(const std::vector<int>& entries)
+{
+  for (auto i : entries)
+  {
+    auto& entry = _entries[i];
+    Bounds3f localBounds;
+
+    // The mesh of the primitive may have changed
+    entry.bvh = entry.primitive->bvh();
+    if (!entry.primitive->localBounds(localBounds, entry.bvh))
+    {
+      build();
+      return;
+    }
+
+    const auto& m = entry.primitive->transform()->localToWorldMatrix();
+
+    entry.bounds = Bounds3f{localBounds, m};
+    entry.centroid = entry.bounds.center();
+  }
+  // Refit the leaves of the entries and their ancestors
+  for (auto i : entries)
+    for (auto index = _leaves[i]; index >= 0; index = _parents[index])
+    {
+      auto& node = _nodes[index];
+      Bounds3f bounds;
+
+      if (node.isLeaf())
+        for (int k = node.offset, e = node.offset + node.count; k < e; ++k)
+          bounds.inflate(_entries[k].bounds);
+      else
+      {
+        bounds.inflate(_nodes[index + 1].bounds);
+        bounds.inflate(_nodes[node.offset].bounds);
+      }
+      node.bounds = bounds;
+    }
+}
+
+Bounds3f
+SceneBVH::bounds() const
+{
+  return _nodes.empty() ? Bounds3f{} : _nodes[0].bounds;
+}
+
+void
+SceneBVH::iterate(int index, BVHNodeFunction f) const
+{
+  const auto& node = _nodes[index];
+  auto isLeaf = node.isLeaf();
+
+  f({node.bounds, isLeaf, node.offset, node.count});
+  if (!isLeaf)
+  {
+    iterate(index + 1, f);
+    iterate(node.offset, f);
+  }
+}
+
+void
+SceneBVH::iterate(BVHNodeFunction f) const
+{
+  if (!_nodes.empty())
+    iterate(0, f);
+}
+
+bool
+SceneBVH::intersect(const Ray& ray, Intersection& hit) const
+{
+  hit.object = nullptr;
+  hit.distance = ray.tMax;
+  if (_nodes.empty())
+    return false;
+
+  const auto invDir = ray.direction.inverse();
+  const int dirIsNeg[3]{invDir.x < 0, invDir.y < 0, invDir.z < 0};
+  int stack[64];
+  int top{0};
+  int current{0};
+
+  for (;;)
+  {
+    const auto& node = _nodes[current];
+
+    if (intersectBounds(node.bounds, ray, invDir, dirIsNeg, hit.distance))
+    {
+      if (!node.isLeaf())
+      {
+        if (dirIsNeg[node.axis])
+        {
+          stack[top++] = current + 1;
+          current = node.offset;
+        }
+        else
+        {
+          stack[top++] = node.offset;
+          current = current + 1;
+        }
+        continue;
+      }
+      // Refine against the mesh BVHs; hit.distance shrinks on every hit
+      for (int i = node.offset, e = node.offset + node.count; i < e; ++i)
+        _entries[i].primitive->intersect(ray, hit, _entries[i].bvh);
+    }
+    if (top == 0)
+      break;
+    current = stack[--top];
+  }
+  return hit.object != nullptr;
+}
+
+} // end namespace cg
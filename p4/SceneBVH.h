@@ -0,0 +1,131 @@
+//[]---------------------------------------------------------------[]
+//|                                                                 |
+//| Copyright (C) 2019 Orthrus Group.                               |
+//|                                                                 |
+//| This software is provided 'as-is', without any express or       |
+//| implied warranty. In no event will the authors be held liable   |
+//| for any damages arising from the use of this software.          |
+//|                                                                 |
+//| Permission is granted to anyone to use this software for any    |
+//| purpose, including commercial applications, and to alter it and |
+//| redistribute it freely, subject to the following restrictions:  |
+//|                                                                 |
+//| 1. The origin of this software must not be misrepresented; you  |
+//| must not claim that you wrote the original software. If you use |
+//| this software in a product, an acknowledgment in the product    |
+//| documentation would be appreciated but is not required.         |
+//|                                                                 |
+//| 2. Altered source versions must be plainly marked as such, and  |
+//| must not be misrepresented as being the original software.      |
+//|                                                                 |
+//| 3. This notice may not be removed or altered from any source    |
+//| distribution.                                                   |
+//|                                                                 |
+//[]---------------------------------------------------------------[]
+//
+// OVERVIEW: SceneBVH.h
+// ========
+// Class definition for scene BVH.
+//
+// Author(s): Paulo Pagliosa (and your name)
+// Last revision: 19/10/2026
+
+#ifndef __SceneBVH_h
+#define __SceneBVH_h
+
+#include "BVH.h"
+#include "Scene.h"
+#include <unordered_map>
+
+namespace cg
+{ // begin namespace cg
+
+
+/////////////////////////////////////////////////////////////////////
+//
+// SceneBVH: scene BVH class
+// ========
+//
+// Top-level BVH over the world bounds of the visible primitives of a
+// scene. Rays reaching a leaf are refined against the BVH of the mesh
+// of each primitive in the leaf (see BVHCache). The BVH is kept in
+// sync with the scene by pulling the changes recorded in the scene
+// journal: moved primitives are refitted, and structural changes
+// (objects or components added or removed) trigger a rebuild.
+//
+class SceneBVH: public SharedObject
+{
+public:
+  SceneBVH(Scene& scene, int maxPrimitivesPerNode = 4);
+
+  auto scene() const
+  {
+    return _scene;
+  }
+
+  auto size() const
+  {
+    return int(_entries.size());
+  }
+
+  /// Rebuilds this BVH from the current state of the scene.
+  void build();
+
+  /// Applies the scene changes made since the last build or update.
+  void update();
+
+  Bounds3f bounds() const;
+  void iterate(BVHNodeFunction f) const;
+
+  /// \brief Intersects a ray, given in world space, with the scene.
+  /// If the ray hits any primitive, the primitive, triangle index,
+  /// distance and barycentric coordinates of the closest hit are
+  /// stored in \c hit and true is returned.
+  bool intersect(const Ray& ray, Intersection& hit) const;
+
+private:
+  struct Entry
+  {
+    Primitive* primitive;
+    // BVH of the mesh of the primitive, resolved when the entry is
+    // made or refitted, so that rays do not look up the BVH cache
+    const BVH* bvh;
+    Bounds3f bounds;
+    vec3f centroid;
+
+  }; // Entry
+
+  struct Node
+  {
+    Bounds3f bounds;
+    int offset; // first entry (leaf) or second child (interior node)
+    int count; // number of entries (0 for interior nodes)
+    int axis; // split axis (interior nodes only)
+
+    bool isLeaf() const
+    {
+      return count > 0;
+    }
+
+  }; // Node
+
+  Reference<Scene> _scene;
+  std::vector<Entry> _entries;
+  std::vector<Node> _nodes;
+  std::vector<int> _parents; // parent of each node (-1 for the root)
+  std::vector<int> _leaves; // leaf of each entry
+  std::unordered_map<const SceneObject*, int> _entryOf;
+  int _maxPrimitivesPerNode;
+  uint64_t _version{};
+  bool _built{};
+
+  void collect(SceneNode*);
+  int makeNode(int start, int end);
+  void refit(const std::vector<int>& entries);
+  void iterate(int, BVHNodeFunction) const;
+
+}; // SceneBVH
+
+} // end namespace cg
+
+#endif // __SceneBVH_h
@@ -0,0 +1,74 @@
+//[]---------------------------------------------------------------[]
+//|                                                                 |
+//| Copyright (C) 2019 Orthrus Group.                               |
+//|                                                                 |
+//| This software is provided 'as-is', without any express or       |
+//| implied warranty. In no event will the authors be held liable   |
+//| for any damages arising from the use of this software.          |
+//|                                                                 |
+//| Permission is granted to anyone to use this software for any    |
+//| purpose, including commercial applications, and to alter it and |
+//| redistribute it freely, subject to the following restrictions:  |
+//|                                                                 |
+//| 1. The origin of this software must not be misrepresented; you  |
+//| must not claim that you wrote the original software. If you use |
+//| this software in a product, an acknowledgment in the product    |
+//| documentation would be appreciated but is not required.         |
+//|                                                                 |
+//| 2. Altered source versions must be plainly marked as such, and  |
+//| must not be misrepresented as being the original software.      |
+//|                                                                 |
+//| 3. This notice may not be removed or altered from any source    |
+//| distribution.                                                   |
+//|                                                                 |
+//[]---------------------------------------------------------------[]
+//
+// OVERVIEW: SceneJournal.cpp
+// ========
+// Source file for scene change journal.
+//
+// Author(s): Paulo Pagliosa (and your name)
+// Last revision: 19/10/2026
+
+#include "SceneJournal.h"
+#include "SceneObject.h"
+
+namespace cg
+{ // begin namespace cg
+
+
+/////////////////////////////////////////////////////////////////////
+//
+// SceneJournal implementation
+// ============
+SceneJournal::SceneJournal(int capacity):
+  _entries(capacity > 0 ? capacity : 1)
+{
+  // do nothing
+}
+
+void
+SceneJournal::record(Event event, const SceneObject* object)
+{
+  auto handle = object->handle();
+
+  if (_count > 0)
+  {
+    auto& last = entry(_count - 1);
+
+    if (last.event == event && last.object == handle)
+    {
+      last.version = ++_version;
+      return;
+    }
+  }
+  if (_count == capacity())
+  {
+    _dropped = entry(0).version;
+    _head = (_head + 1) % capacity();
+    --_count;
+  }
+  entry(_count++) = {++_version, event, handle};
+}
+
+} // end namespace cg
@@ -0,0 +1,146 @@
+//[]---------------------------------------------------------------[]
+//|                                                                 |
+//| Copyright (C) 2019 Orthrus Group.                               |
+//|                                                                 |
+//| This software is provided 'as-is', without any express or       |
+//| implied warranty. In no event will the authors be held liable   |
+//| for any damages arising from the use of this software.          |
+//|                                                                 |
+//| Permission is granted to anyone to use this software for any    |
+//| purpose, including commercial applications, and to alter it and |
+//| redistribute it freely, subject to the following restrictions:  |
+//|                                                                 |
+//| 1. The origin of this software must not be misrepresented; you  |
+//| must not claim that you wrote the original software. If you use |
+//| this software in a product, an acknowledgment in the product    |
+//| documentation would be appreciated but is not required.         |
+//|                                                                 |
+//| 2. Altered source versions must be plainly marked as such, and  |
+//| must not be misrepresented as being the original software.      |
+//|                                                                 |
+//| 3. This notice may not be removed or altered from any source    |
+//| distribution.                                                   |
+//|                                                                 |
+//[]---------------------------------------------------------------[]
+//
+// OVERVIEW: SceneJournal.h
+// ========
+// Class definition for scene change journal.
+//
+// Author(s): Paulo Pagliosa (and your name)
+// Last revision: 19/10/2026
+
+#ifndef __SceneJournal_h
+#define __SceneJournal_h
+
+#include "core/ObjectPool.h"
+#include <vector>
+
+namespace cg
+{ // begin namespace cg
+
+// Forward definition
+class SceneObject;
+
+
+/////////////////////////////////////////////////////////////////////
+//
+// SceneJournal: scene change journal class
+// ============
+//
+// Bounded log of the changes made to the objects of a scene. Every
+// change is stamped with a monotonically increasing version, so each
+// consumer (renderer, BVH, ...) keeps the version it last synced to
+// and pulls only the changes made since then. Consumers falling more
+// than capacity() changes behind must resync from the whole scene.
+//
+class SceneJournal
+{
+public:
+  enum class Event
+  {
+    Transform,
+    Mesh,
+    Material,
+    Light,
+    Visibility,
+    ObjectAdded,
+    ObjectRemoved,
+    ComponentAdded,
+    ComponentRemoved
+  };
+
+  struct Entry
+  {
+    uint64_t version;
+    Event event;
+    PoolHandle<SceneObject> object;
+
+  }; // Entry
+
+  /// Constructs an empty journal.
+  SceneJournal(int capacity = 4096);
+
+  /// Returns the version of the latest change.
+  auto version() const
+  {
+    return _version;
+  }
+
+  auto capacity() const
+  {
+    return int(_entries.size());
+  }
+
+  /// \brief Records a change of an object. Repeating the latest
+  /// change restamps it instead of adding a new entry, so continuous
+  /// edits (e.g., dragging a slider) use a single entry.
+  void record(Event event, const SceneObject* object);
+
+  /// \brief Calls \c f for every change made after \c version, from
+  /// the oldest to the newest. Returns false, without calling f, if
+  /// some of these changes were already dropped from the journal.
+  template <typename F>
+  bool changesSince(uint64_t version, F f) const;
+
+private:
+  std::vector<Entry> _entries; // ring buffer
+  int _head{};
+  int _count{};
+  uint64_t _version{};
+  uint64_t _dropped{};
+
+  auto& entry(int i)
+  {
+    return _entries[(_head + i) % _entries.size()];
+  }
+
+  const auto& entry(int i) const
+  {
+    return _entries[(_head + i) % _entries.size()];
+  }
+
+}; // SceneJournal
+
+template <typename F>
+bool
+SceneJournal::changesSince(uint64_t version, F f) const
+{
+  if (version >= _version)
+    return true;
+  if (version < _dropped)
+    return false;
+
+  // Entries are sorted by version: find the oldest one to report
+  auto i = _count;
+
+  while (i > 0 && entry(i - 1).version > version)
+    --i;
+  for (; i < _count; ++i)
+    f(entry(i));
+  return true;
+}
+
+} // end namespace cg
+
+#endif // __SceneJournal_h
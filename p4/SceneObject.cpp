@@ -36,6 +36,8 @@
 namespace cg
 { // begin namespace cg
 
+DEFINE_POOL_ALLOCATED(SceneObject)
+
 
 /////////////////////////////////////////////////////////////////////
 //
@@ -49,6 +51,7 @@ namespace cg
         _previous = _next = nullptr;
         scene->addChildSceneObject(this);
         _components = new ComponentList(this);
+        recordChange(SceneJournal::Event::ObjectAdded);
     }
 
     SceneObject::SceneObject(const char* name, Scene& scene) :
@@ -59,6 +62,7 @@ namespace cg
         _previous = _next = nullptr;
         _scene->addChildSceneObject(this);
         _components = new ComponentList(this);
+        recordChange(SceneJournal::Event::ObjectAdded);
     }
 
     SceneObject::SceneObject(const char* name, SceneObject* sceneObject) :
@@ -69,6 +73,7 @@ namespace cg
         _previous = _next = nullptr;
         sceneObject->addChildSceneObject(this);
         _components = new ComponentList(this);
+        recordChange(SceneJournal::Event::ObjectAdded);
     }
 
     void
@@ -105,8 +110,22 @@ namespace cg
         this->transform()->update();
     }
 
+    void
+        SceneObject::recordChange(SceneJournal::Event event)
+    {
+        if (_scene != nullptr)
+            _scene->journal().record(event, this);
+    }
+
     SceneObject::~SceneObject() {
         delete _components;
     }
 
+    void
+        Component::recordChange(SceneJournal::Event event)
+    {
+        if (_sceneObject != nullptr)
+            _sceneObject->recordChange(event);
+    }
+
 } // end namespace cg
@@ -28,7 +28,7 @@
 // Class definition for scene object.
 //
 // Author(s): Paulo Pagliosa (and your name)
-// Last revision: 23/09/2019
+// Last revision: 19/10/2026
 
 #ifndef __SceneObject_h
 #define __SceneObject_h
@@ -51,6 +51,8 @@ class Scene;
 class SceneObject: public SceneNode
 {
 public:
+  DECLARE_POOL_ALLOCATED(SceneObject);
+
   bool visible{true};
 
   /// Constructs an empty scene object.
@@ -77,10 +79,13 @@ public:
   /// Sets the parent of this scene object.
   void setParent(SceneObject* parent);
 
+  /// Records a change of this scene object in the scene journal.
+  void recordChange(SceneJournal::Event event);
+
   /// Returns the transform of this scene object.
-  auto transform() const
+  const Transform* transform() const
   {
-    return &_transform;
+    return _transform;
   }
 
   auto transform()
@@ -93,6 +98,7 @@ public:
       if (_components->getComponent(component->typeName()) == nullptr) {
           _components->add(component);
           component->_sceneObject = this;
+          recordChange(SceneJournal::Event::ComponentAdded);
           return true;
       }
       else {
@@ -106,6 +112,7 @@ public:
 
   /// Remove a component from this object's list.
   inline void removeComponent(Component* component) {
+      recordChange(SceneJournal::Event::ComponentRemoved);
       _components->remove(component);
   }
 
@@ -136,6 +143,12 @@ Component::transform() // declared in Component.h
   return sceneObject()->transform();
 }
 
+inline const Transform*
+Component::transform() const // declared in Component.h
+{
+  return sceneObject()->transform();
+}
+
 /// Returns the parent of a transform.
 inline Transform*
 Transform::parent() const // declared in Transform.h
@@ -3,6 +3,9 @@
 
 namespace cg {
 
+	DEFINE_POOL_ALLOCATED(SceneObjectList)
+	DEFINE_POOL_ALLOCATED(SceneObjectListIterator)
+
 	SceneObjectList::SceneObjectList(SceneNode* parent) {
 		_parent = parent;
 		_head = _tail = nullptr;
@@ -1,6 +1,8 @@
 #ifndef __SceneObjectList_h
 #define __SceneObjectList_h
 
+#include "core/ObjectPool.h"
+
 namespace cg {
 class SceneObject;
 class SceneNode;
@@ -8,6 +10,7 @@ class SceneNode;
 //favor performance over memory -> double linked list
 class SceneObjectList {
 public:
+	DECLARE_POOL_ALLOCATED(SceneObjectList);
 	
 
 	SceneObjectList(SceneNode* parent);
@@ -41,6 +44,7 @@ private:
 
 class SceneObjectListIterator {
 public:
+	DECLARE_POOL_ALLOCATED(SceneObjectListIterator);
 
 	//returns a pointer to the object the iterator is currently referencing
 	SceneObject* getReference() {
@@ -0,0 +1,161 @@
+//[]---------------------------------------------------------------[]
+//|                                                                 |
+//| Copyright (C) 2019 Orthrus Group.                               |
+//|                                                                 |
+//| This software is provided 'as-is', without any express or       |
+//| implied warranty. In no event will the authors be held liable   |
+//| for any damages arising from the use of this software.          |
+//|                                                                 |
+//| Permission is granted to anyone to use this software for any    |
+//| purpose, including commercial applications, and to alter it and |
+//| redistribute it freely, subject to the following restrictions:  |
+//|                                                                 |
+//| 1. The origin of this software must not be misrepresented; you  |
+//| must not claim that you wrote the original software. If you use |
+//| this software in a product, an acknowledgment in the product    |
+//| documentation would be appreciated but is not required.         |
+//|                                                                 |
+//| 2. Altered source versions must be plainly marked as such, and  |
+//| must not be misrepresented as being the original software.      |
+//|                                                                 |
+//| 3. This notice may not be removed or altered from any source    |
+//| distribution.                                                   |
+//|                                                                 |
+//[]---------------------------------------------------------------[]
+//
+// OVERVIEW: ScenePresets.cpp
+// ========
+// Source file for scene presets.
+//
+// Author(s): Paulo Pagliosa (and your name)
+// Last revision: 19/10/2026
+
+#include "Camera.h"
+#include "Light.h"
+#include "ScenePresets.h"
+
+namespace cg
+{ // begin namespace cg
+
+Scene*
+makeScenePreset(int index, const MeshMap& meshes, SceneObject*& camera)
+{
+    Scene* scene{};
+
+
+    if (index == 1) {
+        scene = new Scene{ "Room" };
+
+        //makes room
+        SceneObject* room = new SceneObject("Room", scene);
+
+        SceneObject* floor = new SceneObject("Floor", room);
+        floor->addComponent(makePrimitive(meshes.find("Box")));
+        Primitive* prim = dynamic_cast<Primitive*>(floor->getComponent("Primitive"));
+        prim->material.diffuse = Color::darkGray;
+        prim->material.spot = Color::white;
+        floor->transform()->setLocalPosition(vec3f(0, -1.3, 0));
+        floor->transform()->setLocalScale(vec3f(4, 0.2, 4));
+
+        SceneObject* wall1 = new SceneObject("Wall 1", room);
+        wall1->addComponent(makePrimitive(meshes.find("Box")));
+        prim = dynamic_cast<Primitive*>(wall1->getComponent("Primitive"));
+        prim->material.diffuse = Color::white;
+        prim->material.spot = Color::blue;
+        wall1->transform()->setLocalPosition(vec3f(-3.9, 2.6, 0));
+        wall1->transform()->setLocalScale(vec3f(0.2, 4, 4));
+
+        SceneObject* wall2 = new SceneObject("Wall 2", room);
+        wall2->addComponent(makePrimitive(meshes.find("Box")));
+        prim = dynamic_cast<Primitive*>(wall2->getComponent("Primitive"));
+        prim->material.diffuse = Color::white;
+        prim->material.spot = Color::red;
+        prim->material.shine = 2;
+        wall2->transform()->setLocalPosition(vec3f(0, 2.6, -4));
+        wall2->transform()->setLocalScale(vec3f(4, 4, 0.2));
+
+
+        //place ball, camera and lights
+        SceneObject* rootObject1 = new SceneObject("Object 1", scene);
+        rootObject1->addComponent(makePrimitive(meshes.find("Sphere")));
+        prim = dynamic_cast<Primitive*>(rootObject1->getComponent("Primitive"));
+        prim->material.diffuse = Color::red;
+        prim->material.spot = Color::white;
+
+        SceneObject* mainCamera = new SceneObject("Main Camera", scene);
+        mainCamera->addComponent(new Camera);
+        mainCamera->transform()->setLocalPosition(vec3f(0, 2, 4));
+        mainCamera->transform()->setLocalEulerAngles(vec3f(-27, 0, 0));
+
+        SceneObject* pointLight = new SceneObject("Point Light", scene);
+        Light* light = new Light();
+        light->setType(Light::Point);
+        light->setFalloff(0.5);
+        pointLight->addComponent(light);
+        pointLight->transform()->setLocalPosition(vec3f(1, 2.7, 4.4));
+        pointLight->transform()->setLocalEulerAngles(vec3f(-150, 0, 0));
+        camera = mainCamera;
+    }
+    else if (index == 2) {
+        scene = new Scene{ "Balls" };
+
+        SceneObject* ball1 = new SceneObject("Ball 1", scene);
+        ball1->transform()->setLocalPosition(vec3f(-1, 0, -1));
+        ball1->addComponent(makePrimitive(meshes.find("Sphere")));
+        Primitive* prim = dynamic_cast<Primitive*>(ball1->getComponent("Primitive"));
+        prim->material.diffuse = Color::red;
+        prim->material.spot = Color::white;
+
+        SceneObject* ball2 = new SceneObject("Ball 2", scene);
+        ball2->transform()->setLocalPosition(vec3f(2, 0, 0));
+        ball2->addComponent(makePrimitive(meshes.find("Sphere")));
+        prim = dynamic_cast<Primitive*>(ball2->getComponent("Primitive"));
+        prim->material.diffuse = Color::green;
+        prim->material.spot = Color::white;
+
+        SceneObject* ball3 = new SceneObject("Ball 3", scene);
+        ball3->transform()->setLocalPosition(vec3f(0, 0, 2));
+        ball3->addComponent(makePrimitive(meshes.find("Sphere")));
+        prim = dynamic_cast<Primitive*>(ball3->getComponent("Primitive"));
+        prim->material.diffuse = Color::blue;
+        prim->material.spot = Color::white;
+
+        SceneObject* mainCamera = new SceneObject("Main Camera", scene);
+        mainCamera->addComponent(new Camera);
+        mainCamera->transform()->setLocalPosition(vec3f(0, 2, 4));
+        mainCamera->transform()->setLocalEulerAngles(vec3f(-27, 0, 0));
+
+        SceneObject* pointLight = new SceneObject("Point Light", scene);
+        Light* light = new Light();
+        light->setType(Light::Point);
+        pointLight->addComponent(light);
+        pointLight->transform()->setLocalPosition(vec3f(0, 2.7, 4.4));
+        pointLight->transform()->setLocalEulerAngles(vec3f(-150, 0, 0));
+        camera = mainCamera;
+    }
+    else if (index == 3) {
+        scene = new Scene{ "Scene 3" };
+
+        SceneObject* rootObject1 = new SceneObject("Object 1", scene);
+        rootObject1->addComponent(makePrimitive(meshes.find("Sphere")));
+        Primitive* prim = dynamic_cast<Primitive*>(rootObject1->getComponent("Primitive"));
+        prim->material.diffuse = Color::red;
+        prim->material.spot = Color::white;
+
+        SceneObject* mainCamera = new SceneObject("Main Camera", scene);
+        mainCamera->addComponent(new Camera);
+        mainCamera->transform()->setLocalPosition(vec3f(0, 2, 4));
+        mainCamera->transform()->setLocalEulerAngles(vec3f(-27, 0, 0));
+
+        SceneObject* pointLight = new SceneObject("Point Light", scene);
+        Light* light = new Light();
+        light->setType(Light::Point);
+        pointLight->addComponent(light);
+        pointLight->transform()->setLocalPosition(vec3f(0, 2.7, 4.4));
+        pointLight->transform()->setLocalEulerAngles(vec3f(-150, 0, 0));
+        camera = mainCamera;
+    }
+    return scene;
+}
+
+} // end namespace cg
@@ -0,0 +1,58 @@
+//[]---------------------------------------------------------------[]
+//|                                                                 |
+//| Copyright (C) 2019 Orthrus Group.                               |
+//|                                                                 |
+//| This software is provided 'as-is', without any express or       |
+//| implied warranty. In no event will the authors be held liable   |
+//| for any damages arising from the use of this software.          |
+//|                                                                 |
+//| Permission is granted to anyone to use this software for any    |
+//| purpose, including commercial applications, and to alter it and |
+//| redistribute it freely, subject to the following restrictions:  |
+//|                                                                 |
+//| 1. The origin of this software must not be misrepresented; you  |
+//| must not claim that you wrote the original software. If you use |
+//| this software in a product, an acknowledgment in the product    |
+//| documentation would be appreciated but is not required.         |
+//|                                                                 |
+//| 2. Altered source versions must be plainly marked as such, and  |
+//| must not be misrepresented as being the original software.      |
+//|                                                                 |
+//| 3. This notice may not be removed or altered from any source    |
+//| distribution.                                                   |
+//|                                                                 |
+//[]---------------------------------------------------------------[]
+//
+// OVERVIEW: ScenePresets.h
+// ========
+// Class definition for scene presets.
+//
+// Author(s): Paulo Pagliosa (and your name)
+// Last revision: 19/10/2026
+
+#ifndef __ScenePresets_h
+#define __ScenePresets_h
+
+#include "Assets.h"
+#include "Primitive.h"
+#include "Scene.h"
+
+namespace cg
+{ // begin namespace cg
+
+constexpr int numberOfScenePresets = 3;
+
+inline Primitive*
+makePrimitive(MeshMapIterator mit)
+{
+  return new Primitive(mit->second, mit->first);
+}
+
+/// \brief Builds the preset scene \c index (1 to numberOfScenePresets)
+/// with the meshes named "Box" and "Sphere" in \c meshes. The main
+/// camera of the scene is returned in \c camera.
+Scene* makeScenePreset(int index, const MeshMap& meshes, SceneObject*& camera);
+
+} // end namespace cg
+
+#endif // __ScenePresets_h
@@ -0,0 +1,903 @@
+//[]---------------------------------------------------------------[]
+//|                                                                 |
+//| Copyright (C) 2019 Orthrus Group.                               |
+//|                                                                 |
+//| This software is provided 'as-is', without any express or       |
+//| implied warranty. In no event will the authors be held liable   |
+//| for any damages arising from the use of this software.          |
+//|                                                                 |
+//| Permission is granted to anyone to use this software for any    |
+//| purpose, including commercial applications, and to alter it and |
+//| redistribute it freely, subject to the following restrictions:  |
+//|                                                                 |
+//| 1. The origin of this software must not be misrepresented; you  |
+//| must not claim that you wrote the original software. If you use |
+//| this software in a product, an acknowledgment in the product    |
+//| documentation would be appreciated but is not required.         |
+//|                                                                 |
+//| 2. Altered source versions must be plainly marked as such, and  |
+//| must not be misrepresented as being the original software.      |
+//|                                                                 |
+//| 3. This notice may not be removed or altered from any source    |
+//| distribution.                                                   |
+//|                                                                 |
+//[]---------------------------------------------------------------[]
+//
+// OVERVIEW: StreamingMesh.cpp
+// ========
+// Source file for streaming mesh.
+//
+// Author(s): Paulo Pagliosa (and your name)
+// Last revision: 19/10/2026
+
+#include "StreamingMesh.h"
+#include "utils/MeshFile.h"
+#include "utils/MeshReader.h"
+#include <algorithm>
+#include <cstring>
+#include <memory>
+#include <unordered_map>
+
+namespace cg
+{ // begin namespace cg
+
+namespace internal
+{ // begin namespace internal
+
+static const char streamingMeshMagic[4]{'C', 'G', 'S', 'M'};
+constexpr uint32_t streamingMeshVersion = 1;
+
+//
+// File layout: header, chunk images (64-byte aligned), chunk table
+//
+struct StreamingMeshHeader
+{
+  char magic[4]; // "CGSM"
+  uint32_t version;
+  uint32_t byteOrder;
+  uint32_t numberOfChunks;
+  uint64_t numberOfVertices;
+  uint64_t numberOfTriangles;
+  float bounds[6];
+  uint64_t chunkTableOffset;
+
+}; // StreamingMeshHeader
+
+struct StreamingChunkInfo
+{
+  float bounds[6];
+  uint64_t firstTriangle;
+  uint64_t offset;
+  uint64_t size;
+
+}; // StreamingChunkInfo
+
+inline bool
+seekFile(FILE* file, uint64_t offset, int origin = SEEK_SET)
+{
+#ifdef _WIN32
+  return _fseeki64(file, int64_t(offset), origin) == 0;
+#else
+  return fseeko(file, off_t(offset), origin) == 0;
+#endif
+}
+
+inline uint64_t
+tellFile(FILE* file)
+{
+#ifdef _WIN32
+  return uint64_t(_ftelli64(file));
+#else
+  return uint64_t(ftello(file));
+#endif
+}
+
+inline bool
+readAt(FILE* file, uint64_t offset, void* data, size_t size)
+{
+  return seekFile(file, offset) && fread(data, 1, size, file) == size;
+}
+
+inline bool
+writeAt(FILE* file, uint64_t offset, const void* data, size_t size)
+{
+  return seekFile(file, offset) && fwrite(data, 1, size, file) == size;
+}
+
+inline void
+setBounds(float b[6], const Bounds3f& bounds)
+{
+  for (int i = 0; i < 3; ++i)
+  {
+    b[i] = bounds.min()[i];
+    b[i + 3] = bounds.max()[i];
+  }
+}
+
+inline Bounds3f
+getBounds(const float b[6])
+{
+  return {vec3f{b[0], b[1], b[2]}, vec3f{b[3], b[4], b[5]}};
+}
+
+// Files of the formats read by MeshReader are parsed; any other file
+// is taken as a binary mesh file
+inline TriangleMesh*
+readMesh(const std::string& filename)
+{
+  auto name = filename.c_str();
+
+  if (MeshReader::canRead(name))
+    return MeshReader::read(name);
+  return MeshFile::read(name);
+}
+
+//
+// Uniform grid in which the triangles are binned by centroid. Cells
+// are cubes whose size is chosen so that the number of cells does not
+// exceed a given maximum; cells are ordered along a Morton curve.
+//
+class ChunkGrid
+{
+public:
+  ChunkGrid(const Bounds3f& bounds, uint64_t maxCells):
+    _min{bounds.min()}
+  {
+    auto size = bounds.size();
+    auto lo = 0.0f;
+    auto hi = std::max(size.max(), 1.0f);
+
+    for (int i = 0; i < 64; ++i)
+    {
+      auto s = (lo + hi) * 0.5f;
+
+      if (numberOfCells(size, s) > maxCells)
+        lo = s;
+      else
+        hi = s;
+    }
+    _cellSize = hi;
+    for (int i = 0; i < 3; ++i)
+      _resolution[i] = resolution(size[i], hi);
+  }
+
+  uint64_t size() const
+  {
+    return uint64_t(_resolution[0]) * _resolution[1] * _resolution[2];
+  }
+
+  uint64_t cell(const vec3f& p) const
+  {
+    uint32_t c[3];
+
+    for (int i = 0; i < 3; ++i)
+    {
+      auto x = (p[i] - _min[i]) / _cellSize;
+
+      c[i] = x <= 0 ? 0 : std::min(uint32_t(x), _resolution[i] - 1);
+    }
+    return (uint64_t(c[2]) * _resolution[1] + c[1]) * _resolution[0] + c[0];
+  }
+
+  uint64_t mortonCode(uint64_t cell) const
+  {
+    auto x = cell % _resolution[0];
+    auto y = cell / _resolution[0] % _resolution[1];
+    auto z = cell / _resolution[0] / _resolution[1];
+
+    return spreadBits(x) | spreadBits(y) << 1 | spreadBits(z) << 2;
+  }
+
+private:
+  static constexpr uint32_t maxResolution = 1 << 21;
+
+  vec3f _min;
+  float _cellSize;
+  uint32_t _resolution[3];
+
+  static uint32_t resolution(float size, float cellSize)
+  {
+    auto n = std::ceil(size / cellSize);
+    return n < 1 ? 1 : n > maxResolution ? maxResolution : uint32_t(n);
+  }
+
+  static uint64_t numberOfCells(const vec3f& size, float cellSize)
+  {
+    uint64_t n = 1;
+
+    for (int i = 0; i < 3; ++i)
+      n *= resolution(size[i], cellSize);
+    return n;
+  }
+
+  static uint64_t spreadBits(uint64_t x)
+  {
+    x &= 0x1fffff;
+    x = (x | x << 32) & 0x1f00000000ffff;
+    x = (x | x << 16) & 0x1f0000ff0000ff;
+    x = (x | x << 8) & 0x100f00f00f00f00f;
+    x = (x | x << 4) & 0x10c30c30c30c30c3;
+    x = (x | x << 2) & 0x1249249249249249;
+    return x;
+  }
+
+}; // ChunkGrid
+
+struct TriangleRecord
+{
+  vec3f p[3];
+  vec3f n[3];
+
+  vec3f centroid() const
+  {
+    return (p[0] + p[1] + p[2]) * (1.0f / 3);
+  }
+
+}; // TriangleRecord
+
+// Triangles are spilled and read back in blocks
+constexpr size_t recordBlockSize = 1 << 14;
+
+// Appends the triangles of a mesh to a spill file
+bool
+spillMesh(FILE* file, const TriangleMesh& mesh)
+{
+  const auto& data = mesh.data();
+  auto hasNormals = mesh.hasVertexNormals();
+  std::vector<TriangleRecord> block;
+
+  block.reserve(recordBlockSize);
+  for (int i = 0; i < data.numberOfTriangles; ++i)
+  {
+    const auto& t = data.triangles[i];
+    TriangleRecord r;
+
+    for (int k = 0; k < 3; ++k)
+    {
+      r.p[k] = data.vertices[t.v[k]];
+      r.n[k] = hasNormals ? data.vertexNormals[t.v[k]] : vec3f{0, 0, 0};
+    }
+    block.push_back(r);
+    if (block.size() == recordBlockSize || i + 1 == data.numberOfTriangles)
+    {
+      if (fwrite(block.data(), sizeof r, block.size(), file) != block.size())
+        return false;
+      block.clear();
+    }
+  }
+  return true;
+}
+
+// Calls f for each of the n triangles of a spill file
+template <typename F>
+bool
+forEachRecord(FILE* file, uint64_t n, F f)
+{
+  std::vector<TriangleRecord> block(recordBlockSize);
+
+  if (!seekFile(file, 0))
+    return false;
+  for (uint64_t i = 0; i < n;)
+  {
+    auto k = size_t(std::min<uint64_t>(n - i, recordBlockSize));
+
+    if (fread(block.data(), sizeof(TriangleRecord), k, file) != k)
+      return false;
+    for (size_t j = 0; j < k; ++j)
+      f(block[j]);
+    i += k;
+  }
+  return true;
+}
+
+struct VertexKey
+{
+  vec3f p;
+  vec3f n;
+
+  bool operator ==(const VertexKey& other) const
+  {
+    return memcmp(this, &other, sizeof(VertexKey)) == 0;
+  }
+
+}; // VertexKey
+
+struct VertexKeyHash
+{
+  size_t operator ()(const VertexKey& key) const
+  {
+    // FNV-1a
+    auto bytes = (const unsigned char*)&key;
+    uint64_t h = 14695981039346656037ull;
+
+    for (size_t i = 0; i < sizeof(VertexKey); ++i)
+      h = (h ^ bytes[i]) * 1099511628211ull;
+    return size_t(h);
+  }
+
+}; // VertexKeyHash
+
+// Welds the vertices of the triangles of a chunk into a mesh
+TriangleMesh*
+makeChunkMesh(const std::vector<TriangleRecord>& records, bool hasNormals)
+{
+  std::unordered_map<VertexKey, int, VertexKeyHash> index;
+  std::vector<VertexKey> vertices;
+  auto nt = int(records.size());
+  TriangleMesh::Data data;
+
+  index.reserve(records.size() * 2);
+  data.numberOfTriangles = nt;
+  data.triangles = new TriangleMesh::Triangle[nt];
+  for (int i = 0; i < nt; ++i)
+    for (int k = 0; k < 3; ++k)
+    {
+      VertexKey key{records[i].p[k], records[i].n[k]};
+      auto r = index.emplace(key, int(vertices.size()));
+
+      if (r.second)
+        vertices.push_back(key);
+      data.triangles[i].v[k] = r.first->second;
+    }
+
+  auto nv = int(vertices.size());
+
+  data.numberOfVertices = nv;
+  data.vertices = new vec3f[nv];
+  data.vertexNormals = hasNormals ? new vec3f[nv] : nullptr;
+  data.uv = nullptr;
+  for (int i = 0; i < nv; ++i)
+  {
+    data.vertices[i] = vertices[i].p;
+    if (hasNormals)
+      data.vertexNormals[i] = vertices[i].n;
+  }
+
+  auto mesh = new TriangleMesh{std::move(data)};
+
+  if (!hasNormals)
+    mesh->computeNormals();
+  return mesh;
+}
+
+class ChunkStorage: public SharedObject
+{
+public:
+  ChunkStorage(size_t size):
+    _data{new uint64_t[(size + 7) / 8]}
+  {
+    // do nothing
+  }
+
+  char* data()
+  {
+    return (char*)_data.get();
+  }
+
+private:
+  std::unique_ptr<uint64_t[]> _data;
+
+}; // ChunkStorage
+
+} // end namespace internal
+
+
+/////////////////////////////////////////////////////////////////////
+//
+// StreamingMesh implementation
+// =============
+bool
+StreamingMesh::build(const char* filename,
+  const std::vector<std::string>& meshFiles,
+  int trianglesPerChunk)
+{
+  using namespace internal;
+
+  if (meshFiles.empty() || trianglesPerChunk <= 0)
+    return false;
+
+  // Pass 1: parse each mesh file once, spilling its triangles to a
+  // temporary file, and find the bounds, number of triangles and
+  // presence of normals
+  auto spillFilename = std::string{filename} + ".in.tmp";
+  auto spill = fopen(spillFilename.c_str(), "w+b");
+
+  if (spill == nullptr)
+    return false;
+
+  Bounds3f bounds;
+  uint64_t nt{};
+  auto hasNormals = true;
+  auto ok = true;
+
+  for (const auto& meshFile : meshFiles)
+  {
+    Reference<TriangleMesh> mesh{readMesh(meshFile)};
+
+    if (mesh == nullptr || !spillMesh(spill, *mesh))
+    {
+      ok = false;
+      break;
+    }
+    bounds.inflate(mesh->bounds());
+    nt += mesh->data().numberOfTriangles;
+    hasNormals &= mesh->hasVertexNormals();
+  }
+  if (!ok || nt == 0)
+  {
+    fclose(spill);
+    remove(spillFilename.c_str());
+    return false;
+  }
+
+  uint64_t limit = trianglesPerChunk;
+  // About eight cells per chunk
+  auto maxCells = std::min<uint64_t>((nt + limit - 1) / limit * 8, 1 << 22);
+  ChunkGrid grid{bounds, maxCells};
+
+  // Pass 2: number of triangles per cell
+  std::vector<uint64_t> cellCount(grid.size());
+
+  ok = forEachRecord(spill, nt, [&] (const TriangleRecord& r)
+  {
+    ++cellCount[grid.cell(r.centroid())];
+  });
+
+  // Group the cells, in Morton order, into chunks. A cell larger than
+  // a chunk starts a new chunk and is split by input order
+  std::vector<std::pair<uint64_t, uint64_t>> cells;
+
+  for (uint64_t i = 0; i < cellCount.size(); ++i)
+    if (cellCount[i] > 0)
+      cells.emplace_back(grid.mortonCode(i), i);
+  std::sort(cells.begin(), cells.end());
+
+  std::vector<uint32_t> firstChunk(grid.size());
+  std::vector<uint64_t> chunkSize;
+
+  for (const auto& cell : cells)
+  {
+    auto n = cellCount[cell.second];
+
+    if (chunkSize.empty() || chunkSize.back() + n > limit)
+      chunkSize.push_back(0);
+    firstChunk[cell.second] = uint32_t(chunkSize.size() - 1);
+    for (;;)
+    {
+      auto k = std::min(n, limit - chunkSize.back());
+
+      chunkSize.back() += k;
+      if ((n -= k) == 0)
+        break;
+      chunkSize.push_back(0);
+    }
+  }
+  cells = {};
+
+  auto nc = chunkSize.size();
+  std::vector<uint64_t> chunkStart(nc + 1);
+
+  for (size_t c = 0; c < nc; ++c)
+    chunkStart[c + 1] = chunkStart[c] + chunkSize[c];
+
+  // Pass 3: spill the triangles of each chunk to a temporary file,
+  // through a write buffer per chunk
+  auto tempFilename = std::string{filename} + ".tmp";
+  auto temp = ok ? fopen(tempFilename.c_str(), "w+b") : nullptr;
+
+  if (temp == nullptr)
+  {
+    fclose(spill);
+    remove(spillFilename.c_str());
+    return false;
+  }
+
+  auto bufferSize = std::min<size_t>(std::max<size_t>((size_t(64) << 20) /
+    sizeof(TriangleRecord) / nc, 1), 256);
+  std::vector<TriangleRecord> buffers(nc * bufferSize);
+  std::vector<uint32_t> buffered(nc);
+  std::vector<uint64_t> written(nc);
+  auto flush = [&] (size_t c)
+  {
+    auto offset = (chunkStart[c] + written[c]) * sizeof(TriangleRecord);
+
+    ok &= writeAt(temp,
+      offset,
+      &buffers[c * bufferSize],
+      buffered[c] * sizeof(TriangleRecord));
+    written[c] += buffered[c];
+    buffered[c] = 0;
+  };
+
+  // Cell counts become cell cursors
+  std::fill(cellCount.begin(), cellCount.end(), 0);
+  ok &= forEachRecord(spill, nt, [&] (const TriangleRecord& record)
+  {
+    auto cell = grid.cell(record.centroid());
+    auto c = firstChunk[cell] + cellCount[cell]++ / limit;
+    auto& r = buffers[c * bufferSize + buffered[c]];
+
+    // Normals are discarded unless all meshes have them
+    r = record;
+    if (!hasNormals)
+      r.n[0] = r.n[1] = r.n[2] = vec3f{0, 0, 0};
+    if (++buffered[c] == bufferSize)
+      flush(c);
+  });
+  for (size_t c = 0; c < nc; ++c)
+    flush(c);
+  fclose(spill);
+  remove(spillFilename.c_str());
+  buffers = {};
+  cellCount = {};
+  firstChunk = {};
+
+  // Pass 4: weld each chunk and write its mesh file image and BVH
+  auto file = ok ? fopen(filename, "wb") : nullptr;
+  std::vector<StreamingChunkInfo> table(nc);
+  StreamingMeshHeader h{};
+
+  if (file != nullptr)
+  {
+    std::vector<TriangleRecord> records;
+    std::vector<char> section;
+    static const char zeros[MeshFile::alignment]{};
+    uint64_t offset = sizeof h;
+
+    ok = fwrite(&h, sizeof h, 1, file) == 1;
+    for (size_t c = 0; ok && c < nc; ++c)
+    {
+      records.resize(chunkSize[c]);
+      ok = readAt(temp,
+        chunkStart[c] * sizeof(TriangleRecord),
+        records.data(),
+        records.size() * sizeof(TriangleRecord));
+      if (!ok)
+        break;
+
+      Reference<TriangleMesh> mesh{makeChunkMesh(records, hasNormals)};
+      Reference<BVH> bvh{new BVH{*mesh, 16}};
+      auto padding = size_t(-offset & (MeshFile::alignment - 1));
+
+      section.clear();
+      bvh->serialize(section);
+      ok = fwrite(zeros, 1, padding, file) == padding;
+      offset += padding;
+      ok = ok && MeshFile::write(file, *mesh, section.data(), section.size());
+
+      auto& info = table[c];
+
+      setBounds(info.bounds, mesh->bounds());
+      info.firstTriangle = chunkStart[c];
+      info.offset = offset;
+      info.size = tellFile(file) - offset;
+      offset += info.size;
+      h.numberOfVertices += mesh->data().numberOfVertices;
+    }
+    memcpy(h.magic, streamingMeshMagic, sizeof h.magic);
+    h.version = streamingMeshVersion;
+    h.byteOrder = MeshFile::byteOrderMark;
+    h.numberOfChunks = uint32_t(nc);
+    h.numberOfTriangles = nt;
+    setBounds(h.bounds, bounds);
+    h.chunkTableOffset = offset;
+    ok = ok && fwrite(table.data(), sizeof(StreamingChunkInfo), nc, file) == nc;
+    ok = ok && writeAt(file, 0, &h, sizeof h);
+    ok = fclose(file) == 0 && ok;
+    if (!ok)
+      remove(filename);
+  }
+  fclose(temp);
+  remove(tempFilename.c_str());
+  return file != nullptr && ok;
+}
+
+StreamingMesh*
+StreamingMesh::open(const char* filename, size_t cacheBudget)
+{
+  auto file = fopen(filename, "rb");
+
+  if (file == nullptr)
+    return nullptr;
+
+  auto mesh = new StreamingMesh{file, cacheBudget};
+
+  if (mesh->readChunkTable())
+    return mesh;
+  printf("Invalid streaming mesh file %s\n", filename);
+  delete mesh;
+  return nullptr;
+}
+
+StreamingMesh::StreamingMesh(FILE* file, size_t cacheBudget):
+  _file{file},
+  _cacheBudget{cacheBudget}
+{
+  // do nothing
+}
+
+StreamingMesh::~StreamingMesh()
+{
+  fclose(_file);
+}
+
+bool
+StreamingMesh::readChunkTable()
+{
+  using namespace internal;
+
+  StreamingMeshHeader h;
+
+  if (!seekFile(_file, 0, SEEK_END))
+    return false;
+
+  auto fileSize = tellFile(_file);
+
+  if (!readAt(_file, 0, &h, sizeof h) ||
+    memcmp(h.magic, streamingMeshMagic, sizeof h.magic) != 0 ||
+    h.version != streamingMeshVersion ||
+    h.byteOrder != MeshFile::byteOrderMark ||
+    h.numberOfChunks == 0 ||
+    h.chunkTableOffset > fileSize ||
+    h.numberOfChunks > (fileSize - h.chunkTableOffset) /
+      sizeof(StreamingChunkInfo))
+    return false;
+
+  std::vector<StreamingChunkInfo> table(h.numberOfChunks);
+
+  if (!readAt(_file,
+    h.chunkTableOffset,
+    table.data(),
+    table.size() * sizeof(StreamingChunkInfo)))
+    return false;
+  _chunks.resize(table.size());
+  for (size_t i = 0; i < table.size(); ++i)
+  {
+    const auto& info = table[i];
+
+    // Chunks must be sorted by first triangle (see normal())
+    if (info.offset > fileSize || info.size > fileSize - info.offset ||
+      info.firstTriangle >= h.numberOfTriangles ||
+      (i > 0 && info.firstTriangle <= table[i - 1].firstTriangle))
+      return false;
+
+    auto& chunk = _chunks[i];
+
+    chunk.bounds = getBounds(info.bounds);
+    chunk.firstTriangle = info.firstTriangle;
+    chunk.offset = info.offset;
+    chunk.size = info.size;
+  }
+  _numberOfVertices = h.numberOfVertices;
+  _numberOfTriangles = h.numberOfTriangles;
+  _bounds = getBounds(h.bounds);
+  _chunkIndices.resize(_chunks.size());
+  for (uint32_t i = 0; i < _chunkIndices.size(); ++i)
+    _chunkIndices[i] = i;
+  _nodes.reserve(2 * _chunks.size());
+  makeNode(0, int(_chunks.size()));
+  return true;
+}
+
+int
+StreamingMesh::makeNode(int start, int end)
+{
+  auto index = int(_nodes.size());
+  Bounds3f bounds;
+  Bounds3f centroidBounds;
+
+  _nodes.emplace_back();
+  for (int i = start; i < end; ++i)
+  {
+    const auto& b = _chunks[_chunkIndices[i]].bounds;
+
+    bounds.inflate(b);
+    centroidBounds.inflate(b.center());
+  }
+
+  auto s = centroidBounds.size();
+  auto dim = s.x > s.y && s.x > s.z ? 0 : (s.y > s.z ? 1 : 2);
+
+  if (end - start <= 2 || centroidBounds.max()[dim] == centroidBounds.min()[dim])
+  {
+    _nodes[index] = {bounds, start, end - start, 0};
+    return index;
+  }
+
+  auto mid = (start + end) / 2;
+
+  std::nth_element(_chunkIndices.begin() + start,
+    _chunkIndices.begin() + mid,
+    _chunkIndices.begin() + end,
+    [this, dim] (uint32_t a, uint32_t b)
+    {
+      return _chunks[a].bounds.center()[dim] < _chunks[b].bounds.center()[dim];
+    });
+  makeNode(start, mid);
+
+  auto second = makeNode(mid, end);
+
+  _nodes[index] = {bounds, second, 0, dim};
+  return index;
+}
+
+void
+StreamingMesh::evict(size_t budget) const
+{
+  while (_residentSize > budget && !_lru.empty())
+  {
+    auto& chunk = _chunks[_lru.back()];
+
+    _lru.pop_back();
+    chunk.bvh = nullptr;
+    _residentSize -= size_t(chunk.size);
+  }
+}
+
+Reference<BVH>
+StreamingMesh::chunk(uint32_t index) const
+{
+  using namespace internal;
+
+  std::unique_lock<std::mutex> lock{_mutex};
+  auto& chunk = _chunks[index];
+
+  // Wait for the chunk if another thread is reading it
+  while (chunk.loading)
+    _loaded.wait(lock);
+  if (chunk.bvh != nullptr)
+  {
+    _lru.splice(_lru.begin(), _lru, chunk.lru);
+    return chunk.bvh;
+  }
+
+  auto size = size_t(chunk.size);
+
+  // Make room for the chunk before reading it. The chunk is counted as
+  // resident while it is read
+  evict(_cacheBudget > size ? _cacheBudget - size : 0);
+  _residentSize += size;
+  chunk.loading = true;
+  lock.unlock();
+
+  Reference<ChunkStorage> storage{new ChunkStorage{size}};
+  Reference<BVH> bvh;
+  bool ok;
+
+  {
+    std::lock_guard<std::mutex> fileLock{_fileMutex};
+    ok = readAt(_file, chunk.offset, storage->data(), size);
+  }
+  if (ok)
+  {
+    MeshFile::Section section;
+    auto mesh = MeshFile::read(storage, storage->data(), size, &section);
+
+    if (mesh != nullptr)
+      bvh = new BVH{*mesh, section.data, section.size};
+  }
+  lock.lock();
+  chunk.loading = false;
+  if (bvh == nullptr)
+    _residentSize -= size;
+  else
+  {
+    chunk.bvh = bvh;
+    _lru.push_front(index);
+    chunk.lru = _lru.begin();
+  }
+  _loaded.notify_all();
+  return bvh;
+}
+
+void
+StreamingMesh::setCacheBudget(size_t budget)
+{
+  std::lock_guard<std::mutex> lock{_mutex};
+
+  _cacheBudget = budget;
+  evict(budget);
+}
+
+size_t
+StreamingMesh::residentSize() const
+{
+  std::lock_guard<std::mutex> lock{_mutex};
+  return _residentSize;
+}
+
+bool
+StreamingMesh::intersect(const Ray& ray, Intersection& hit) const
+{
+  const auto invDir = ray.direction.inverse();
+  const int dirIsNeg[3]{invDir.x < 0, invDir.y < 0, invDir.z < 0};
+  int stack[64];
+  int top{0};
+  int current{0};
+  bool found{false};
+
+  for (;;)
+  {
+    const auto& node = _nodes[current];
+
+    if (intersectBounds(node.bounds, ray, invDir, dirIsNeg, hit.distance))
+    {
+      if (!node.isLeaf())
+      {
+        if (dirIsNeg[node.axis])
+        {
+          stack[top++] = current + 1;
+          current = node.offset;
+        }
+        else
+        {
+          stack[top++] = node.offset;
+          current = current + 1;
+        }
+        continue;
+      }
+      for (int i = node.offset, e = node.offset + node.count; i < e; ++i)
+      {
+        auto index = _chunkIndices[i];
+        const auto& chunk = _chunks[index];
+
+        // Do not page in chunks the ray cannot hit
+        if (!intersectBounds(chunk.bounds, ray, invDir, dirIsNeg, hit.distance))
+          continue;
+
+        auto bvh = this->chunk(index);
+        Intersection localHit;
+
+        localHit.distance = hit.distance;
+        if (bvh != nullptr && bvh->intersect(ray, localHit))
+        {
+          hit.triangleIndex = int64_t(chunk.firstTriangle) + localHit.triangleIndex;
+          hit.distance = localHit.distance;
+          hit.p = localHit.p;
+          found = true;
+        }
+      }
+    }
+    if (top == 0)
+      break;
+    current = stack[--top];
+  }
+  return found;
+}
+
+vec3f
+StreamingMesh::normal(const Intersection& hit) const
+{
+  auto t = uint64_t(hit.triangleIndex);
+  auto it = std::upper_bound(_chunks.begin(),
+    _chunks.end(),
+    t,
+    [] (uint64_t t, const Chunk& chunk)
+    {
+      return t < chunk.firstTriangle;
+    });
+
+  if (it == _chunks.begin())
+    return vec3f{0, 0, 0};
+  --it;
+
+  auto bvh = chunk(uint32_t(it - _chunks.begin()));
+
+  if (bvh == nullptr)
+    return vec3f{0, 0, 0};
+
+  const auto& data = bvh->mesh()->data();
+  auto i = t - it->firstTriangle;
+
+  if (i >= uint64_t(data.numberOfTriangles))
+    return vec3f{0, 0, 0};
+
+  const auto& triangle = data.triangles[i];
+  auto n = data.vertexNormals[triangle.v[0]] * hit.p.x +
+    data.vertexNormals[triangle.v[1]] * hit.p.y +
+    data.vertexNormals[triangle.v[2]] * hit.p.z;
+
+  return n.versor();
+}
+
+} // end namespace cg
@@ -0,0 +1,176 @@
+//[]---------------------------------------------------------------[]
+//|                                                                 |
+//| Copyright (C) 2019 Orthrus Group.                               |
+//|                                                                 |
+//| This software is provided 'as-is', without any express or       |
+//| implied warranty. In no event will the authors be held liable   |
+//| for any damages arising from the use of this software.          |
+//|                                                                 |
+//| Permission is granted to anyone to use this software for any    |
+//| purpose, including commercial applications, and to alter it and |
+//| redistribute it freely, subject to the following restrictions:  |
+//|                                                                 |
+//| 1. The origin of this software must not be misrepresented; you  |
+//| must not claim that you wrote the original software. If you use |
+//| this software in a product, an acknowledgment in the product    |
+//| documentation would be appreciated but is not required.         |
+//|                                                                 |
+//| 2. Altered source versions must be plainly marked as such, and  |
+//| must not be misrepresented as being the original software.      |
+//|                                                                 |
+//| 3. This notice may not be removed or altered from any source    |
+//| distribution.                                                   |
+//|                                                                 |
+//[]---------------------------------------------------------------[]
+//
+// OVERVIEW: StreamingMesh.h
+// ========
+// Class definition for streaming mesh.
+//
+// Author(s): Paulo Pagliosa (and your name)
+// Last revision: 19/10/2026
+
+#ifndef __StreamingMesh_h
+#define __StreamingMesh_h
+
+#include "BVH.h"
+#include <condition_variable>
+#include <cstdio>
+#include <list>
+#include <mutex>
+#include <string>
+#include <vector>
+
+namespace cg
+{ // begin namespace cg
+
+
+/////////////////////////////////////////////////////////////////////
+//
+// StreamingMesh: streaming mesh class
+// =============
+//
+// A streaming mesh is a triangle mesh kept on disk, partitioned into
+// spatially coherent chunks. Each chunk is stored as the image of a
+// mesh file (see MeshFile) with its own BVH section. Only the chunk
+// table and a BVH over the chunk bounds stay resident; chunks are read
+// on demand by ray traversal into a LRU cache whose size is bounded
+// by a byte budget. Chunks in use by a traversal are released when it
+// ends, so the resident size may exceed the budget by the chunks in
+// flight. Chunks are read and parsed out of the cache lock, thus
+// traversals hitting the cache do not wait for disk reads.
+//
+class StreamingMesh: public SharedObject
+{
+public:
+  static constexpr size_t defaultCacheBudget = size_t(256) << 20;
+
+  /// \brief Builds a streaming mesh file from mesh files (any read by
+  /// MeshReader, or binary mesh files) whose triangles are binned by
+  /// position into chunks of at most \c trianglesPerChunk triangles.
+  /// Each mesh file is parsed once, into a temporary file from which
+  /// the triangles are binned, so the whole mesh may be much larger
+  /// than memory. Every mesh file, however, is read into memory as a
+  /// TriangleMesh, so it must fit in memory and have less than 2^31
+  /// vertices and triangles; larger meshes must be split beforehand.
+  static bool build(const char* filename,
+    const std::vector<std::string>& meshFiles,
+    int trianglesPerChunk = 1 << 16);
+
+  /// Opens a streaming mesh file (null if it is not valid).
+  static StreamingMesh* open(const char* filename,
+    size_t cacheBudget = defaultCacheBudget);
+
+  ~StreamingMesh() override;
+
+  uint64_t numberOfVertices() const
+  {
+    return _numberOfVertices;
+  }
+
+  uint64_t numberOfTriangles() const
+  {
+    return _numberOfTriangles;
+  }
+
+  auto numberOfChunks() const
+  {
+    return uint32_t(_chunks.size());
+  }
+
+  const Bounds3f& bounds() const
+  {
+    return _bounds;
+  }
+
+  size_t cacheBudget() const
+  {
+    return _cacheBudget;
+  }
+
+  /// Sets the cache budget, evicting chunks if necessary.
+  void setCacheBudget(size_t budget);
+
+  /// Returns the size of the chunks currently in the cache.
+  size_t residentSize() const;
+
+  /// \brief Intersects a ray, given in mesh space, with the mesh (see
+  /// BVH::intersect()). The triangle index stored in \c hit is global.
+  bool intersect(const Ray& ray, Intersection& hit) const;
+
+  /// Returns the interpolated normal at a hit found by intersect().
+  vec3f normal(const Intersection& hit) const;
+
+private:
+  struct Chunk
+  {
+    Bounds3f bounds;
+    uint64_t firstTriangle;
+    uint64_t offset; // of the mesh file image of the chunk
+    uint64_t size;
+    Reference<BVH> bvh; // null if not resident
+    std::list<uint32_t>::iterator lru;
+    bool loading{};
+
+  }; // Chunk
+
+  struct Node
+  {
+    Bounds3f bounds;
+    int offset; // first chunk (leaf) or second child (interior node)
+    int count; // number of chunks (0 for interior nodes)
+    int axis; // split axis (interior nodes only)
+
+    bool isLeaf() const
+    {
+      return count > 0;
+    }
+
+  }; // Node
+
+  FILE* _file;
+  uint64_t _numberOfVertices{};
+  uint64_t _numberOfTriangles{};
+  Bounds3f _bounds;
+  size_t _cacheBudget;
+  mutable std::vector<Chunk> _chunks;
+  std::vector<uint32_t> _chunkIndices; // leaf chunks
+  std::vector<Node> _nodes;
+  mutable std::list<uint32_t> _lru; // most recently used first
+  mutable size_t _residentSize{};
+  mutable std::mutex _mutex; // cache
+  mutable std::condition_variable _loaded;
+  mutable std::mutex _fileMutex;
+
+  StreamingMesh(FILE* file, size_t cacheBudget);
+
+  bool readChunkTable();
+  int makeNode(int start, int end);
+  Reference<BVH> chunk(uint32_t index) const;
+  void evict(size_t budget) const;
+
+}; // StreamingMesh
+
+} // end namespace cg
+
+#endif // __StreamingMesh_h
@@ -35,6 +35,8 @@
 namespace cg
 { // begin namespace cg
 
+DEFINE_POOL_ALLOCATED(Transform)
+
 template <typename real>
 inline Matrix4x4<real>
 inverseTRS(const Matrix4x4<real>& trs)
@@ -196,6 +198,7 @@ Transform::update()
     }
     it->dispose();
     changed = true;
+    recordChange(SceneJournal::Event::Transform);
 }
 
 void
@@ -221,6 +224,7 @@ Transform::parentChanged()
     it->dispose();
 
     changed = true;
+    recordChange(SceneJournal::Event::Transform);
 }
 
 void
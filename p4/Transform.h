@@ -47,6 +47,8 @@ namespace cg
 class Transform final: public Component
 {
 public:
+  DECLARE_POOL_ALLOCATED(Transform);
+
   enum class Space
   {
     Local,
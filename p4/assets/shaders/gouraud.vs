@@ -37,6 +37,29 @@ layout(location=1) in vec3 normal;
 
 out vec4 vertexColor;
 
+// Decoding of quantized attributes (see GLMesh)
+uniform vec3 positionOffset = vec3(0);
+uniform vec3 positionScale = vec3(1);
+uniform int octahedralNormals;
+
+vec4 decodePosition(vec4 p)
+{
+    return vec4(positionOffset + positionScale * p.xyz, 1);
+}
+
+vec3 decodeNormal(vec3 n)
+{
+    if (octahedralNormals == 0)
+        return n;
+
+    vec2 e = n.xy * 2 - 1;
+    vec3 v = vec3(e, 1 - abs(e.x) - abs(e.y));
+
+    if (v.z < 0)
+        v.xy = (1 - abs(v.yx)) * vec2(v.x >= 0 ? 1 : -1, v.y >= 0 ? 1 : -1);
+    return normalize(v);
+}
+
 //compute light color at a point por each light
 vec4 getIntensityAtPoint(vec3 point, LightProps light, vec3 normal) {
     vec4 intensity;
@@ -77,7 +100,10 @@ vec4 getIntensityAtPoint(vec3 point, LightProps light, vec3 normal) {
 
 void main()
 {
-    gl_Position = vpMatrix*transform*position;
+    vec4 p = decodePosition(position);
+    vec3 n = decodeNormal(normal);
+
+    gl_Position = vpMatrix*transform*p;
     //theres not much work for the fragment shader, so we just use p3.fs
     if(drawWireframe){//in case this object is selected
         vertexColor=wireframeColor;
@@ -85,9 +111,9 @@ void main()
 
         vertexColor = material.Oa*ambientLight;//computes ambient light
     
-        vec3 N = normalize(normalMatrix*normal);
+        vec3 N = normalize(normalMatrix*n);
 
-        vec3 P = vec3(position);
+        vec3 P = vec3(p);
         for(int i =0; i<NL; i++){//adds each light contribution to vertex color
             vec4 intensity=getIntensityAtPoint(P, lights[i], N);
             vec3 L = normalize(lights[i].position-P);
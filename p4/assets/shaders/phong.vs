@@ -9,8 +9,31 @@ layout(location=1) in vec3 normal;
 
 out vec3 vertexNormal;
 
+// Decoding of quantized attributes (see GLMesh)
+uniform vec3 positionOffset = vec3(0);
+uniform vec3 positionScale = vec3(1);
+uniform int octahedralNormals;
+
+vec4 decodePosition(vec4 p)
+{
+  return vec4(positionOffset + positionScale * p.xyz, 1);
+}
+
+vec3 decodeNormal(vec3 n)
+{
+  if (octahedralNormals == 0)
+    return n;
+
+  vec2 e = n.xy * 2 - 1;
+  vec3 v = vec3(e, 1 - abs(e.x) - abs(e.y));
+
+  if (v.z < 0)
+    v.xy = (1 - abs(v.yx)) * vec2(v.x >= 0 ? 1 : -1, v.y >= 0 ? 1 : -1);
+  return normalize(v);
+}
+
 void main()
 {
-  gl_Position = vpMatrix * transform * position;
-  vertexNormal = normalMatrix * normal;
+  gl_Position = vpMatrix * transform * decodePosition(position);
+  vertexNormal = normalMatrix * decodeNormal(normal);
 }
\ No newline at end of file